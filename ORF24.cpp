@@ -22,22 +22,76 @@
  * THE SOFTWARE.
  */
 
+#include <cstring>
+#include <fstream>
 #include "ORF24.h"
+#include "nRF24L01Register.h"
+
+using namespace nRF24L01;
+
+/* Transport used when none is given */
+static WiringPiTransport wiringPiTransport;
+
+/* Registers restored by recover(), SETUP_AW before the addresses */
+static const unsigned char configRegisters[] = {
+	CONFIG, EN_AA, EN_RXADDR, SETUP_AW, SETUP_RETR, RF_CH, RF_SETUP,
+	RX_ADDR_P0, RX_ADDR_P1, RX_ADDR_P2, RX_ADDR_P3, RX_ADDR_P4, RX_ADDR_P5, TX_ADDR,
+	RX_PW_P0, RX_PW_P1, RX_PW_P2, RX_PW_P3, RX_PW_P4, RX_PW_P5, FEATURE, DYNPD
+};
+
+static const int configRegisterCount = sizeof(configRegisters);
+
+/**
+ * Check whether a register holds configuration
+ *
+ * @param  reg 	register address
+ * @return     	false for STATUS, OBSERVE_TX, CD and FIFO_STATUS
+ */
+static inline bool isConfigRegister(unsigned char reg)
+{
+	return reg <= RF_SETUP || (reg >= RX_ADDR_P0 && reg <= RX_PW_P5) || reg == DYNPD || reg == FEATURE;
+}
+
+/**
+ * Get register length
+ *
+ * @param  reg 			register address
+ * @param  addressSize 	address width in bytes
+ * @return             	length in bytes
+ */
+static inline int registerLength(unsigned char reg, int addressSize)
+{
+	return reg == RX_ADDR_P0 || reg == RX_ADDR_P1 || reg == TX_ADDR ? addressSize : 1;
+}
 
 ORF24::ORF24(int _ce)
 	: ce(_ce),
 	  csn(10),
 	  spiChannel(0),
 	  spiSpeed(4000000),
-	  payloadSize(32)
+	  payloadSize(32),
+	  initTime(0),
+	  transport(&wiringPiTransport)
 { }
 
 ORF24::ORF24(int _ce, int _spiChannel, int _spiSpeed)
 	: ce(_ce),
-	  csn(spiChannel ? 11 : 10),
-	  spiChannel(_spiSpeed),
+	  csn(_spiChannel ? 11 : 10),
+	  spiChannel(_spiChannel),
+	  spiSpeed(_spiSpeed),
+	  payloadSize(32),
+	  initTime(0),
+	  transport(&wiringPiTransport)
+{ }
+
+ORF24::ORF24(int _ce, int _spiChannel, int _spiSpeed, ORF24Transport *_transport)
+	: ce(_ce),
+	  csn(_spiChannel ? 11 : 10),
+	  spiChannel(_spiChannel),
 	  spiSpeed(_spiSpeed),
-	  payloadSize(32)
+	  payloadSize(32),
+	  initTime(0),
+	  transport(_transport)
 { }
 
 /**
@@ -47,54 +101,461 @@ ORF24::ORF24(int _ce, int _spiChannel, int _spiSpeed)
  */
 bool ORF24::begin(void)
 {
+	unsigned int start = transport->micros();
+
 	if (debug)
 	{
 		std::cout << "Setting up SPI Communication Controller...\n";
 	}
 
-	/* Settipng up CE pin */
-	pinMode(ce, OUTPUT);
-	digitalWrite(ce, LOW);
-
-	/* Initializing SPI communication */
-	wiringPiSPISetup(spiChannel, spiSpeed);
-
-	/* Pulldown MOSI and SCK pin */
-	pullUpDnControl(MOSI_PIN, PUD_DOWN);
-	pullUpDnControl(SLCK_PIN, PUD_DOWN);
+	/* Setting up CE pin and SPI communication */
+	transport->setup(ce, spiChannel, spiSpeed);
 
 	if (debug)
 	{
 		std::cout << "SPI communication initialized.\n";
 	}
 
-	delay(100);
+	transport->delayMicroseconds(100000);
 
 	if (debug)
 	{
 		std::cout << "Setting up nRF24L01...\n";
 	}
 
+	plusVariant = detectPlusVariant();
+	resetPipeCache();
+
 	/* Setting up nRF24L01 configuration */
-	setRetries(0b0100, 0b1111);
+	setRetries(0b1111);
 	setPowerLevel(RF_PA_MIN);
 	setDataRate(RF_DR_1MBPS);
 	setCRCLength(CRC_1_BYTE);
 	writeRegister(DYNPD, 0);
-	writeRegister(STATUS, (1 < RX_DR) | (1 << TX_DS) | (1 << MAX_RT));
+	writeRegister(STATUS, IRQFlags::mask);
 	setChannel(0);
 
 	flushRX();
 	flushTX();
 
+	bool connected = isChipConnected();
+
+	/* Configuration leaves PWR_UP cleared */
+	resetPowerAccounting();
+
+	initTime = transport->micros() - start;
+
+	if (debug)
+	{
+		if (connected)
+		{
+			std::cout << "nRF24L01 initialized.\n\n";
+		}
+		else
+		{
+			std::cout << "nRF24L01 is not responding.\n\n";
+		}
+	}
+
+	return connected;
+}
+
+/**
+ * nRF24L01 fast initialization
+ *
+ * Poll the chip until it is ready instead of waiting for the worst case
+ * power on reset time, then write the default configuration in one batch.
+ *
+ * @return  true if chip is present
+ */
+bool ORF24::fastBegin(void)
+{
+	unsigned int start = transport->micros();
+
+	transport->setup(ce, spiChannel, spiSpeed);
+
+	/* Power on reset takes up to 100 ms, a warm chip answers immediately */
+	const unsigned long timeout = 150;
+
+	bool ready = waitForChip(timeout);
+
+	if (ready)
+	{
+		writeRegisters(DefaultConfig::regs, DefaultConfig::count);
+
+		dataRate = RF_DR_1MBPS;
+		retryCount = 0b1111;
+		autoRetryDelay = true;
+
+		if (ackPayloadSize > 0)
+		{
+			updateRetryDelay();
+		}
+
+		powerLevel = RF_PA_MIN;
+
+		plusVariant = detectPlusVariant();
+		resetPipeCache();
+		resetPowerAccounting();
+
+		flushRX();
+		flushTX();
+	}
+
+	initTime = transport->micros() - start;
+
+	if (debug)
+	{
+		if (ready)
+		{
+			std::cout << "nRF24L01 initialized in " << initTime << " us.\n\n";
+		}
+		else
+		{
+			std::cout << "nRF24L01 is not responding.\n\n";
+		}
+	}
+
+	return ready;
+}
+
+/**
+ * Check whether nRF24L01 is connected and responding
+ *
+ * @return  true if chip is present
+ */
+bool ORF24::isChipConnected(void)
+{
+	return Driver<ORF24>::isChipConnected(*this);
+}
+
+/**
+ * Wait until nRF24L01 responds to register access
+ *
+ * @param  timeout 	maximum wait time in milliseconds
+ * @return         	true if chip is ready
+ */
+bool ORF24::waitForChip(unsigned long timeout)
+{
+	return Driver<ORF24>::waitForChip(*this, *transport, timeout);
+}
+
+/**
+ * Read every configuration register as the known configuration
+ */
+void ORF24::saveConfig(void)
+{
+	for (int i = 0; i < configRegisterCount; i++)
+	{
+		unsigned char reg = configRegisters[i];
+
+		readRegister(reg, shadow[reg], registerLength(reg, addressSize));
+		shadowKnown |= 1 << reg;
+	}
+}
+
+/**
+ * Check STATUS, FIFO_STATUS and configuration registers for faults
+ *
+ * @return  HealthFault bit mask, HEALTH_OK if healthy
+ */
+int ORF24::checkHealth(void)
+{
+	unsigned char fifo;
+	unsigned char status = readRegister(FIFO_STATUS, &fifo, 1);
+	unsigned char aw = readRegister(SETUP_AW);
+
+	/* STATUS bit 7 always reads 0 and address width 0 is illegal */
+	if ((status & 0x80) || aw == 0 || aw > 0b11)
+	{
+		return HEALTH_NO_CHIP;
+	}
+
+	int faults = HEALTH_OK;
+
+	if (verifyConfig() > 0)
+	{
+		faults |= HEALTH_CONFIG;
+	}
+
+	/* MAX_RT and a full TX FIFO are normal until pollWrite finishes the write */
+	bool inFlight = writing && transport->millis() - writeStartedAt < writeTimeout();
+
+	if (!inFlight && (status & (1 << MAX_RT)))
+	{
+		faults |= HEALTH_MAX_RT;
+	}
+
+	/* Every write ends with an empty TX FIFO */
+	if (!inFlight && !listening && !(fifo & (1 << TX_EMPTY)))
+	{
+		faults |= HEALTH_TX_STUCK;
+	}
+
+	/* STATUS and FIFO_STATUS come from one transfer, so RX_P_NO must agree with RX_EMPTY */
+	int pipe = RXPipeNumber::decode(status);
+
+	if (pipe == 0b110 || (pipe == 0b111) != (bool) (fifo & (1 << RX_EMPTY)))
+	{
+		faults |= HEALTH_RX_STUCK;
+	}
+
+	return faults;
+}
+
+/**
+ * Recover from faults without reinitializing the chip
+ *
+ * @param faults 	HealthFault bit mask
+ */
+void ORF24::recover(int faults)
+{
+	if (faults & HEALTH_NO_CHIP)
+	{
+		const unsigned long timeout = 150;
+
+		if (!waitForChip(timeout))
+		{
+			return;
+		}
+
+		/* Back from power loss with reset registers */
+		faults |= HEALTH_CONFIG;
+	}
+
+	if (faults & (HEALTH_CONFIG | HEALTH_TIMEOUT))
+	{
+		restoreConfig();
+	}
+
+	if (faults & (HEALTH_MAX_RT | HEALTH_TX_STUCK | HEALTH_TIMEOUT))
+	{
+		flushTX();
+		writing = false;
+	}
+
+	/* Leave RX_DR alone for payloads still waiting to be read */
+	unsigned char flags = 1 << TX_DS | 1 << MAX_RT;
+
+	if (faults & HEALTH_RX_STUCK)
+	{
+		flushRX();
+		flags |= 1 << RX_DR;
+	}
+
+	writeRegister(STATUS, flags);
+}
+
+/**
+ * Get number of writes that raised neither TX_DS nor MAX_RT in time
+ *
+ * @return  write timeouts since construction
+ */
+unsigned long ORF24::getWriteTimeouts(void)
+{
+	return writeTimeouts;
+}
+
+/**
+ * Detect nRF24L01+ by probing the RF_DR_LOW bit
+ *
+ * The bit is reserved on nRF24L01 and always reads back as zero.
+ *
+ * @return  true if chip is nRF24L01+
+ */
+bool ORF24::detectPlusVariant(void)
+{
+	unsigned char setup = readRegister(RF_SETUP);
+
+	writeRegister(RF_SETUP, AirDataRateLow::update(setup, 1));
+	bool plus = AirDataRateLow::decode(readRegister(RF_SETUP));
+
+	writeRegister(RF_SETUP, setup);
+
+	if (debug)
+	{
+		std::cout << (plus ? "nRF24L01+ detected.\n" : "nRF24L01 detected.\n");
+	}
+
+	return plus;
+}
+
+/**
+ * Check whether chip is nRF24L01+
+ *
+ * @return  true if chip is nRF24L01+
+ */
+bool ORF24::isPlusVariant(void)
+{
+	return plusVariant;
+}
+
+/**
+ * Find the fastest reliable SPI clock
+ *
+ * @param  path 	file to store the result in, or NULL
+ * @return      	selected SPI clock frequency in Hz, 0 on failure
+ */
+int ORF24::calibrateSPISpeed(const char *path)
+{
+	const int steps[] = { 1000000, 2000000, 4000000, 6000000, 8000000, 10000000 };
+	const int stepCount = sizeof(steps) / sizeof(steps[0]);
+	const double margin = 0.8;
+	const int rounds = 64;
+
+	unsigned char txAddr[5], rxAddr[5];
+
+	readRegister(TX_ADDR, txAddr, addressSize);
+	readRegister(RX_ADDR_P0, rxAddr, addressSize);
+
+	int fastest = 0;
+
+	for (int i = 0; i < stepCount; i++)
+	{
+		if (!verifySPISpeed(steps[i], rounds))
+		{
+			break;
+		}
+
+		fastest = steps[i];
+	}
+
+	int selected = 0;
+
+	for (int i = 0; i < stepCount; i++)
+	{
+		if (steps[i] <= fastest * margin)
+		{
+			selected = steps[i];
+		}
+	}
+
+	/* Only the slowest step passed, there is no room for a margin */
+	if (selected == 0)
+	{
+		selected = fastest;
+	}
+
 	if (debug)
 	{
-		std::cout << "nRF24L01 initialized.\n\n";
+		std::cout << "Fastest SPI clock without errors is " << fastest << " Hz, using " << selected << " Hz.\n";
+	}
+
+	/* Keep the old clock if no step passed */
+	if (selected != 0)
+	{
+		spiSpeed = selected;
+	}
+
+	transport->setSpeed(spiChannel, spiSpeed);
+
+	/* Test patterns overwrote the addresses, also on failure */
+	writeRegister(TX_ADDR, txAddr, addressSize);
+	writeRegister(RX_ADDR_P0, rxAddr, addressSize);
+
+	if (selected == 0)
+	{
+		return 0;
+	}
+
+	if (path)
+	{
+		std::ofstream file(path);
+		file << spiSpeed << "\n";
+	}
+
+	return spiSpeed;
+}
+
+/**
+ * Check register access at an SPI clock
+ *
+ * @param  speed 	SPI clock frequency in Hz
+ * @param  rounds 	number of patterns per register
+ * @return        	true if every pattern read back unchanged
+ */
+bool ORF24::verifySPISpeed(int speed, int rounds)
+{
+	if (!transport->setSpeed(spiChannel, speed))
+	{
+		return false;
+	}
+
+	const unsigned char regs[] = { TX_ADDR, RX_ADDR_P0 };
+	const unsigned char fixed[] = { 0x00, 0xFF, 0x55, 0xAA };
+	unsigned char pattern[5], readBack[5];
+	unsigned int seed = speed;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		for (int reg = 0; reg < 2; reg++)
+		{
+			for (int i = 0; i < addressSize; i++)
+			{
+				seed = seed * 1103515245 + 12345;
+				pattern[i] = r < 4 ? fixed[r] : seed >> 16;
+			}
+
+			writeRegister(regs[reg], pattern, addressSize);
+			unsigned char status = readRegister(regs[reg], readBack, addressSize);
+
+			/* Bit 7 of STATUS is reserved and always reads zero */
+			if ((status & 0x80) || std::memcmp(pattern, readBack, addressSize) != 0)
+			{
+				if (debug)
+				{
+					std::cout << "SPI readback failed at " << speed << " Hz.\n";
+				}
+
+				return false;
+			}
+		}
 	}
 
 	return true;
 }
 
+/**
+ * Load SPI clock stored by calibrateSPISpeed
+ *
+ * @param  path 	file the result was stored in
+ * @return      	true if a valid speed was loaded
+ */
+bool ORF24::loadSPISpeed(const char *path)
+{
+	std::ifstream file(path);
+	int speed = 0;
+
+	if (!(file >> speed) || speed <= 0 || speed > 10000000)
+	{
+		return false;
+	}
+
+	spiSpeed = speed;
+
+	return true;
+}
+
+/**
+ * Get SPI clock frequency
+ *
+ * @return  frequency in Hz
+ */
+int ORF24::getSPISpeed(void)
+{
+	return spiSpeed;
+}
+
+/**
+ * Get time taken by the last initialization
+ *
+ * @return  initialization time in microseconds
+ */
+unsigned long ORF24::getInitTime(void)
+{
+	return initTime;
+}
+
 /**
  * Read from nRF24L01 register
  * 
@@ -103,14 +564,11 @@ bool ORF24::begin(void)
  */
 unsigned char ORF24::readRegister(unsigned char reg)
 {
-	unsigned char *p = buffer;
+	readRegisterFrame(buffer, reg, 1);			/* Set SPI command to read register */
 
-	*p++ = (R_REGISTER | (RW_MASK & reg)); 		/* Set SPI command to read register */
-	*p = NOP;									/* Set dummy data */
+	transport->transfer(spiChannel, buffer, 2);	/* Start read register */
 
-	wiringPiSPIDataRW(spiChannel, buffer, 2); 		/* Start read register */
-
-	return *p;									/* Read register value */
+	return buffer[1];							/* Read register value */
 }
 
 /**
@@ -123,22 +581,11 @@ unsigned char ORF24::readRegister(unsigned char reg)
  */
 unsigned char ORF24::readRegister(unsigned char reg, unsigned char *buf, int len)
 {
-	unsigned char *p = buffer;
-
-	*p++ = (R_REGISTER | (RW_MASK & reg));
+	int frameLength = readRegisterFrame(buffer, reg, len);
 
-	for (int i = 0; i < len; i++)
-	{
-		*p++ = NOP;
-	}
+	transport->transfer(spiChannel, buffer, frameLength);
 
-	wiringPiSPIDataRW(spiChannel, buffer, len + 1);
-
-	p = buffer + 1;
-	for (int i = 0; i < len; i++)
-	{
-		*buf++ = *p++;
-	}
+	std::memcpy(buf, buffer + 1, len);
 
 	return *buffer;
 }
@@ -152,12 +599,10 @@ unsigned char ORF24::readRegister(unsigned char reg, unsigned char *buf, int len
  */
 unsigned char ORF24::writeRegister(unsigned char reg, unsigned char value)
 {
-	unsigned char *p = buffer;
-
-	*p++ = (W_REGISTER | (RW_MASK & reg));		/* Set SPI command to write register */
-	*p = value;									/* Set data to write */
+	writeRegisterFrame(buffer, reg, &value, 1);	/* Set SPI command and data to write */
+	updateShadow(reg, &value, 1);
 
-	wiringPiSPIDataRW(spiChannel, buffer, 2);		/* Start write register */
+	transport->transfer(spiChannel, buffer, 2);	/* Start write register */
 
 	return *buffer;								/* Status is the first byte of receive buffer */
 }
@@ -172,19 +617,165 @@ unsigned char ORF24::writeRegister(unsigned char reg, unsigned char value)
  */
 unsigned char ORF24::writeRegister(unsigned char reg, const unsigned char *buf, int len)
 {
-	unsigned char *p = buffer;
+	int frameLength = writeRegisterFrame(buffer, reg, buf, len);
+
+	transport->transfer(spiChannel, buffer, frameLength);
+	updateShadow(reg, buf, len);
+
+	return *buffer;
+}
+
+/**
+ * Write a list of single byte registers in one SPI batch
+ *
+ * @param  regs 	list of register address and value pairs
+ * @param  count 	number of registers to write
+ */
+void ORF24::writeRegisters(const unsigned char (*regs)[2], int count)
+{
+	const int maxBatch = 16;
+	unsigned char frames[maxBatch][2];
+
+	while (count > 0)
+	{
+		int n = count < maxBatch ? count : maxBatch;
+
+		for (int i = 0; i < n; i++)
+		{
+			writeRegisterFrame(frames[i], regs[i][0], &regs[i][1], 1);
+			updateShadow(regs[i][0], &regs[i][1], 1);
+		}
+
+		transport->transferBatch(spiChannel, frames, n);
+
+		regs += n;
+		count -= n;
+	}
+}
+
+/**
+ * Remember a configuration register value written to the chip
+ *
+ * @param  reg 	register address
+ * @param  buf 	written value
+ * @param  len 	value length
+ */
+void ORF24::updateShadow(unsigned char reg, const unsigned char *buf, int len)
+{
+	if (isConfigRegister(reg))
+	{
+		std::memcpy(shadow[reg], buf, len < 5 ? len : 5);
+		shadowKnown |= 1 << reg;
+	}
+}
 
-	*p++ = (W_REGISTER | (RW_MASK & reg));
+/**
+ * Count configuration registers that differ from the shadow
+ *
+ * @return  number of differing registers
+ */
+int ORF24::verifyConfig(void)
+{
+	int mismatches = 0;
 
-	for (int i = 0; i < len; i++)
+	for (int i = 0; i < configRegisterCount; i++)
 	{
-		*p++ = *buf++;
+		unsigned char reg = configRegisters[i];
+
+		if (!(shadowKnown & (1 << reg)))
+		{
+			continue;
+		}
+
+		int len = registerLength(reg, addressSize);
+		unsigned char value[5];
+
+		readRegister(reg, value, len);
+
+		if (reg == CONFIG)
+		{
+			/* PWR_UP follows the operating mode, testCarrier leaves PRIM_RX set */
+			unsigned char expected = PowerUp::update(shadow[CONFIG][0], powerState != POWER_DOWN);
+
+			if (PrimaryRX::update(value[0], 0) != PrimaryRX::update(expected, 0))
+			{
+				mismatches++;
+			}
+		}
+		else if (std::memcmp(value, shadow[reg], len) != 0)
+		{
+			mismatches++;
+		}
 	}
 
-	wiringPiSPIDataRW(spiChannel, buffer, len + 1);
+	return mismatches;
+}
 
-	return *buffer;
+/**
+ * Write the shadow back to the configuration registers
+ */
+void ORF24::restoreConfig(void)
+{
+	unsigned char regs[configRegisterCount][2];
+	int count = 0;
+
+	for (int i = 0; i < configRegisterCount; i++)
+	{
+		unsigned char reg = configRegisters[i];
+
+		if (!(shadowKnown & (1 << reg)) || registerLength(reg, addressSize) > 1)
+		{
+			continue;
+		}
+
+		unsigned char value = shadow[reg][0];
+
+		if (reg == CONFIG)
+		{
+			value = PowerUp::update(value, powerState != POWER_DOWN);
+			value = PrimaryRX::update(value, listening);
+		}
+
+		regs[count][0] = reg;
+		regs[count][1] = value;
+		count++;
+	}
+
+	/* Address width first, then the addresses */
+	writeRegisters(regs, count);
+
+	for (int i = 0; i < configRegisterCount; i++)
+	{
+		unsigned char reg = configRegisters[i];
+		int len = registerLength(reg, addressSize);
+
+		if ((shadowKnown & (1 << reg)) && len > 1)
+		{
+			unsigned char value[5];
+
+			std::memcpy(value, shadow[reg], len);
+			writeRegister(reg, value, len);
+		}
+	}
 }
+
+/**
+ * Longest time a write can take before MAX_RT
+ *
+ * @return  timeout in milliseconds
+ */
+unsigned long ORF24::writeTimeout(void)
+{
+	const unsigned long unknown = 500;
+
+	if (!(shadowKnown & (1 << SETUP_RETR)))
+	{
+		return unknown;
+	}
+
+	return nRF24L01::writeTimeout(shadow[SETUP_RETR][0]);
+}
+
 /**
  * Write payload to send
  * 
@@ -194,16 +785,29 @@ unsigned char ORF24::writeRegister(unsigned char reg, const unsigned char *buf,
  */
 unsigned char ORF24::writePayload(unsigned char *data, int len)
 {
-	unsigned char *p = buffer;
+	int frameLength = commandFrame(buffer, W_TX_PAYLOAD, data, len);
 
-	*p++ = W_TX_PAYLOAD;
-	
-	for (int i = 0; i < len; i++)
-	{
-		*p++ = *data++;
-	}
+	transport->transfer(spiChannel, buffer, frameLength);
 
-	wiringPiSPIDataRW(spiChannel, buffer, len + 1);
+	return *buffer;
+}
+
+/**
+ * Read received payload
+ * 
+ * @param  data 	data buffer to read into
+ * @param  len  	data length
+ * @return     		nRF24L01 status
+ */
+unsigned char ORF24::readPayload(unsigned char *data, int len)
+{
+	/* Read the whole payload so it leaves the RX FIFO */
+	buffer[0] = R_RX_PAYLOAD;
+	std::memset(buffer + 1, NOP, payloadSize);
+
+	transport->transfer(spiChannel, buffer, payloadSize + 1);
+
+	std::memcpy(data, buffer + 1, len < payloadSize ? len : payloadSize);
 
 	return *buffer;
 }
@@ -221,7 +825,61 @@ void ORF24::setRetries(int delay, int count)
 		std::cout << "Setting up retransmission configuration...\n";
 	}
 
-	writeRegister(SETUP_RETR, (delay & 0xF) << ARD | (count & 0xF) << ARC);
+	autoRetryDelay = false;
+	retryCount = count;
+
+	Driver<ORF24>::setRetries(*this, delay, count);
+}
+
+/**
+ * Set number of retry and use the shortest valid retransmission delay
+ *
+ * @param count 	retransmission count
+ */
+void ORF24::setRetries(int count)
+{
+	if (debug)
+	{
+		std::cout << "Setting up retransmission configuration...\n";
+	}
+
+	autoRetryDelay = true;
+	retryCount = count;
+
+	updateRetryDelay();
+}
+
+/**
+ * Set largest ACK payload size expected from receivers
+ *
+ * @param size 	ACK payload size in bytes
+ */
+void ORF24::setAckPayloadSize(int size)
+{
+	const int max = 32;
+
+	ackPayloadSize = max > size ? size : max;
+
+	if (autoRetryDelay)
+	{
+		updateRetryDelay();
+	}
+}
+
+/**
+ * Write the shortest valid retransmission delay for current data rate
+ * and ACK payload size
+ */
+void ORF24::updateRetryDelay(void)
+{
+	unsigned char delay = minimumRetryDelay(dataRate, ackPayloadSize);
+
+	if (debug)
+	{
+		std::cout << "Retransmission delay is " << (delay + 1) * 250 << " us.\n";
+	}
+
+	Driver<ORF24>::setRetries(*this, delay, retryCount);
 }
 
 /**
@@ -236,9 +894,7 @@ void ORF24::setChannel(int channel)
 		std::cout << "Setting up RF channel...\n";
 	}
 
-	const int max = 127;
-
-	writeRegister(RF_CH, max > channel ? channel : max);
+	Driver<ORF24>::setChannel(*this, channel);
 }
 
 /**
@@ -270,50 +926,66 @@ void ORF24::setPowerLevel(RFPower level)
 		std::cout << "Setting up RF power level...\n";
 	}
 
-	unsigned char setup = readRegister(RF_SETUP);
-
-	setup &= ~(1 << RF_PWR_LOW | 1 << RF_PWR_HIGH);
-
-	switch (level)
-	{
-		case RF_PA_MAX:
-			setup |= (1 << RF_PWR_LOW | 1 << RF_PWR_HIGH);
-			break;
-
-		case RF_PA_HIGH:
-			setup |= (1 << RF_PWR_HIGH);
-			break;
+	Driver<ORF24>::setPowerLevel(*this, level);
 
-		case RF_PA_LOW:
-			setup |= (1 << RF_PWR_LOW);
-			break;
-	}
+	/* TX time so far was spent at the old level */
+	enterPowerState(powerState);
+	powerLevel = level;
+}
 
-	writeRegister(RF_SETUP, setup);
+/**
+ * Get power level
+ *
+ * @return  power level
+ */
+RFPower ORF24::getPowerLevel(void)
+{
+	return powerLevel;
 }
 
 /**
  * Set air data rate
  * 
  * @param rate 		data rate
+ * @return 			false if rate is not supported by the chip
  */
-void ORF24::setDataRate(DataRate rate)
+bool ORF24::setDataRate(DataRate rate)
 {
 	if (debug)
 	{
 		std::cout << "Setting up air data rate...\n";
 	}
 
-	unsigned char setup = readRegister(RF_SETUP);
+	if (rate == RF_DR_250KBPS && !plusVariant)
+	{
+		if (debug)
+		{
+			std::cout << "250 kbps requires nRF24L01+.\n";
+		}
+
+		return false;
+	}
+
+	Driver<ORF24>::setDataRate(*this, rate);
 
-	setup &= ~(1 << RF_DR);
+	dataRate = rate;
 
-	if (rate == RF_DR_2MBPS)
+	if (autoRetryDelay)
 	{
-		setup |= (1 << RF_DR);
+		updateRetryDelay();
 	}
 
-	writeRegister(RF_SETUP, setup);	
+	return true;
+}
+
+/**
+ * Get air data rate
+ *
+ * @return  data rate
+ */
+DataRate ORF24::getDataRate(void)
+{
+	return dataRate;
 }
 
 /**
@@ -328,22 +1000,7 @@ void ORF24::setCRCLength(CRCLength length)
 		std::cout << "Setting up CRC...\n";
 	}
 
-	unsigned char config = readRegister(CONFIG);
-
-	config &= ~(1 << CRCO | 1 << EN_CRC);
-
-	switch (length)
-	{
-		case CRC_1_BYTE:
-			config |= (1 << EN_CRC);
-			break;
-
-		case CRC_2_BYTE:
-			config |= (1 << EN_CRC) | (1 << CRCO);
-			break;
-	}
-
-	writeRegister(CONFIG, config);
+	Driver<ORF24>::setCRCLength(*this, length);
 }
 
 /**
@@ -360,7 +1017,7 @@ void ORF24::setAutoACK(bool enable)
 			std::cout << "Enabling Auto Acknowledgment...\n";
 		}
 
-		writeRegister(EN_AA, 0b111111);
+		Driver<ORF24>::setAutoACK(*this, true);
 	}
 	else
 	{
@@ -369,7 +1026,7 @@ void ORF24::setAutoACK(bool enable)
 			std::cout << "Disabling Auto Acknowledgment...\n";
 		}
 
-		writeRegister(EN_AA, 0);
+		Driver<ORF24>::setAutoACK(*this, false);
 	}
 }
 
@@ -424,7 +1081,7 @@ unsigned char ORF24::flushRX(void)
 
 	*p = FLUSH_RX;
 
-	wiringPiSPIDataRW(spiChannel, buffer, 1);
+	transport->transfer(spiChannel, buffer, 1);
 
 	return *buffer;
 }
@@ -445,7 +1102,7 @@ unsigned char ORF24::flushTX(void)
 
 	*p = FLUSH_TX;
 
-	wiringPiSPIDataRW(spiChannel, buffer, 1);
+	transport->transfer(spiChannel, buffer, 1);
 
 	return *buffer;
 }
@@ -461,7 +1118,7 @@ unsigned char ORF24::getStatus(void)
 
 	*p = NOP;
 
-	wiringPiSPIDataRW(spiChannel, buffer, 1);
+	transport->transfer(spiChannel, buffer, 1);
 
 	return *buffer;
 }
@@ -489,23 +1146,17 @@ bool ORF24::write(unsigned char *data, int len)
 
 	startWrite(data, len);
 
-	unsigned char observeTX, status;
-	int sentAt = millis();
-	const unsigned long timeout = 500;
+	unsigned char status = Driver<ORF24>::waitForWrite(*this, *transport, writeTimeout(), &lastObserveTX);
 
-	do
+	if (!(status & (1 << TX_DS | 1 << MAX_RT)))
 	{
-		status = readRegister(OBSERVE_TX, &observeTX, 1);
-	} while (! (status & (1 << TX_DS | 1 << MAX_RT)) && (millis() - sentAt < timeout));
-
-	bool txOK, txFail, rxReady;
+		writeTimeouts++;
+	}
 
-	status = writeRegister(STATUS, 1 << RX_DR | 1 << TX_DS | 1 << MAX_RT);
-	txOK = status & (1 << TX_DS);
-	txFail = status & (1 << MAX_RT);
-	rxReady = status & (1 << RX_DR);
+	status = Driver<ORF24>::finishWrite(*this);
+	writing = false;
 
-	result = txOK;
+	result = status & (1 << TX_DS);
 
 	if (debug)
 	{
@@ -519,11 +1170,149 @@ bool ORF24::write(unsigned char *data, int len)
 		}
 	}
 
-	powerDown();
+	return result;
+}
 
-	flushTX();
+/**
+ * Check whether a write started with startWrite has finished
+ *
+ * @param  delivered 	set to whether the payload was acknowledged
+ * @return           	true if the write has finished
+ */
+bool ORF24::pollWrite(bool *delivered)
+{
+	unsigned char status = readRegister(OBSERVE_TX, &lastObserveTX, 1);
 
-	return result;
+	if (!(status & (1 << TX_DS | 1 << MAX_RT)))
+	{
+		if (transport->millis() - writeStartedAt < writeTimeout())
+		{
+			return false;
+		}
+
+		writeTimeouts++;
+		*delivered = false;
+		flushTX();
+		enterPowerState(POWER_STANDBY);
+		writing = false;
+
+		return true;
+	}
+
+	writeRegister(STATUS, IRQFlags::mask);
+
+	*delivered = status & (1 << TX_DS);
+
+	/* Payload stays in TX FIFO after MAX_RT */
+	if (!*delivered)
+	{
+		flushTX();
+	}
+
+	enterPowerState(POWER_STANDBY);
+	writing = false;
+
+	return true;
+}
+
+/**
+ * Check for TX_DS or MAX_RT with a single STATUS read
+ *
+ * @return  true if the write has finished
+ */
+bool ORF24::isWriteDone(void)
+{
+	return getStatus() & (1 << TX_DS | 1 << MAX_RT);
+}
+
+/**
+ * Write payload and switch to RX as soon as it is acknowledged
+ *
+ * @param  data 	data to write
+ * @param  len  	data length
+ * @return      	true if acknowledged and listening
+ */
+bool ORF24::writeAndListen(unsigned char *data, int len)
+{
+	bool delivered;
+
+	if (listening)
+	{
+		transport->writeCE(ce, LOW);
+		listening = false;
+
+		if (pipe0Reading && txAddressSet)
+		{
+			writeRegister(RX_ADDR_P0, txAddress, addressSize);
+		}
+	}
+
+	startWrite(data, len);
+
+	while (!pollWrite(&delivered))
+		;
+
+	if (!delivered)
+	{
+		return false;
+	}
+
+	setEnabledPipes(1, 0);
+
+	/* Still powered up, RX settles 130 us after CE goes high */
+	writeRegister(CONFIG, PrimaryRX::update(writeConfig, 1));
+	transport->writeCE(ce, HIGH);
+	enterPowerState(POWER_RX);
+
+	listening = true;
+
+	return true;
+}
+
+/**
+ * Sample carrier detect on the current channel
+ *
+ * @return  true if channel is busy
+ */
+bool ORF24::testCarrier(void)
+{
+	if (listening)
+	{
+		return readRegister(CD) & (1 << MD);
+	}
+
+	unsigned char config = readRegister(CONFIG);
+	bool poweredUp = PowerUp::decode(config);
+
+	config = PowerUp::update(config, 1);
+	writeRegister(CONFIG, PrimaryRX::update(config, 1));
+
+	if (!poweredUp)
+	{
+		transport->delayMicroseconds(1500);
+	}
+
+	/* RX settling plus the CD detection time */
+	transport->writeCE(ce, HIGH);
+	enterPowerState(POWER_RX);
+	transport->delayMicroseconds(170);
+
+	bool busy = readRegister(CD) & (1 << MD);
+
+	transport->writeCE(ce, LOW);
+	enterPowerState(POWER_STANDBY);
+
+	return busy;
+}
+
+/**
+ * Get OBSERVE_TX register value at the end of last write
+ *
+ * @return  packet lost and retransmission counters
+ */
+unsigned char ORF24::getObserveTX(void)
+{
+	return lastObserveTX;
 }
 
 /**
@@ -534,18 +1323,15 @@ bool ORF24::write(unsigned char *data, int len)
  */
 void ORF24::startWrite(unsigned char *data, int len)
 {
-	unsigned char config = readRegister(CONFIG);
-	config |= (1 << PWR_UP);
-	config &= ~(1 << PRIM_RX);
-	writeRegister(CONFIG, config);
-
-	delayMicroseconds(150);
+	writeConfig = Driver<ORF24>::enterTX(*this, *transport);
 
 	writePayload(data, len);
 
-	digitalWrite(ce, HIGH);
-	delayMicroseconds(15);
-	digitalWrite(ce, LOW);
+	writeStartedAt = transport->millis();
+	writing = true;
+
+	enterPowerState(POWER_TX);
+	transport->pulseCE(ce, 15);
 }
 
 /**
@@ -553,16 +1339,17 @@ void ORF24::startWrite(unsigned char *data, int len)
  */
 void ORF24::powerUp(void)
 {
-	unsigned char config = readRegister(CONFIG);
-
-	config |= (1 << PWR_UP);
-
 	if (debug)
 	{
 		std::cout << "Setting nRF24L01 to Standby-I mode...\n";
 	}
 
-	writeRegister(CONFIG, config);
+	Driver<ORF24>::setPowerUp(*this, true);
+
+	if (powerState == POWER_DOWN)
+	{
+		enterPowerState(POWER_STANDBY);
+	}
 }
 
 /**
@@ -570,16 +1357,86 @@ void ORF24::powerUp(void)
  */
 void ORF24::powerDown(void)
 {
-	unsigned char config = readRegister(CONFIG);
-
-	config &= ~(1 << PWR_UP);
-
 	if (debug)
 	{
 		std::cout << "Setting nRF24L01 to Power Down mode...\n";
 	}
 
-	writeRegister(CONFIG, config);
+	Driver<ORF24>::setPowerUp(*this, false);
+	enterPowerState(POWER_DOWN);
+}
+
+/**
+ * Get current operating mode
+ *
+ * @return  operating mode
+ */
+PowerState ORF24::getPowerState(void)
+{
+	return powerState;
+}
+
+/**
+ * Account time spent in the current operating mode and switch mode
+ *
+ * @param state 	new operating mode
+ */
+void ORF24::enterPowerState(PowerState state)
+{
+	/* 64 bit clock, a 32 bit micros() difference wraps after 71 minutes asleep */
+	unsigned long long now = transport->nanos();
+	unsigned long long elapsed = now - powerStateSince;
+
+	powerStateTime[powerState] += elapsed;
+
+	if (powerState == POWER_TX)
+	{
+		txTime[powerLevel] += elapsed;
+	}
+
+	powerState = state;
+	powerStateSince = now;
+}
+
+/**
+ * Clear operating mode times and start in power down
+ */
+void ORF24::resetPowerAccounting(void)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		powerStateTime[i] = 0;
+		txTime[i] = 0;
+	}
+
+	powerState = POWER_DOWN;
+	powerStateSince = transport->nanos();
+}
+
+/**
+ * Get time spent in an operating mode since initialization
+ *
+ * @param  state 	operating mode
+ * @return       	time in microseconds
+ */
+unsigned long long ORF24::getPowerStateTime(PowerState state)
+{
+	enterPowerState(powerState);
+
+	return powerStateTime[state] / 1000;
+}
+
+/**
+ * Get time spent transmitting at a power level since initialization
+ *
+ * @param  level 	power level
+ * @return       	time in microseconds
+ */
+unsigned long long ORF24::getTXTime(RFPower level)
+{
+	enterPowerState(powerState);
+
+	return txTime[level] / 1000;
 }
 
 /**
@@ -589,11 +1446,12 @@ void ORF24::powerDown(void)
  */
 void ORF24::openWritingPipe(const char *addr)
 {
-	writeRegister(RX_ADDR_P0, (unsigned char *) addr, 5);
-	writeRegister(TX_ADDR, (unsigned char *) addr, 5);
+	std::memcpy(txAddress, addr, addressSize);
+	txAddressSet = true;
 
-	const int maxPayloadSize = 32;
-	writeRegister(RX_PW_P0, maxPayloadSize > payloadSize ? payloadSize : maxPayloadSize);
+	Driver<ORF24>::writeTXAddress(*this, txAddress, addressSize);
+
+	setPipePayloadSize(0);
 }
 
 /**
@@ -604,69 +1462,215 @@ void ORF24::openWritingPipe(const char *addr)
  */
 void ORF24::openReadingPipe(int pipe, const char *address)
 {
-	unsigned char *tmp = (unsigned char *) address;
+	if (pipe < 0 || pipe > 5)
+	{
+		return;
+	}
+
+	if (debug)
+	{
+		std::cout << "Opening reading pipe with address \"" << address << "\"...\n";
+	}
 
-	unsigned char setupAW = readRegister(SETUP_AW);
+	unsigned char addr[5];
 
-	int addressSize;
-	switch (setupAW)
+	Driver<ORF24>::writeRXAddress(*this, pipe, (const unsigned char *) address, addressSize, addr);
+
+	if (pipe == 0)
 	{
-		case 0b01:
-			addressSize = 3;
-			break;
+		std::memcpy(pipe0ReadingAddress, addr, addressSize);
+		pipe0Reading = true;
+	}
 
-		case 0b10:
-			addressSize = 4;
-			break;
+	setPipePayloadSize(pipe);
+	setEnabledPipes(1 << pipe, 0);
+}
 
-		case 0b11:
-		default:
-			addressSize = 5;
+/**
+ * Close reading pipe
+ *
+ * @param pipe 	pipe number
+ */
+void ORF24::closeReadingPipe(int pipe)
+{
+	if (pipe < 0 || pipe > 5)
+	{
+		return;
 	}
 
-	if (debug)
+	if (pipe == 0)
 	{
-		std::cout << "Opening reading pipe with address \"" << address << "\"...\n";
+		pipe0Reading = false;
 	}
 
-	unsigned char addr[addressSize];
+	setEnabledPipes(0, 1 << pipe);
+}
 
-	for (int i = 0; i < addressSize; i++)
+/**
+ * Write EN_RXADDR if enabled pipes changed
+ *
+ * The register is read once if the cache is unknown, so pipes other
+ * chip users enabled are kept.
+ *
+ * @param  set 		pipes to enable, bit mask
+ * @param  clear 	pipes to disable, bit mask
+ */
+void ORF24::setEnabledPipes(unsigned char set, unsigned char clear)
+{
+	if (rxPipes < 0)
 	{
-		addr[i] = tmp[addressSize - 1 - i];
+		rxPipes = readRegister(EN_RXADDR);
 	}
 
-	if (pipe == 0)
+	int pipes = (rxPipes | set) & ~clear & RXPipes::mask;
+
+	if (pipes != rxPipes)
+	{
+		writeRegister(EN_RXADDR, pipes);
+		rxPipes = pipes;
+	}
+}
+
+/**
+ * Write RX_PW_Px if pipe payload size changed
+ *
+ * @param  pipe 	pipe number
+ */
+void ORF24::setPipePayloadSize(int pipe)
+{
+	if (rxPayloadSizes[pipe] != payloadSize)
 	{
-		pipe0ReadingAddress = addr;
+		writeRegister(pipePayloadRegister(pipe), payloadSize);
+		rxPayloadSizes[pipe] = payloadSize;
 	}
+}
+
+/**
+ * Forget cached pipe registers after the chip was reconfigured
+ */
+void ORF24::resetPipeCache(void)
+{
+	rxPipes = -1;
+
+	for (int i = 0; i < 6; i++)
+	{
+		rxPayloadSizes[i] = -1;
+	}
+}
+
+/**
+ * Enter RX mode
+ */
+void ORF24::startListening(void)
+{
+	unsigned char config = readRegister(CONFIG);
+	bool poweredUp = PowerUp::decode(config);
+
+	config = PowerUp::update(config, 1);
+	config = PrimaryRX::update(config, 1);
+	writeRegister(CONFIG, config);
 
-	const unsigned char childPipe[] =
+	writeRegister(STATUS, IRQFlags::mask);
+
+	if (pipe0Reading)
 	{
-		RX_ADDR_P0, RX_ADDR_P1, RX_ADDR_P2, RX_ADDR_P3, RX_ADDR_P4, RX_ADDR_P5
-	};
+		writeRegister(RX_ADDR_P0, pipe0ReadingAddress, addressSize);
+	}
 
-	const unsigned char childPayloadSize[] =
+	/* Crystal start up from power down */
+	if (!poweredUp)
 	{
-		RX_PW_P0, RX_PW_P1, RX_PW_P2, RX_PW_P3, RX_PW_P4, RX_PW_P5
-	};
+		transport->delayMicroseconds(1500);
+	}
+
+	transport->writeCE(ce, HIGH);
+	enterPowerState(POWER_RX);
+	transport->delayMicroseconds(130);
+
+	listening = true;
+}
+
+/**
+ * Leave RX mode
+ */
+void ORF24::stopListening(void)
+{
+	transport->writeCE(ce, LOW);
+
+	unsigned char config = readRegister(CONFIG);
+	writeRegister(CONFIG, PrimaryRX::update(config, 0));
 
-	const unsigned char childPipeEnable[] =
+	if (pipe0Reading && txAddressSet)
 	{
-		ERX_P0, ERX_P1, ERX_P2, ERX_P3, ERX_P4, ERX_P5
-	};
+		writeRegister(RX_ADDR_P0, txAddress, addressSize);
+	}
 
-	if (pipe <= 6)
+	if (powerState != POWER_DOWN)
 	{
-		if (pipe < 2)
-			writeRegister(childPipe[pipe], addr, 5);
-		else
-			writeRegister(childPipe[0], addr, 1);
+		enterPowerState(POWER_STANDBY);
+	}
+
+	listening = false;
+}
+
+/**
+ * Check whether a payload was received
+ *
+ * @return  true if RX FIFO is not empty
+ */
+bool ORF24::available(void)
+{
+	return available(NULL);
+}
+
+/**
+ * Check whether a payload was received
+ *
+ * @param  pipe 	set to pipe number of the payload
+ * @return      	true if RX FIFO is not empty
+ */
+bool ORF24::available(int *pipe)
+{
+	int p = RXPipeNumber::decode(getStatus());
 
-		writeRegister(childPayloadSize[pipe], payloadSize);
+	/* RX_P_NO reads 0b111 when RX FIFO is empty */
+	if (p > 5)
+	{
+		return false;
+	}
 
-		writeRegister(EN_RXADDR, readRegister(EN_RXADDR) | (1 << childPipeEnable[pipe]));
+	if (pipe)
+	{
+		*pipe = p;
 	}
+
+	return true;
+}
+
+/**
+ * Read received payload
+ *
+ * @param  data 	data buffer to read into
+ * @param  len  	data length
+ * @return      	true if more payloads are waiting
+ */
+bool ORF24::read(unsigned char *data, int len)
+{
+	readPayload(data, len);
+
+	unsigned char status = writeRegister(STATUS, 1 << RX_DR);
+
+	return RXPipeNumber::decode(status) <= 5;
+}
+
+/**
+ * Get transport used for SPI, GPIO and timing
+ *
+ * @return  transport
+ */
+ORF24Transport *ORF24::getTransport(void)
+{
+	return transport;
 }
 
 /**
@@ -28,15 +28,14 @@
 #include <iostream>
 #include <string>
 #include <cstdio>
-#include <wiringPi.h>
-#include <wiringPiSPI.h>
 #include "nRF24L01.h"
-
-#define 	MOSI_PIN		12
-#define 	SLCK_PIN		14
+#include "ORF24Transport.h"
+#include "nRF24L01Driver.h"
 
 class ORF24
 {
+	friend struct nRF24L01::Driver<ORF24>;
+
 private:
 	int ce;							/* CE pin number */
 	int csn;						/* CSN pin number */
@@ -47,8 +46,34 @@ private:
 	bool ackPayloadLength;			/* Dynamic size of pending ack payload */
 	bool dynamicPayloadAvailable;	/* Whether dynamic payload are enabled */
 	bool debug = false;				/* Debug flag */
-	unsigned char buffer[32];		/* RX and TX buffer */
-	unsigned char *pipe0ReadingAddress;
+	unsigned char buffer[33];		/* RX and TX buffer */
+	unsigned char pipe0ReadingAddress[5];	/* Reading address of pipe 0, restored when listening */
+	bool pipe0Reading = false;		/* Whether pipe 0 is a reading pipe */
+	unsigned char txAddress[5];		/* Writing pipe address, restored to pipe 0 after listening */
+	bool txAddressSet = false;		/* Whether writing pipe is open */
+	int addressSize = 5;			/* Address width in bytes */
+	int rxPipes = -1;				/* EN_RXADDR shadow, -1 if unknown */
+	int rxPayloadSizes[6] = { -1, -1, -1, -1, -1, -1 };	/* RX_PW_Px shadow, -1 if unknown */
+	bool listening = false;			/* Whether chip is in RX mode */
+	unsigned long initTime;			/* Last initialization time in microseconds */
+	ORF24Transport *transport;		/* SPI and GPIO access */
+	bool plusVariant = false;		/* Whether chip is nRF24L01+ */
+	DataRate dataRate = RF_DR_1MBPS;	/* Current air data rate */
+	int retryCount = 0b1111;		/* Retransmission count */
+	int ackPayloadSize = 0;			/* Largest expected ACK payload */
+	bool autoRetryDelay = true;		/* Whether retransmission delay follows data rate */
+	unsigned char lastObserveTX = 0;	/* OBSERVE_TX at the end of last write */
+	unsigned int writeStartedAt = 0;	/* Time of last startWrite in milliseconds */
+	bool writing = false;			/* Whether a startWrite is not finished yet */
+	unsigned char writeConfig = 0;	/* CONFIG written by last startWrite */
+	RFPower powerLevel = RF_PA_MIN;	/* Current PA level */
+	PowerState powerState = POWER_DOWN;	/* Operating mode for energy accounting */
+	unsigned long long powerStateSince = 0;	/* Time of last mode change in nanoseconds */
+	unsigned long long powerStateTime[4] = {};	/* Time per mode in nanoseconds */
+	unsigned long long txTime[4] = {};	/* TX time per PA level in nanoseconds */
+	unsigned char shadow[0x1E][5] = {};	/* Configuration last written or saved, per register */
+	unsigned int shadowKnown = 0;	/* Registers held in shadow, one bit per address */
+	unsigned long writeTimeouts = 0;	/* Writes that raised neither TX_DS nor MAX_RT */
 
 protected:
 
@@ -89,6 +114,75 @@ protected:
 	 */
 	unsigned char writeRegister(unsigned char reg, const unsigned char *buf, int len);
 
+	/**
+	 * Write a list of single byte registers in one SPI batch
+	 *
+	 * @param  regs 	list of register address and value pairs
+	 * @param  count 	number of registers to write
+	 */
+	void writeRegisters(const unsigned char (*regs)[2], int count);
+
+	/**
+	 * Remember a configuration register value written to the chip
+	 *
+	 * @param  reg 	register address
+	 * @param  buf 	written value
+	 * @param  len 	value length
+	 */
+	void updateShadow(unsigned char reg, const unsigned char *buf, int len);
+
+	/**
+	 * Count configuration registers that differ from the shadow
+	 *
+	 * @return  number of differing registers
+	 */
+	int verifyConfig(void);
+
+	/**
+	 * Write the shadow back to the configuration registers
+	 */
+	void restoreConfig(void);
+
+	/**
+	 * Longest time a write can take before MAX_RT
+	 *
+	 * @return  timeout in milliseconds
+	 */
+	unsigned long writeTimeout(void);
+
+	/**
+	 * Wait until nRF24L01 responds to register access
+	 *
+	 * @param  timeout 	maximum wait time in milliseconds
+	 * @return         	true if chip is ready
+	 */
+	bool waitForChip(unsigned long timeout);
+
+	/**
+	 * Detect nRF24L01+ by probing the RF_DR_LOW bit
+	 *
+	 * @return  true if chip is nRF24L01+
+	 */
+	bool detectPlusVariant(void);
+
+	/**
+	 * Write the shortest valid retransmission delay for current data rate
+	 * and ACK payload size
+	 */
+	void updateRetryDelay(void);
+
+	/**
+	 * Account time spent in the current operating mode and switch mode
+	 *
+	 * @param state 	new operating mode
+	 */
+	void enterPowerState(PowerState state);
+
+	/**
+	 * Clear operating mode times and start in power down
+	 */
+	void resetPowerAccounting(void);
+
 	/**
 	 * Write payload to send
 	 * 
@@ -128,6 +222,37 @@ protected:
 	 */
 	unsigned char getStatus(void);
 
+	/**
+	 * Check register access at an SPI clock
+	 *
+	 * Writes test patterns to TX_ADDR and RX_ADDR_P0 and reads them back.
+	 *
+	 * @param  speed 	SPI clock frequency in Hz
+	 * @param  rounds 	number of patterns per register
+	 * @return        	true if every pattern read back unchanged
+	 */
+	bool verifySPISpeed(int speed, int rounds);
+
+	/**
+	 * Write EN_RXADDR if enabled pipes changed
+	 *
+	 * @param  set 		pipes to enable, bit mask
+	 * @param  clear 	pipes to disable, bit mask
+	 */
+	void setEnabledPipes(unsigned char set, unsigned char clear);
+
+	/**
+	 * Write RX_PW_Px if pipe payload size changed
+	 *
+	 * @param  pipe 	pipe number
+	 */
+	void setPipePayloadSize(int pipe);
+
+	/**
+	 * Forget cached pipe registers after the chip was reconfigured
+	 */
+	void resetPipeCache(void);
+
 	/**
 	 * Print register value
 	 *
@@ -171,6 +296,11 @@ public:
 	 */
 	ORF24(int _ce, int _spiChannel, int spiSpeed);
 
+	/**
+	 * ORF24 Constructor with SPI options and custom transport
+	 */
+	ORF24(int _ce, int _spiChannel, int spiSpeed, ORF24Transport *_transport);
+
 	/**
 	 * nRF24L01 Initialization
 	 * 
@@ -178,6 +308,96 @@ public:
 	 */
 	bool begin(void);
 
+	/**
+	 * nRF24L01 fast initialization
+	 *
+	 * Poll the chip until it is ready instead of waiting for the worst case
+	 * power on reset time, then write the default configuration in one batch.
+	 *
+	 * @return  true if chip is present
+	 */
+	bool fastBegin(void);
+
+	/**
+	 * Check whether nRF24L01 is connected and responding
+	 *
+	 * @return  true if chip is present
+	 */
+	bool isChipConnected(void);
+
+	/**
+	 * Read every configuration register as the known configuration
+	 *
+	 * Register writes of the driver keep it up to date afterwards. Call
+	 * once the radio is configured, before checkHealth().
+	 */
+	void saveConfig(void);
+
+	/**
+	 * Check STATUS, FIFO_STATUS and configuration registers for faults
+	 *
+	 * A missing or unpowered chip, configuration lost in a brown-out,
+	 * MAX_RT latched, payloads left in the TX FIFO while idle and an
+	 * inconsistent RX FIFO are reported. TX faults are not reported while a
+	 * write started with startWrite is in flight, unless it timed out.
+	 *
+	 * @return  HealthFault bit mask, HEALTH_OK if healthy
+	 */
+	int checkHealth(void);
+
+	/**
+	 * Recover from faults without reinitializing the chip
+	 *
+	 * Flushes the affected FIFO, clears the interrupt flags and writes the
+	 * known configuration back. A missing chip is waited for up to 150 ms.
+	 *
+	 * @param faults 	HealthFault bit mask
+	 */
+	void recover(int faults);
+
+	/**
+	 * Get number of writes that raised neither TX_DS nor MAX_RT in time
+	 *
+	 * @return  write timeouts since construction
+	 */
+	unsigned long getWriteTimeouts(void);
+
+	/**
+	 * Find the fastest reliable SPI clock
+	 *
+	 * Steps the SPI clock up to 10 MHz, verifying register readback at each
+	 * step, and keeps the fastest step at or below 80 % of the fastest one
+	 * with no errors. Call after begin().
+	 *
+	 * @param  path 	file to store the result in, or NULL
+	 * @return      	selected SPI clock frequency in Hz, 0 on failure
+	 */
+	int calibrateSPISpeed(const char *path);
+
+	/**
+	 * Load SPI clock stored by calibrateSPISpeed
+	 *
+	 * Call before begin().
+	 *
+	 * @param  path 	file the result was stored in
+	 * @return      	true if a valid speed was loaded
+	 */
+	bool loadSPISpeed(const char *path);
+
+	/**
+	 * Get SPI clock frequency
+	 *
+	 * @return  frequency in Hz
+	 */
+	int getSPISpeed(void);
+
+	/**
+	 * Get time taken by the last initialization
+	 *
+	 * @return  initialization time in microseconds
+	 */
+	unsigned long getInitTime(void);
+
 	/**
 	 * Write payload to open writing pipe
 	 * 
@@ -195,6 +415,58 @@ public:
 	 */
 	void startWrite(unsigned char *data, int len);
 
+	/**
+	 * Check whether a write started with startWrite has finished
+	 *
+	 * Clears the interrupt flags and flushes a payload that hit MAX_RT or
+	 * the write timeout. The chip is left in Standby-I.
+	 *
+	 * @param  delivered 	set to whether the payload was acknowledged
+	 * @return           	true if the write has finished
+	 */
+	bool pollWrite(bool *delivered);
+
+	/**
+	 * Check for TX_DS or MAX_RT with a single STATUS read
+	 *
+	 * Leaves the flags set, call pollWrite to finish the write.
+	 *
+	 * @return  true if the write has finished
+	 */
+	bool isWriteDone(void);
+
+	/**
+	 * Write payload and switch to RX as soon as it is acknowledged
+	 *
+	 * The chip stays powered up and only PRIM_RX is flipped, so a reply
+	 * can be received on pipe 0 with the writing pipe address about 130 us
+	 * after the ACK. Pipe 0 reading address is restored by the next
+	 * startListening.
+	 *
+	 * @param  data 	data to write
+	 * @param  len  	data length
+	 * @return      	true if acknowledged and listening
+	 */
+	bool writeAndListen(unsigned char *data, int len);
+
+	/**
+	 * Sample carrier detect on the current channel
+	 *
+	 * Enters RX for long enough to latch CD and returns to Standby-I with
+	 * PRIM_RX still set, the next write clears it. When already listening
+	 * only CD is read.
+	 *
+	 * @return  true if channel is busy
+	 */
+	bool testCarrier(void);
+
+	/**
+	 * Get OBSERVE_TX register value at the end of last write
+	 *
+	 * @return  packet lost and retransmission counters
+	 */
+	unsigned char getObserveTX(void);
+
 	/**
 	 * Set delay and number of retry for retransmission
 	 *
@@ -203,6 +475,22 @@ public:
 	 */
 	void setRetries(int delay, int count);
 
+	/**
+	 * Set number of retry and use the shortest valid retransmission delay
+	 *
+	 * The delay follows later data rate and ACK payload size changes.
+	 *
+	 * @param count 	retransmission count
+	 */
+	void setRetries(int count);
+
+	/**
+	 * Set largest ACK payload size expected from receivers
+	 *
+	 * @param size 	ACK payload size in bytes
+	 */
+	void setAckPayloadSize(int size);
+
 	/**
 	 * Set RF channel
 	 * 
@@ -224,12 +512,34 @@ public:
 	 */
 	void setPowerLevel(RFPower level);
 
+	/**
+	 * Get power level
+	 *
+	 * @return  power level
+	 */
+	RFPower getPowerLevel(void);
+
 	/**
 	 * Set air data rate
 	 * 
 	 * @param rate 		data rate
+	 * @return 			false if rate is not supported by the chip
+	 */
+	bool setDataRate(DataRate rate);
+
+	/**
+	 * Get air data rate
+	 *
+	 * @return  data rate
 	 */
-	void setDataRate(DataRate rate);
+	DataRate getDataRate(void);
+
+	/**
+	 * Check whether chip is nRF24L01+
+	 *
+	 * @return  true if chip is nRF24L01+
+	 */
+	bool isPlusVariant(void);
 
 	/**
 	 * Set CRC length
@@ -263,6 +573,32 @@ public:
 	 */
 	void powerDown(void);
 
+	/**
+	 * Get current operating mode
+	 *
+	 * @return  operating mode
+	 */
+	PowerState getPowerState(void);
+
+	/**
+	 * Get time spent in an operating mode since initialization
+	 *
+	 * Time is taken from the microseconds clock, which wraps after about 71
+	 * minutes, so read it at least that often while the mode does not change.
+	 *
+	 * @param  state 	operating mode
+	 * @return       	time in microseconds
+	 */
+	unsigned long long getPowerStateTime(PowerState state);
+
+	/**
+	 * Get time spent transmitting at a power level since initialization
+	 *
+	 * @param  level 	power level
+	 * @return       	time in microseconds
+	 */
+	unsigned long long getTXTime(RFPower level);
+
 	/**
 	 * Open writing pipe
 	 * 
@@ -278,6 +614,58 @@ public:
 	 */
 	void openReadingPipe(int pipe, const char *address);
 
+	/**
+	 * Get transport used for SPI, GPIO and timing
+	 *
+	 * @return  transport
+	 */
+	ORF24Transport *getTransport(void);
+
+	/**
+	 * Close reading pipe
+	 *
+	 * @param pipe 	pipe number
+	 */
+	void closeReadingPipe(int pipe);
+
+	/**
+	 * Enter RX mode
+	 *
+	 * Restores the pipe 0 reading address that openWritingPipe replaced.
+	 */
+	void startListening(void);
+
+	/**
+	 * Leave RX mode
+	 *
+	 * Restores the writing address to pipe 0 for auto acknowledgment.
+	 */
+	void stopListening(void);
+
+	/**
+	 * Check whether a payload was received
+	 *
+	 * @return  true if RX FIFO is not empty
+	 */
+	bool available(void);
+
+	/**
+	 * Check whether a payload was received
+	 *
+	 * @param  pipe 	set to pipe number of the payload
+	 * @return      	true if RX FIFO is not empty
+	 */
+	bool available(int *pipe);
+
+	/**
+	 * Read received payload
+	 *
+	 * @param  data 	data buffer to read into
+	 * @param  len  	data length
+	 * @return      	true if more payloads are waiting
+	 */
+	bool read(unsigned char *data, int len);
+
 	/**
 	 * Enable debugging information
 	 */
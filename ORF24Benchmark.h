@@ -0,0 +1,64 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_BENCHMARK_H_
+#define _ORF_24_BENCHMARK_H_
+
+#include <chrono>
+
+/**
+ * Measure packet rate of a send operation
+ *
+ * Pair with NullTransport to compare driver overhead of ORF24 and
+ * ORF24Static without a radio attached, e.g.
+ *
+ *     NullTransport null;
+ *     ORF24 dynamic(25, 0, 8000000, &null);
+ *     ORF24Static<25, 0, 32, NullTransport> fixed;
+ *
+ *     benchmarkSend([&] { dynamic.write(data, 32); }, 100000);
+ *     benchmarkSend([&] { fixed.write(data); }, 100000);
+ *
+ * test/benchmark.cpp runs this comparison.
+ *
+ * @param  send 	callable sending one packet
+ * @param  count 	number of packets to send
+ * @return       	packets per second
+ */
+template <class Send>
+double benchmarkSend(Send send, int count)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < count; i++)
+	{
+		send();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return elapsed.count() > 0 ? count / elapsed.count() : 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,659 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <endian.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include "ORF24Bridge.h"
+#include "nRF24L01Register.h"
+
+using namespace nRF24L01;
+
+ORF24Bridge::ORF24Bridge(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize)
+{ }
+
+ORF24Bridge::~ORF24Bridge()
+{
+	close();
+}
+
+/**
+ * Finish opening a bound socket
+ *
+ * @param  socket 	bound socket
+ * @return        	true on success
+ */
+bool ORF24Bridge::start(int socket)
+{
+	fd = socket;
+
+	upHead = upCount = 0;
+	downHead = downCount = 0;
+
+	radio.startListening();
+
+	return true;
+}
+
+/**
+ * Open a UDP socket and start listening
+ *
+ * @param  localPort 	port to receive TX frames on
+ * @param  remoteHost 	backend IPv4 address, numeric
+ * @param  remotePort 	backend port
+ * @param  localHost 	IPv4 address to bind, numeric
+ * @return            	true on success
+ */
+bool ORF24Bridge::openUDP(int localPort, const char *remoteHost, int remotePort, const char *localHost)
+{
+	close();
+
+	struct sockaddr_in remote = {};
+	struct sockaddr_in local = {};
+
+	remote.sin_family = AF_INET;
+	remote.sin_port = htons(remotePort);
+	local.sin_family = AF_INET;
+	local.sin_port = htons(localPort);
+
+	if (inet_pton(AF_INET, remoteHost, &remote.sin_addr) != 1 ||
+		inet_pton(AF_INET, localHost, &local.sin_addr) != 1)
+	{
+		return false;
+	}
+
+	int s = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (s < 0)
+	{
+		return false;
+	}
+
+	if (bind(s, (struct sockaddr *) &local, sizeof(local)) < 0)
+	{
+		::close(s);
+		return false;
+	}
+
+	std::memcpy(&peer, &remote, sizeof(remote));
+	peerLength = sizeof(remote);
+
+	return start(s);
+}
+
+/**
+ * Open a Unix datagram socket and start listening
+ *
+ * @param  _localPath 	path to bind, replaced if it exists
+ * @param  remotePath 	path the backend is bound to
+ * @return            	true on success
+ */
+bool ORF24Bridge::openUnix(const char *_localPath, const char *remotePath)
+{
+	close();
+
+	struct sockaddr_un local = {};
+	struct sockaddr_un remote = {};
+
+	if (std::strlen(_localPath) >= sizeof(local.sun_path) || std::strlen(remotePath) >= sizeof(remote.sun_path))
+	{
+		return false;
+	}
+
+	local.sun_family = AF_UNIX;
+	std::strcpy(local.sun_path, _localPath);
+	remote.sun_family = AF_UNIX;
+	std::strcpy(remote.sun_path, remotePath);
+
+	int s = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	if (s < 0)
+	{
+		return false;
+	}
+
+	unlink(_localPath);
+
+	if (bind(s, (struct sockaddr *) &local, sizeof(local)) < 0)
+	{
+		::close(s);
+		return false;
+	}
+
+	localPath = _localPath;
+	std::memcpy(&peer, &remote, sizeof(remote));
+	peerLength = sizeof(remote);
+
+	return start(s);
+}
+
+/**
+ * Close socket
+ */
+void ORF24Bridge::close(void)
+{
+	if (fd >= 0)
+	{
+		::close(fd);
+		fd = -1;
+	}
+
+	if (!localPath.empty())
+	{
+		unlink(localPath.c_str());
+		localPath.clear();
+	}
+}
+
+/**
+ * Set longest time a frame waits for a full batch
+ *
+ * @param us 	delay in microseconds
+ */
+void ORF24Bridge::setMaxDelay(unsigned int us)
+{
+	maxDelay = us;
+}
+
+/**
+ * Take a free uplink frame
+ *
+ * @return  frame, NULL if the queue is full
+ */
+BridgeFrame *ORF24Bridge::reserveUplink(void)
+{
+	if (upCount == BRIDGE_QUEUE_SIZE)
+	{
+		uplinkDropped++;
+		return NULL;
+	}
+
+	BridgeFrame *frame = &uplink[(upHead + upCount) % BRIDGE_QUEUE_SIZE];
+	upCount++;
+
+	return frame;
+}
+
+/**
+ * Check whether a datagram was sent by the backend
+ *
+ * @param  from   	sender address
+ * @param  length 	sender address length
+ * @return        	true if sent from the backend address
+ */
+bool ORF24Bridge::isPeer(const struct sockaddr_storage &from, socklen_t length)
+{
+	if (from.ss_family != peer.ss_family)
+	{
+		return false;
+	}
+
+	if (from.ss_family == AF_INET)
+	{
+		const struct sockaddr_in *a = (const struct sockaddr_in *) &from;
+		const struct sockaddr_in *b = (const struct sockaddr_in *) &peer;
+
+		return length >= sizeof(*a) && a->sin_port == b->sin_port && a->sin_addr.s_addr == b->sin_addr.s_addr;
+	}
+
+	/* An unbound sender has no path */
+	if (length <= offsetof(struct sockaddr_un, sun_path))
+	{
+		return false;
+	}
+
+	const struct sockaddr_un *a = (const struct sockaddr_un *) &from;
+	const struct sockaddr_un *b = (const struct sockaddr_un *) &peer;
+	socklen_t pathLength = length - offsetof(struct sockaddr_un, sun_path);
+
+	return strnlen(a->sun_path, pathLength) == std::strlen(b->sun_path) &&
+		std::memcmp(a->sun_path, b->sun_path, std::strlen(b->sun_path)) == 0;
+}
+
+/**
+ * Read TX frames from the socket into the downlink queue
+ *
+ * @return  number of frames read
+ */
+int ORF24Bridge::pullDownlink(void)
+{
+	int space = BRIDGE_QUEUE_SIZE - downCount;
+
+	/* Leave commands in the socket so the backend sees the backlog */
+	if (space == 0)
+	{
+		deferred++;
+		return 0;
+	}
+
+	int n = space < BRIDGE_BATCH ? space : BRIDGE_BATCH;
+
+	BridgeFrame frames[BRIDGE_BATCH];
+	struct sockaddr_storage from[BRIDGE_BATCH];
+	struct iovec iov[BRIDGE_BATCH];
+	struct mmsghdr msgs[BRIDGE_BATCH];
+
+	std::memset(msgs, 0, n * sizeof(msgs[0]));
+
+	for (int i = 0; i < n; i++)
+	{
+		iov[i].iov_base = &frames[i];
+		iov[i].iov_len = sizeof(BridgeFrame);
+		msgs[i].msg_hdr.msg_name = &from[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	int count = recvmmsg(fd, msgs, n, MSG_DONTWAIT, NULL);
+	recvCalls++;
+
+	if (count <= 0)
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		const BridgeFrame &frame = frames[i];
+		unsigned int length = msgs[i].msg_len;
+
+		/* Only the backend may make the radio transmit */
+		if (!isPeer(from[i], msgs[i].msg_hdr.msg_namelen))
+		{
+			foreign++;
+			continue;
+		}
+
+		if (length < BRIDGE_HEADER_SIZE || frame.type != BRIDGE_TX || frame.len > payloadSize ||
+			length < BRIDGE_HEADER_SIZE + frame.len)
+		{
+			rejected++;
+
+			BridgeFrame *result = reserveUplink();
+
+			if (result)
+			{
+				std::memset(result, 0, BRIDGE_HEADER_SIZE);
+				result->type = BRIDGE_TX_RESULT;
+				result->status = BRIDGE_REJECTED;
+				result->sequence = length >= BRIDGE_HEADER_SIZE ? frame.sequence : 0;
+				result->timestamp = htole64(radio.getTransport()->nanos());
+			}
+
+			continue;
+		}
+
+		downlink[(downHead + downCount) % BRIDGE_QUEUE_SIZE] = frame;
+		downCount++;
+		commands++;
+	}
+
+	return count;
+}
+
+/**
+ * Read received packets into the uplink queue
+ *
+ * @return  number of packets read
+ */
+int ORF24Bridge::receive(void)
+{
+	const int fifoDepth = 3;
+	int count = 0;
+	int pipe;
+
+	while (count < fifoDepth && radio.available(&pipe))
+	{
+		BridgeFrame *frame = reserveUplink();
+
+		/* Drain the FIFO anyway, the packet is lost either way */
+		if (!frame)
+		{
+			unsigned char discard[32];
+
+			radio.read(discard, payloadSize);
+			count++;
+			continue;
+		}
+
+		unsigned char observeTX = radio.getObserveTX();
+
+		frame->type = BRIDGE_RX;
+		frame->pipe = pipe;
+		frame->len = payloadSize;
+		frame->status = 0;
+		frame->retries = RetransmitCounter::decode(observeTX);
+		frame->lost = LostPackets::decode(observeTX);
+		frame->reserved[0] = frame->reserved[1] = 0;
+		frame->sequence = htole32(rxSequence++);
+		frame->timestamp = htole64(radio.getTransport()->nanos());
+		std::memset(frame->address, 0, sizeof(frame->address));
+
+		/* Straight into the queue, sendmmsg sends from here */
+		radio.read(frame->data, payloadSize);
+
+		received++;
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * Send head of downlink queue and queue its result
+ */
+void ORF24Bridge::transmit(void)
+{
+	const BridgeFrame &command = downlink[downHead];
+
+	radio.stopListening();
+
+	if (!addressSet || std::memcmp(address, command.address, sizeof(address)) != 0)
+	{
+		std::memcpy(address, command.address, sizeof(address));
+		addressSet = true;
+
+		radio.openWritingPipe((const char *) address);
+	}
+
+	bool delivered;
+
+	radio.startWrite((unsigned char *) command.data, command.len);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	radio.startListening();
+
+	if (delivered)
+		sent++;
+	else
+		failed++;
+
+	BridgeFrame *result = reserveUplink();
+
+	if (result)
+	{
+		unsigned char observeTX = radio.getObserveTX();
+
+		std::memset(result, 0, BRIDGE_HEADER_SIZE);
+		result->type = BRIDGE_TX_RESULT;
+		result->status = delivered ? BRIDGE_DELIVERED : BRIDGE_FAILED;
+		result->retries = RetransmitCounter::decode(observeTX);
+		result->lost = LostPackets::decode(observeTX);
+		result->sequence = command.sequence;
+		result->timestamp = htole64(radio.getTransport()->nanos());
+		std::memcpy(result->address, command.address, sizeof(result->address));
+	}
+
+	downHead = (downHead + 1) % BRIDGE_QUEUE_SIZE;
+	downCount--;
+}
+
+/**
+ * Send uplink frames to the backend
+ *
+ * @param  force 	send even if no batch is full or due
+ * @return       	number of frames sent
+ */
+int ORF24Bridge::flush(bool force)
+{
+	if (upCount == 0)
+	{
+		return 0;
+	}
+
+	/* Send only full batches until the oldest frame is due */
+	int minimum = 1;
+
+	if (!force)
+	{
+		unsigned long long queuedAt = le64toh(uplink[upHead].timestamp);
+
+		if (radio.getTransport()->nanos() - queuedAt < maxDelay * 1000ULL)
+		{
+			minimum = BRIDGE_BATCH;
+		}
+	}
+
+	struct iovec iov[BRIDGE_BATCH];
+	struct mmsghdr msgs[BRIDGE_BATCH];
+	int total = 0;
+
+	while (upCount >= minimum)
+	{
+		/* Batch may not wrap around the end of the queue */
+		int n = BRIDGE_QUEUE_SIZE - upHead;
+		n = n < upCount ? n : upCount;
+		n = n < BRIDGE_BATCH ? n : BRIDGE_BATCH;
+
+		std::memset(msgs, 0, n * sizeof(msgs[0]));
+
+		for (int i = 0; i < n; i++)
+		{
+			BridgeFrame &frame = uplink[upHead + i];
+
+			iov[i].iov_base = &frame;
+			iov[i].iov_len = BRIDGE_HEADER_SIZE + frame.len;
+			msgs[i].msg_hdr.msg_name = &peer;
+			msgs[i].msg_hdr.msg_namelen = peerLength;
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		int count = sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+		sendCalls++;
+
+		if (count < 0)
+		{
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				sendBlocked++;
+				break;
+			}
+
+			/* Backend gone or address invalid, drop the frame instead of retrying forever */
+			upHead = (upHead + 1) % BRIDGE_QUEUE_SIZE;
+			upCount--;
+			uplinkDropped++;
+			break;
+		}
+
+		upHead = (upHead + count) % BRIDGE_QUEUE_SIZE;
+		upCount -= count;
+		forwarded += count;
+		total += count;
+
+		if (count < n)
+		{
+			break;
+		}
+	}
+
+	return total;
+}
+
+/**
+ * Run one service iteration
+ *
+ * @param  idleMs 	longest sleep when idle in milliseconds
+ * @return        	number of frames read and packets sent or received
+ */
+int ORF24Bridge::service(int idleMs)
+{
+	if (fd < 0)
+	{
+		return 0;
+	}
+
+	int count = pullDownlink();
+
+	count += receive();
+
+	if (downCount > 0)
+	{
+		transmit();
+		count++;
+	}
+
+	if (count > 0)
+	{
+		flush(false);
+		return count;
+	}
+
+	/* Nothing to do, send what is queued and wait for a command or the RX poll */
+	flush(true);
+
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN | (upCount > 0 ? POLLOUT : 0);
+	pfd.revents = 0;
+
+	poll(&pfd, 1, idleMs);
+
+	return count;
+}
+
+/**
+ * Get number of packets read from the radio
+ *
+ * @return  packets
+ */
+unsigned long ORF24Bridge::getReceived(void)
+{
+	return received;
+}
+
+/**
+ * Get number of frames sent to the backend
+ *
+ * @return  frames
+ */
+unsigned long ORF24Bridge::getForwarded(void)
+{
+	return forwarded;
+}
+
+/**
+ * Get number of frames dropped on a full uplink queue or a send error
+ *
+ * @return  frames
+ */
+unsigned long ORF24Bridge::getUplinkDropped(void)
+{
+	return uplinkDropped;
+}
+
+/**
+ * Get number of sends that found the socket buffer full
+ *
+ * @return  blocked sends
+ */
+unsigned long ORF24Bridge::getSendBlocked(void)
+{
+	return sendBlocked;
+}
+
+/**
+ * Get number of sendmmsg calls
+ *
+ * @return  system calls
+ */
+unsigned long ORF24Bridge::getSendCalls(void)
+{
+	return sendCalls;
+}
+
+/**
+ * Get number of TX frames accepted from the backend
+ *
+ * @return  frames
+ */
+unsigned long ORF24Bridge::getCommands(void)
+{
+	return commands;
+}
+
+/**
+ * Get number of malformed frames from the backend
+ *
+ * @return  frames
+ */
+unsigned long ORF24Bridge::getRejected(void)
+{
+	return rejected;
+}
+
+/**
+ * Get number of datagrams dropped because the backend did not send them
+ *
+ * @return  datagrams
+ */
+unsigned long ORF24Bridge::getForeign(void)
+{
+	return foreign;
+}
+
+/**
+ * Get number of iterations the socket was left unread for a full
+ * downlink queue
+ *
+ * @return  iterations
+ */
+unsigned long ORF24Bridge::getDeferred(void)
+{
+	return deferred;
+}
+
+/**
+ * Get number of recvmmsg calls
+ *
+ * @return  system calls
+ */
+unsigned long ORF24Bridge::getRecvCalls(void)
+{
+	return recvCalls;
+}
+
+/**
+ * Get number of TX frames acknowledged and not acknowledged
+ *
+ * @param _sent 	set to acknowledged frames
+ * @param _failed 	set to frames not acknowledged
+ */
+void ORF24Bridge::getStatistics(unsigned long *_sent, unsigned long *_failed)
+{
+	*_sent = sent;
+	*_failed = failed;
+}
\ No newline at end of file
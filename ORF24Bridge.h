@@ -0,0 +1,311 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_BRIDGE_H_
+#define _ORF_24_BRIDGE_H_
+
+#include <cstddef>
+#include <string>
+#include <sys/socket.h>
+#include "ORF24.h"
+
+#define		BRIDGE_QUEUE_SIZE	256
+#define		BRIDGE_BATCH		32
+
+/* Bridge frame types */
+enum BridgeFrameType {BRIDGE_RX = 1, BRIDGE_TX, BRIDGE_TX_RESULT};
+
+/* Outcome of a TX frame */
+enum BridgeStatus {BRIDGE_DELIVERED = 0, BRIDGE_FAILED, BRIDGE_REJECTED};
+
+/**
+ * Datagram exchanged with the backend
+ *
+ * One frame per datagram, the data is cut to len bytes. Multi byte fields
+ * are little endian.
+ */
+struct BridgeFrame
+{
+	unsigned char type;				/* BridgeFrameType */
+	unsigned char pipe;				/* Receiving pipe of RX frames */
+	unsigned char len;				/* Payload length */
+	unsigned char status;			/* BridgeStatus of TX_RESULT frames */
+	unsigned char retries;			/* ARC_CNT of the TX, or of the last TX for RX frames */
+	unsigned char lost;				/* PLOS_CNT at the same time */
+	unsigned char reserved[2];
+	unsigned int sequence;			/* Set by the backend in TX frames and echoed in the result, counts RX frames */
+	unsigned long long timestamp;	/* Transport clock in nanoseconds when read or sent */
+	unsigned char address[5];		/* Destination of TX frames */
+	unsigned char data[32];			/* Payload */
+} __attribute__((packed));
+
+#define		BRIDGE_HEADER_SIZE	offsetof(BridgeFrame, data)
+
+/**
+ * Bridge between the radio and a UDP or Unix datagram socket
+ *
+ * Received packets are read straight into a bounded uplink queue and sent
+ * to the backend with one sendmmsg per batch. TX frames from the backend
+ * are read with one recvmmsg per batch into a bounded downlink queue, sent
+ * one per service iteration and answered with a TX_RESULT frame. A full
+ * downlink queue leaves commands in the socket, which blocks a Unix socket
+ * sender and makes the kernel drop UDP. A full uplink queue drops received
+ * packets. Both are counted. A Unix datagram socket queues only
+ * net.unix.max_dgram_qlen datagrams, 10 by default, so raise it for bursts.
+ * Datagrams from any address but the backend are dropped.
+ *
+ * Packet rate without a radio can be measured with NullTransport, whose RX
+ * FIFO is never empty:
+ *
+ *     benchmarkSend([&] { bridge.service(0); }, 100000);
+ *
+ * gives service iterations per second, three packets each.
+ */
+class ORF24Bridge
+{
+private:
+	ORF24 &radio;					/* Radio to bridge */
+	int payloadSize;				/* Payload size in bytes */
+	int fd = -1;					/* Datagram socket */
+	struct sockaddr_storage peer;	/* Backend address */
+	socklen_t peerLength = 0;		/* Backend address length */
+	std::string localPath;			/* Bound Unix socket path, removed on close */
+	BridgeFrame uplink[BRIDGE_QUEUE_SIZE];	/* Frames waiting to be sent to the backend */
+	int upHead = 0;					/* Oldest uplink frame */
+	int upCount = 0;				/* Queued uplink frames */
+	BridgeFrame downlink[BRIDGE_QUEUE_SIZE];	/* TX frames waiting for the radio */
+	int downHead = 0;				/* Oldest downlink frame */
+	int downCount = 0;				/* Queued downlink frames */
+	unsigned int maxDelay = 1000;	/* Longest time a frame waits for a full batch in microseconds */
+	unsigned int rxSequence = 0;	/* Sequence of next RX frame */
+	unsigned char address[5];		/* Open writing pipe */
+	bool addressSet = false;		/* Whether a writing pipe is open */
+	unsigned long received = 0;		/* Packets read from the radio */
+	unsigned long forwarded = 0;	/* Frames sent to the backend */
+	unsigned long uplinkDropped = 0;	/* Frames dropped on a full uplink queue or send error */
+	unsigned long sendBlocked = 0;	/* sendmmsg calls that found the socket full */
+	unsigned long sendCalls = 0;	/* sendmmsg calls */
+	unsigned long commands = 0;		/* TX frames accepted */
+	unsigned long rejected = 0;		/* Malformed frames from the backend */
+	unsigned long foreign = 0;		/* Datagrams not sent by the backend */
+	unsigned long deferred = 0;		/* Iterations the socket was not read for a full downlink queue */
+	unsigned long recvCalls = 0;	/* recvmmsg calls */
+	unsigned long sent = 0;			/* TX frames acknowledged */
+	unsigned long failed = 0;		/* TX frames not acknowledged */
+
+protected:
+
+	/**
+	 * Finish opening a bound socket
+	 *
+	 * @param  socket 	bound socket
+	 * @return        	true on success
+	 */
+	bool start(int socket);
+
+	/**
+	 * Take a free uplink frame
+	 *
+	 * @return  frame, NULL if the queue is full
+	 */
+	BridgeFrame *reserveUplink(void);
+
+	/**
+	 * Check whether a datagram was sent by the backend
+	 *
+	 * @param  from   	sender address
+	 * @param  length 	sender address length
+	 * @return        	true if sent from the backend address
+	 */
+	bool isPeer(const struct sockaddr_storage &from, socklen_t length);
+
+	/**
+	 * Read TX frames from the socket into the downlink queue
+	 *
+	 * @return  number of frames read
+	 */
+	int pullDownlink(void);
+
+	/**
+	 * Read received packets into the uplink queue
+	 *
+	 * @return  number of packets read
+	 */
+	int receive(void);
+
+	/**
+	 * Send head of downlink queue and queue its result
+	 */
+	void transmit(void);
+
+	/**
+	 * Send uplink frames to the backend
+	 *
+	 * @param  force 	send even if no batch is full or due
+	 * @return       	number of frames sent
+	 */
+	int flush(bool force);
+
+public:
+
+	/**
+	 * ORF24Bridge Constructor
+	 *
+	 * @param _radio 		radio, already initialized with begin()
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24Bridge(ORF24 &_radio, int _payloadSize = 32);
+
+	~ORF24Bridge();
+
+	/**
+	 * Open a UDP socket and start listening
+	 *
+	 * The socket is bound to loopback unless another local address is
+	 * given, a backend on another host needs the address of an interface
+	 * it can reach.
+	 *
+	 * @param  localPort 	port to receive TX frames on
+	 * @param  remoteHost 	backend IPv4 address, numeric
+	 * @param  remotePort 	backend port
+	 * @param  localHost 	IPv4 address to bind, numeric
+	 * @return            	true on success
+	 */
+	bool openUDP(int localPort, const char *remoteHost, int remotePort, const char *localHost = "127.0.0.1");
+
+	/**
+	 * Open a Unix datagram socket and start listening
+	 *
+	 * @param  _localPath 	path to bind, replaced if it exists
+	 * @param  remotePath 	path the backend is bound to
+	 * @return            	true on success
+	 */
+	bool openUnix(const char *_localPath, const char *remotePath);
+
+	/**
+	 * Close socket
+	 */
+	void close(void);
+
+	/**
+	 * Set longest time a frame waits for a full batch
+	 *
+	 * @param us 	delay in microseconds
+	 */
+	void setMaxDelay(unsigned int us);
+
+	/**
+	 * Run one service iteration
+	 *
+	 * Reads TX frames, reads the RX FIFO, sends one TX frame and sends the
+	 * uplink queue when a batch is full or due. When there was nothing to
+	 * do the queue is sent and the socket polled for up to idleMs, keep it
+	 * short as the RX FIFO holds only three packets.
+	 *
+	 * @param  idleMs 	longest sleep when idle in milliseconds
+	 * @return        	number of frames read and packets sent or received
+	 */
+	int service(int idleMs);
+
+	/**
+	 * Get number of packets read from the radio
+	 *
+	 * @return  packets
+	 */
+	unsigned long getReceived(void);
+
+	/**
+	 * Get number of frames sent to the backend
+	 *
+	 * @return  frames
+	 */
+	unsigned long getForwarded(void);
+
+	/**
+	 * Get number of frames dropped on a full uplink queue or a send error
+	 *
+	 * @return  frames
+	 */
+	unsigned long getUplinkDropped(void);
+
+	/**
+	 * Get number of sends that found the socket buffer full
+	 *
+	 * @return  blocked sends
+	 */
+	unsigned long getSendBlocked(void);
+
+	/**
+	 * Get number of sendmmsg calls
+	 *
+	 * @return  system calls
+	 */
+	unsigned long getSendCalls(void);
+
+	/**
+	 * Get number of TX frames accepted from the backend
+	 *
+	 * @return  frames
+	 */
+	unsigned long getCommands(void);
+
+	/**
+	 * Get number of malformed frames from the backend
+	 *
+	 * @return  frames
+	 */
+	unsigned long getRejected(void);
+
+	/**
+	 * Get number of datagrams dropped because the backend did not send them
+	 *
+	 * @return  datagrams
+	 */
+	unsigned long getForeign(void);
+
+	/**
+	 * Get number of iterations the socket was left unread for a full
+	 * downlink queue
+	 *
+	 * @return  iterations
+	 */
+	unsigned long getDeferred(void);
+
+	/**
+	 * Get number of recvmmsg calls
+	 *
+	 * @return  system calls
+	 */
+	unsigned long getRecvCalls(void);
+
+	/**
+	 * Get number of TX frames acknowledged and not acknowledged
+	 *
+	 * @param _sent 	set to acknowledged frames
+	 * @param _failed 	set to frames not acknowledged
+	 */
+	void getStatistics(unsigned long *_sent, unsigned long *_failed);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,671 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24Bulk.h"
+
+/**
+ * Reverse an address for openReadingPipe
+ *
+ * openReadingPipe stores the address byte reversed while openWritingPipe
+ * does not, the reading side is given the reversed address so both ends
+ * put the same bytes on air.
+ *
+ * @param in  	address, 5 bytes
+ * @param out 	reversed address, 5 bytes
+ */
+static void reverseAddress(const char *in, char *out)
+{
+	for (int i = 0; i < 5; i++)
+	{
+		out[i] = in[4 - i];
+	}
+}
+
+/**
+ * Read bit from bitmap
+ *
+ * @param  bitmap 	bitmap
+ * @param  bit    	bit number
+ * @return        	bit value
+ */
+static bool testBit(const std::vector<unsigned char> &bitmap, int bit)
+{
+	return bitmap[bit >> 3] & (1 << (bit & 7));
+}
+
+ORF24BulkSender::ORF24BulkSender(ORF24 &_radio, const char *_broadcastAddress, const char *_replyAddress)
+	: radio(_radio),
+	  broadcastAddress(_broadcastAddress)
+{
+	reverseAddress(_replyAddress, replyAddress);
+}
+
+/**
+ * Set reply slot
+ *
+ * @param us 	slot per receiver in microseconds
+ */
+void ORF24BulkSender::setSlot(unsigned int us)
+{
+	slot = us;
+}
+
+/**
+ * Set when to give up on receivers that never report DONE
+ *
+ * @param _maxRounds 	rounds before giving up, 0 for no limit
+ * @param _deadline  	transfer time limit in milliseconds, 0 for none
+ */
+void ORF24BulkSender::setLimits(int _maxRounds, unsigned int _deadline)
+{
+	maxRounds = _maxRounds < 0 ? 0 : _maxRounds;
+	deadline = _deadline;
+}
+
+/**
+ * Start distributing an image
+ *
+ * @param  _image 		image
+ * @param  _size  		image size, at most 65535 blocks
+ * @param  _imageId 	identifier that differs from the previous image
+ * @param  _nodes 		number of receivers, with IDs 0 to _nodes - 1
+ * @return        		false if image is too large
+ */
+bool ORF24BulkSender::begin(const unsigned char *_image, unsigned long _size, unsigned char _imageId, int _nodes)
+{
+	unsigned long count = (_size + BULK_BLOCK_SIZE - 1) / BULK_BLOCK_SIZE;
+
+	if (count > 0xFFFF || _nodes < 1 || _nodes > 256)
+	{
+		return false;
+	}
+
+	image = _image;
+	size = _size;
+	blocks = count;
+	imageId = _imageId;
+	nodes = _nodes;
+	completed = 0;
+
+	pending.assign((blocks + 7) / 8, 0xFF);
+	nextRound.assign(pending.size(), 0);
+	done.assign(nodes, 0);
+
+	radio.setPayloadSize(32);
+	radio.stopListening();
+	radio.openWritingPipe(broadcastAddress);
+	radio.openReadingPipe(1, replyAddress);
+
+	/* Broadcasts are not acknowledged, replies on pipe 1 are */
+	radio.setAutoACK(0, false);
+
+	state = BULK_SENDING;
+	cursor = -1;
+	writing = false;
+	rounds = 1;
+	blocksSent = 0;
+	nacks = 0;
+	startedAt = radio.getTransport()->millis();
+	completionTime = 0;
+
+	return true;
+}
+
+/**
+ * Start broadcasting a packet
+ *
+ * @param payload 	32 byte payload
+ */
+void ORF24BulkSender::broadcast(unsigned char *payload)
+{
+	radio.startWrite(payload, 32);
+	writing = true;
+}
+
+/**
+ * Give up on receivers that did not report DONE
+ */
+void ORF24BulkSender::abort(void)
+{
+	radio.stopListening();
+
+	state = BULK_ABORTED;
+}
+
+/**
+ * Run the transfer
+ *
+ * @return  false once every receiver reported DONE or a limit was hit
+ */
+bool ORF24BulkSender::service(void)
+{
+	ORF24Transport *transport = radio.getTransport();
+	unsigned char payload[32];
+
+	if (state == BULK_IDLE || state == BULK_FINISHED || state == BULK_ABORTED)
+	{
+		return false;
+	}
+
+	if (writing)
+	{
+		bool delivered;
+
+		if (!radio.pollWrite(&delivered))
+		{
+			return true;
+		}
+
+		writing = false;
+	}
+
+	if (deadline && transport->millis() - startedAt >= deadline)
+	{
+		abort();
+		return false;
+	}
+
+	std::memset(payload, 0, sizeof(payload));
+	payload[1] = imageId;
+
+	if (state == BULK_SENDING)
+	{
+		/* Every round starts with INFO so late receivers learn the size */
+		if (cursor < 0)
+		{
+			payload[0] = BULK_INFO;
+			payload[2] = rounds;
+			payload[3] = 0;
+			payload[4] = blocks;
+			payload[5] = blocks >> 8;
+			payload[6] = size;
+			payload[7] = size >> 8;
+			payload[8] = size >> 16;
+			payload[9] = size >> 24;
+			payload[10] = slot;
+			payload[11] = slot >> 8;
+
+			broadcast(payload);
+			cursor = 0;
+
+			return true;
+		}
+
+		while (cursor < blocks && !testBit(pending, cursor))
+		{
+			cursor++;
+		}
+
+		if (cursor < blocks)
+		{
+			unsigned long offset = (unsigned long) cursor * BULK_BLOCK_SIZE;
+			unsigned long len = size - offset < BULK_BLOCK_SIZE ? size - offset : BULK_BLOCK_SIZE;
+
+			payload[0] = BULK_DATA;
+			payload[2] = cursor;
+			payload[3] = cursor >> 8;
+			std::memcpy(payload + 4, image + offset, len);
+
+			broadcast(payload);
+			blocksSent++;
+			cursor++;
+
+			return true;
+		}
+
+		state = BULK_POLLING;
+		polls = 0;
+	}
+
+	if (state == BULK_POLLING)
+	{
+		/* Sent twice, a receiver that misses both stays silent this round */
+		if (polls < 2)
+		{
+			payload[0] = BULK_INFO;
+			payload[2] = rounds;
+			payload[3] = 1;
+			payload[4] = blocks;
+			payload[5] = blocks >> 8;
+			payload[6] = size;
+			payload[7] = size >> 8;
+			payload[8] = size >> 16;
+			payload[9] = size >> 24;
+			payload[10] = slot;
+			payload[11] = slot >> 8;
+
+			broadcast(payload);
+			polls++;
+
+			return true;
+		}
+
+		radio.startListening();
+
+		windowStart = transport->micros();
+		windowLength = (nodes + 2) * slot;
+		state = BULK_COLLECTING;
+	}
+
+	while (radio.available())
+	{
+		radio.read(payload, 32);
+		handleReply(payload);
+	}
+
+	if (completed == nodes)
+	{
+		radio.stopListening();
+
+		completionTime = transport->millis() - startedAt;
+		state = BULK_FINISHED;
+
+		return false;
+	}
+
+	if (transport->micros() - windowStart < windowLength)
+	{
+		return true;
+	}
+
+	if (maxRounds && rounds >= maxRounds)
+	{
+		abort();
+		return false;
+	}
+
+	radio.stopListening();
+
+	pending.swap(nextRound);
+	std::fill(nextRound.begin(), nextRound.end(), 0);
+
+	state = BULK_SENDING;
+	cursor = -1;
+	rounds++;
+
+	return true;
+}
+
+/**
+ * Check whether the transfer stopped on a round or time limit
+ *
+ * @return  true if some receivers never reported DONE
+ */
+bool ORF24BulkSender::isAborted(void)
+{
+	return state == BULK_ABORTED;
+}
+
+/**
+ * Get receivers that have not reported DONE
+ *
+ * @param  list 	filled with receiver IDs
+ * @param  max  	list size
+ * @return      	number of incomplete receivers, may exceed max
+ */
+int ORF24BulkSender::getIncomplete(int *list, int max)
+{
+	int count = 0;
+
+	for (int node = 0; node < nodes; node++)
+	{
+		if (done[node])
+		{
+			continue;
+		}
+
+		if (count < max)
+		{
+			list[count] = node;
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * Handle a NACK or DONE packet
+ *
+ * @param payload 	received payload
+ */
+void ORF24BulkSender::handleReply(const unsigned char *payload)
+{
+	int node = payload[2];
+
+	if (payload[1] != imageId || node >= nodes)
+	{
+		return;
+	}
+
+	if (payload[0] == BULK_DONE)
+	{
+		if (!done[node])
+		{
+			done[node] = 1;
+			completed++;
+		}
+	}
+	else if (payload[0] == BULK_NACK)
+	{
+		int count = payload[3] < BULK_MAX_RANGES ? payload[3] : BULK_MAX_RANGES;
+
+		nacks++;
+
+		/* Union of all missing ranges is resent next round */
+		for (int i = 0; i < count; i++)
+		{
+			const unsigned char *range = payload + 4 + i * 4;
+			int first = range[0] | range[1] << 8;
+			int last = first + (range[2] | range[3] << 8);
+
+			for (int block = first; block < last && block < blocks; block++)
+			{
+				nextRound[block >> 3] |= 1 << (block & 7);
+			}
+		}
+	}
+}
+
+/**
+ * Get number of receivers that reported DONE
+ *
+ * @return  completed receivers
+ */
+int ORF24BulkSender::getCompleted(void)
+{
+	return completed;
+}
+
+/**
+ * Get time from begin until every receiver reported DONE
+ *
+ * @return  completion time in milliseconds
+ */
+unsigned int ORF24BulkSender::getCompletionTime(void)
+{
+	return completionTime;
+}
+
+/**
+ * Get number of rounds
+ *
+ * @return  rounds
+ */
+int ORF24BulkSender::getRounds(void)
+{
+	return rounds;
+}
+
+/**
+ * Get number of DATA packets sent, repairs included
+ *
+ * @return  blocks sent
+ */
+unsigned long ORF24BulkSender::getBlocksSent(void)
+{
+	return blocksSent;
+}
+
+/**
+ * Get number of NACK packets received
+ *
+ * @return  NACKs
+ */
+unsigned long ORF24BulkSender::getNacks(void)
+{
+	return nacks;
+}
+
+ORF24BulkReceiver::ORF24BulkReceiver(ORF24 &_radio, int _node, const char *_broadcastAddress, const char *_replyAddress,
+	unsigned char *_buffer, unsigned long _capacity)
+	: radio(_radio),
+	  node(_node),
+	  replyAddress(_replyAddress),
+	  buffer(_buffer),
+	  capacity(_capacity)
+{
+	reverseAddress(_broadcastAddress, broadcastAddress);
+	reverseAddress(_replyAddress, ackAddress);
+}
+
+/**
+ * Open the broadcast pipe and start listening
+ */
+void ORF24BulkReceiver::begin(void)
+{
+	radio.setPayloadSize(32);
+	radio.openReadingPipe(1, broadcastAddress);
+
+	/* Nobody may ACK a broadcast */
+	radio.setAutoACK(1, false);
+
+	radio.startListening();
+}
+
+/**
+ * Forget current image and start receiving another
+ *
+ * @param id 	image identifier
+ */
+void ORF24BulkReceiver::reset(unsigned char id)
+{
+	active = true;
+	imageId = id;
+	known = false;
+	size = 0;
+	blocks = 0;
+	received = 0;
+	bitmap.clear();
+	lastRound = -1;
+	replyPending = false;
+	doneSent = false;
+}
+
+/**
+ * Process received packets and send due replies
+ */
+void ORF24BulkReceiver::service(void)
+{
+	ORF24Transport *transport = radio.getTransport();
+	unsigned char payload[32];
+
+	while (radio.available())
+	{
+		radio.read(payload, 32);
+
+		if (payload[0] != BULK_DATA && payload[0] != BULK_INFO)
+		{
+			continue;
+		}
+
+		if (!active || payload[1] != imageId)
+		{
+			reset(payload[1]);
+		}
+
+		if (payload[0] == BULK_DATA)
+		{
+			int block = payload[2] | payload[3] << 8;
+			unsigned long offset = (unsigned long) block * BULK_BLOCK_SIZE;
+
+			if (offset >= capacity)
+			{
+				continue;
+			}
+
+			/* Blocks may arrive before INFO */
+			if (bitmap.size() <= (size_t) (block >> 3))
+			{
+				bitmap.resize((block >> 3) + 1, 0);
+			}
+
+			if (!testBit(bitmap, block))
+			{
+				unsigned long len = capacity - offset < BULK_BLOCK_SIZE ? capacity - offset : BULK_BLOCK_SIZE;
+
+				std::memcpy(buffer + offset, payload + 4, len);
+				bitmap[block >> 3] |= 1 << (block & 7);
+				received++;
+			}
+		}
+		else
+		{
+			int round = payload[2];
+			unsigned int slot = payload[10] | payload[11] << 8;
+
+			if (!known)
+			{
+				blocks = payload[4] | payload[5] << 8;
+				size = payload[6] | payload[7] << 8 | payload[8] << 16 | (unsigned long) payload[9] << 24;
+				known = true;
+
+				if (bitmap.size() < (size_t) (blocks + 7) / 8)
+				{
+					bitmap.resize((blocks + 7) / 8, 0);
+				}
+			}
+
+			/* One reply per round in this receiver's slot */
+			if (payload[3] && round != lastRound)
+			{
+				lastRound = round;
+				replyPending = !(isComplete() && doneSent);
+				/* Slot 0 is left for the second INFO */
+				replyAt = transport->micros() + (node + 1) * slot;
+			}
+		}
+	}
+
+	if (replyPending && (int) (transport->micros() - replyAt) >= 0)
+	{
+		reply();
+	}
+}
+
+/**
+ * Send NACK or DONE and return to RX
+ */
+void ORF24BulkReceiver::reply(void)
+{
+	unsigned char payload[32];
+	bool complete = isComplete();
+	bool delivered;
+
+	replyPending = false;
+
+	if (size > capacity)
+	{
+		return;
+	}
+
+	std::memset(payload, 0, sizeof(payload));
+	payload[0] = complete ? BULK_DONE : BULK_NACK;
+	payload[1] = imageId;
+	payload[2] = node;
+
+	if (!complete)
+	{
+		int count = 0;
+		int block = 0;
+
+		while (block < blocks && count < BULK_MAX_RANGES)
+		{
+			if (testBit(bitmap, block))
+			{
+				block++;
+				continue;
+			}
+
+			int first = block;
+
+			while (block < blocks && !testBit(bitmap, block))
+			{
+				block++;
+			}
+
+			unsigned char *range = payload + 4 + count * 4;
+			int len = block - first;
+
+			range[0] = first;
+			range[1] = first >> 8;
+			range[2] = len;
+			range[3] = len >> 8;
+			count++;
+		}
+
+		payload[3] = count;
+	}
+
+	radio.stopListening();
+	radio.openWritingPipe(replyAddress);
+
+	/* Pipe 0 receives the ACK, it only stays open during the write */
+	radio.openReadingPipe(0, ackAddress);
+	radio.startWrite(payload, 32);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	/* Otherwise NACKs of other receivers to the sender land here */
+	radio.closeReadingPipe(0);
+	radio.startListening();
+
+	if (complete && delivered)
+	{
+		doneSent = true;
+	}
+}
+
+/**
+ * Check whether the whole image was received
+ *
+ * @return  true if complete
+ */
+bool ORF24BulkReceiver::isComplete(void)
+{
+	return known && received >= blocks;
+}
+
+/**
+ * Get image size
+ *
+ * @return  size in bytes, 0 before the first INFO
+ */
+unsigned long ORF24BulkReceiver::getSize(void)
+{
+	return size;
+}
+
+/**
+ * Get number of blocks received
+ *
+ * @return  received blocks
+ */
+int ORF24BulkReceiver::getReceived(void)
+{
+	return received;
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_BULK_H_
+#define _ORF_24_BULK_H_
+
+#include <vector>
+#include "ORF24.h"
+
+#define		BULK_DATA			0x01
+#define		BULK_INFO			0x02
+#define		BULK_NACK			0x03
+#define		BULK_DONE			0x04
+#define		BULK_BLOCK_SIZE		28
+#define		BULK_MAX_RANGES		7
+
+/**
+ * One-to-many bulk transfer with NACK repair
+ *
+ * The sender broadcasts numbered blocks without ACK on a shared address,
+ * then an INFO packet that opens a reply window. Every receiver missing
+ * blocks answers in its own slot with up to 7 missing block ranges, and
+ * a complete receiver answers once with DONE. The next round resends only
+ * the union of the reported ranges. Payloads are 32 bytes:
+ *
+ *     DATA | 0x01 | image | block (2) | data (28) |
+ *     INFO | 0x02 | image | round | poll | blocks (2) | size (4) | slot (2) |
+ *     NACK | 0x03 | image | node | count | first (2) | count (2) | ... |
+ *     DONE | 0x04 | image | node |
+ *
+ * Multibyte fields are little endian. Both sides are driven by calling
+ * service() in a loop.
+ */
+class ORF24BulkSender
+{
+private:
+	enum State {BULK_IDLE = 0, BULK_SENDING, BULK_POLLING, BULK_COLLECTING, BULK_FINISHED, BULK_ABORTED};
+
+	ORF24 &radio;					/* Radio to send with */
+	const char *broadcastAddress;	/* Address receivers listen on */
+	char replyAddress[5];			/* Address NACKs arrive on */
+	const unsigned char *image;		/* Image to distribute */
+	unsigned long size = 0;			/* Image size in bytes */
+	int blocks = 0;					/* Blocks in image */
+	unsigned char imageId = 0;		/* Image identifier */
+	int nodes = 0;					/* Receivers expected */
+	int completed = 0;				/* Receivers that sent DONE */
+	std::vector<unsigned char> pending;	/* Blocks to send this round */
+	std::vector<unsigned char> nextRound;	/* Blocks reported missing */
+	std::vector<unsigned char> done;	/* Receivers that sent DONE */
+	State state = BULK_IDLE;		/* Current state */
+	int cursor = 0;					/* Next block to consider, -1 to announce */
+	int polls = 0;					/* INFO packets sent this round */
+	bool writing = false;			/* Whether a write is in flight */
+	unsigned int slot = 2000;		/* Reply slot in microseconds */
+	unsigned int windowStart = 0;	/* Start of reply window */
+	unsigned int windowLength = 0;	/* Reply window in microseconds */
+	int maxRounds = 32;				/* Rounds before giving up, 0 for no limit */
+	unsigned int deadline = 0;		/* Transfer time limit in milliseconds, 0 for none */
+	unsigned int startedAt = 0;		/* Start time in milliseconds */
+	unsigned int completionTime = 0;	/* Transfer time in milliseconds */
+	int rounds = 0;					/* Rounds started */
+	unsigned long blocksSent = 0;	/* DATA packets sent */
+	unsigned long nacks = 0;		/* NACK packets received */
+
+	/**
+	 * Start broadcasting a packet
+	 *
+	 * @param payload 	32 byte payload
+	 */
+	void broadcast(unsigned char *payload);
+
+	/**
+	 * Handle a NACK or DONE packet
+	 *
+	 * @param payload 	received payload
+	 */
+	void handleReply(const unsigned char *payload);
+
+	/**
+	 * Give up on receivers that did not report DONE
+	 */
+	void abort(void);
+
+public:
+
+	/**
+	 * ORF24BulkSender Constructor
+	 *
+	 * @param _radio 				radio to send with
+	 * @param _broadcastAddress 	address receivers listen on, 5 bytes
+	 * @param _replyAddress 		address NACKs are sent to, 5 bytes
+	 */
+	ORF24BulkSender(ORF24 &_radio, const char *_broadcastAddress, const char *_replyAddress);
+
+	/**
+	 * Set reply slot
+	 *
+	 * @param us 	slot per receiver in microseconds
+	 */
+	void setSlot(unsigned int us);
+
+	/**
+	 * Set when to give up on receivers that never report DONE
+	 *
+	 * @param _maxRounds 	rounds before giving up, 0 for no limit
+	 * @param _deadline  	transfer time limit in milliseconds, 0 for none
+	 */
+	void setLimits(int _maxRounds, unsigned int _deadline);
+
+	/**
+	 * Start distributing an image
+	 *
+	 * The image is not copied and must stay valid until finished.
+	 *
+	 * @param  _image 		image
+	 * @param  _size  		image size, at most 65535 blocks
+	 * @param  _imageId 	identifier that differs from the previous image
+	 * @param  _nodes 		number of receivers, with IDs 0 to _nodes - 1
+	 * @return        		false if image is too large
+	 */
+	bool begin(const unsigned char *_image, unsigned long _size, unsigned char _imageId, int _nodes);
+
+	/**
+	 * Run the transfer
+	 *
+	 * @return  false once every receiver reported DONE or a limit was hit
+	 */
+	bool service(void);
+
+	/**
+	 * Check whether the transfer stopped on a round or time limit
+	 *
+	 * @return  true if some receivers never reported DONE
+	 */
+	bool isAborted(void);
+
+	/**
+	 * Get receivers that have not reported DONE
+	 *
+	 * @param  list 	filled with receiver IDs
+	 * @param  max  	list size
+	 * @return      	number of incomplete receivers, may exceed max
+	 */
+	int getIncomplete(int *list, int max);
+
+	/**
+	 * Get number of receivers that reported DONE
+	 *
+	 * @return  completed receivers
+	 */
+	int getCompleted(void);
+
+	/**
+	 * Get time from begin until every receiver reported DONE
+	 *
+	 * @return  completion time in milliseconds
+	 */
+	unsigned int getCompletionTime(void);
+
+	/**
+	 * Get number of rounds
+	 *
+	 * @return  rounds
+	 */
+	int getRounds(void);
+
+	/**
+	 * Get number of DATA packets sent, repairs included
+	 *
+	 * @return  blocks sent
+	 */
+	unsigned long getBlocksSent(void);
+
+	/**
+	 * Get number of NACK packets received
+	 *
+	 * @return  NACKs
+	 */
+	unsigned long getNacks(void);
+};
+
+/**
+ * Receiver side of ORF24BulkSender
+ */
+class ORF24BulkReceiver
+{
+private:
+	ORF24 &radio;					/* Radio to receive with */
+	int node;						/* Receiver ID */
+	char broadcastAddress[5];		/* Address blocks arrive on */
+	const char *replyAddress;		/* Address NACKs are sent to */
+	char ackAddress[5];				/* Reply address as pipe 0 reading address */
+	unsigned char *buffer;			/* Image buffer */
+	unsigned long capacity;			/* Image buffer size */
+	unsigned char imageId = 0;		/* Image being received */
+	bool active = false;			/* Whether an image is being received */
+	bool known = false;				/* Whether INFO was received */
+	unsigned long size = 0;			/* Image size in bytes */
+	int blocks = 0;					/* Blocks in image */
+	int received = 0;				/* Blocks received */
+	std::vector<unsigned char> bitmap;	/* Received blocks */
+	int lastRound = -1;				/* Last round replied to */
+	bool replyPending = false;		/* Whether a reply is due */
+	unsigned int replyAt = 0;		/* Time the reply slot starts */
+	bool doneSent = false;			/* Whether DONE was acknowledged */
+
+	/**
+	 * Forget current image and start receiving another
+	 *
+	 * @param id 	image identifier
+	 */
+	void reset(unsigned char id);
+
+	/**
+	 * Send NACK or DONE and return to RX
+	 */
+	void reply(void);
+
+public:
+
+	/**
+	 * ORF24BulkReceiver Constructor
+	 *
+	 * @param _radio 				radio to receive with
+	 * @param _node 				receiver ID, 0 to number of receivers - 1
+	 * @param _broadcastAddress 	address blocks arrive on, 5 bytes
+	 * @param _replyAddress 		address NACKs are sent to, 5 bytes
+	 * @param _buffer 				image buffer
+	 * @param _capacity 			image buffer size
+	 */
+	ORF24BulkReceiver(ORF24 &_radio, int _node, const char *_broadcastAddress, const char *_replyAddress,
+		unsigned char *_buffer, unsigned long _capacity);
+
+	/**
+	 * Open the broadcast pipe and start listening
+	 */
+	void begin(void);
+
+	/**
+	 * Process received packets and send due replies
+	 */
+	void service(void);
+
+	/**
+	 * Check whether the whole image was received
+	 *
+	 * @return  true if complete
+	 */
+	bool isComplete(void);
+
+	/**
+	 * Get image size
+	 *
+	 * @return  size in bytes, 0 before the first INFO
+	 */
+	unsigned long getSize(void);
+
+	/**
+	 * Get number of blocks received
+	 *
+	 * @return  received blocks
+	 */
+	int getReceived(void);
+};
+
+#endif
\ No newline at end of file
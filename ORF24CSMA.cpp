@@ -0,0 +1,182 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "ORF24CSMA.h"
+
+ORF24CSMA::ORF24CSMA(ORF24 &_radio)
+	: radio(_radio)
+{
+	/* Nodes started together still get different sequences */
+	seed = radio.getTransport()->micros() | 1;
+}
+
+/**
+ * Set backoff parameters
+ *
+ * @param  _slot        	slot in microseconds, about one packet air time
+ * @param  _minExponent 	initial window is 2^_minExponent slots, 0 to 16
+ * @param  _maxExponent 	largest window is 2^_maxExponent slots, up to 16
+ * @param  _maxAttempts 	carrier samples before giving up
+ */
+void ORF24CSMA::setBackoff(unsigned int _slot, int _minExponent, int _maxExponent, int _maxAttempts)
+{
+	/* Windows of 2^0 to 2^16 slots keep 1u << exponent defined */
+	const int largest = 16;
+
+	slot = _slot;
+	minExponent = _minExponent < 0 ? 0 : (_minExponent > largest ? largest : _minExponent);
+	maxExponent = _maxExponent < minExponent ? minExponent : (_maxExponent > largest ? largest : _maxExponent);
+	maxAttempts = _maxAttempts < 1 ? 1 : _maxAttempts;
+}
+
+/**
+ * Next backoff random number
+ *
+ * @return  random number
+ */
+unsigned int ORF24CSMA::random(void)
+{
+	/* xorshift32 */
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	return seed;
+}
+
+/**
+ * Wait for a free channel and write payload
+ *
+ * @param  data 	data to write
+ * @param  len  	data length
+ * @return      	false if channel stayed busy or payload was not acknowledged
+ */
+bool ORF24CSMA::write(unsigned char *data, int len)
+{
+	ORF24Transport *transport = radio.getTransport();
+	int exponent = minExponent;
+
+	for (int attempt = 0; attempt < maxAttempts; attempt++)
+	{
+		samples++;
+
+		if (!radio.testCarrier())
+		{
+			bool delivered;
+
+			/* write() powers down afterwards, a PWR_UP before the next
+			 * carrier sample would cost 1.5 ms. Stay in Standby-I. */
+			radio.startWrite(data, len);
+
+			while (!radio.pollWrite(&delivered))
+				;
+
+			packets++;
+
+			if (!delivered)
+			{
+				failedPackets++;
+			}
+
+			return delivered;
+		}
+
+		busySamples++;
+
+		/* No point waiting after the last sample */
+		if (attempt == maxAttempts - 1)
+		{
+			break;
+		}
+
+		/* Random slot count in [1, 2^exponent] */
+		unsigned int wait = (random() % (1u << exponent) + 1) * slot;
+
+		transport->delayMicroseconds(wait);
+
+		backoffs++;
+		backoffTime += wait;
+
+		if (exponent < maxExponent)
+		{
+			exponent++;
+		}
+	}
+
+	accessFailures++;
+
+	return false;
+}
+
+/**
+ * Get fraction of carrier samples that found the channel busy
+ *
+ * @return  busy ratio
+ */
+double ORF24CSMA::getBusyRatio(void)
+{
+	return samples ? (double) busySamples / samples : 0;
+}
+
+/**
+ * Get number of backoff waits
+ *
+ * @return  backoffs
+ */
+unsigned long ORF24CSMA::getBackoffs(void)
+{
+	return backoffs;
+}
+
+/**
+ * Get mean backoff time per packet
+ *
+ * @return  backoff time in microseconds
+ */
+double ORF24CSMA::getMeanBackoffTime(void)
+{
+	unsigned long attempted = packets + accessFailures;
+
+	return attempted ? (double) backoffTime / attempted : 0;
+}
+
+/**
+ * Get number of packets dropped because the channel stayed busy
+ *
+ * @return  access failures
+ */
+unsigned long ORF24CSMA::getAccessFailures(void)
+{
+	return accessFailures;
+}
+
+/**
+ * Get number of packets not acknowledged
+ *
+ * @return  failed packets
+ */
+unsigned long ORF24CSMA::getFailedPackets(void)
+{
+	return failedPackets;
+}
\ No newline at end of file
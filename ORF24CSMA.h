@@ -0,0 +1,127 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_CSMA_H_
+#define _ORF_24_CSMA_H_
+
+#include "ORF24.h"
+
+/**
+ * Listen before talk
+ *
+ * Samples carrier detect before every write. While the channel is busy it
+ * waits a random number of slots drawn from a window that doubles with
+ * every busy sample, up to a limit, so nodes that found the channel busy
+ * at the same moment do not retry in lockstep. The radio is left in
+ * Standby-I after a write so the next carrier sample needs no power up.
+ */
+class ORF24CSMA
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	unsigned int slot = 500;		/* Backoff slot in microseconds */
+	int minExponent = 1;			/* Initial backoff window exponent */
+	int maxExponent = 6;			/* Largest backoff window exponent */
+	int maxAttempts = 8;			/* Carrier samples before giving up */
+	unsigned int seed;				/* Backoff random state */
+	unsigned long samples = 0;		/* Carrier samples taken */
+	unsigned long busySamples = 0;	/* Samples that found the channel busy */
+	unsigned long backoffs = 0;		/* Backoff waits */
+	unsigned long long backoffTime = 0;	/* Total backoff time in microseconds */
+	unsigned long packets = 0;		/* Packets sent */
+	unsigned long failedPackets = 0;	/* Packets not acknowledged */
+	unsigned long accessFailures = 0;	/* Packets dropped on a busy channel */
+
+	/**
+	 * Next backoff random number
+	 *
+	 * @return  random number
+	 */
+	unsigned int random(void);
+
+public:
+
+	/**
+	 * ORF24CSMA Constructor
+	 *
+	 * @param _radio 	radio to send with
+	 */
+	ORF24CSMA(ORF24 &_radio);
+
+	/**
+	 * Set backoff parameters
+	 *
+	 * @param  _slot        	slot in microseconds, about one packet air time
+	 * @param  _minExponent 	initial window is 2^_minExponent slots, 0 to 16
+	 * @param  _maxExponent 	largest window is 2^_maxExponent slots, up to 16
+	 * @param  _maxAttempts 	carrier samples before giving up
+	 */
+	void setBackoff(unsigned int _slot, int _minExponent, int _maxExponent, int _maxAttempts);
+
+	/**
+	 * Wait for a free channel and write payload
+	 *
+	 * @param  data 	data to write
+	 * @param  len  	data length
+	 * @return      	false if channel stayed busy or payload was not acknowledged
+	 */
+	bool write(unsigned char *data, int len);
+
+	/**
+	 * Get fraction of carrier samples that found the channel busy
+	 *
+	 * @return  busy ratio
+	 */
+	double getBusyRatio(void);
+
+	/**
+	 * Get number of backoff waits
+	 *
+	 * @return  backoffs
+	 */
+	unsigned long getBackoffs(void);
+
+	/**
+	 * Get mean backoff time per packet
+	 *
+	 * @return  backoff time in microseconds
+	 */
+	double getMeanBackoffTime(void);
+
+	/**
+	 * Get number of packets dropped because the channel stayed busy
+	 *
+	 * @return  access failures
+	 */
+	unsigned long getAccessFailures(void);
+
+	/**
+	 * Get number of packets not acknowledged
+	 *
+	 * @return  failed packets
+	 */
+	unsigned long getFailedPackets(void);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,191 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24Coalescer.h"
+
+ORF24Coalescer::ORF24Coalescer(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize < 2 ? 2 : _payloadSize)
+{ }
+
+/**
+ * Set how long a message may wait for more to share its payload
+ *
+ * @param us 	deadline in microseconds
+ */
+void ORF24Coalescer::setDeadline(unsigned int us)
+{
+	deadline = us;
+}
+
+/**
+ * Queue a message
+ *
+ * @param  data 	message
+ * @param  len  	message length, at most payload size - 1
+ * @return      	false if message is too long or a flush failed
+ */
+bool ORF24Coalescer::send(const unsigned char *data, int len)
+{
+	if (len <= 0 || len > payloadSize - 1)
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	if (used + 1 + len > payloadSize)
+	{
+		result = flush();
+	}
+
+	if (queued == 0)
+	{
+		queuedAt = radio.getTransport()->micros();
+	}
+
+	payload[used++] = len;
+	std::memcpy(payload + used, data, len);
+	used += len;
+	queued++;
+
+	/* No room left for another message */
+	if (used + 1 >= payloadSize)
+	{
+		return flush() && result;
+	}
+
+	return poll() && result;
+}
+
+/**
+ * Send queued messages if the deadline passed
+ *
+ * @return  false if a flush failed
+ */
+bool ORF24Coalescer::poll(void)
+{
+	if (queued > 0 && radio.getTransport()->micros() - queuedAt >= deadline)
+	{
+		return flush();
+	}
+
+	return true;
+}
+
+/**
+ * Send queued messages now
+ *
+ * @return  false if the payload was not acknowledged
+ */
+bool ORF24Coalescer::flush(void)
+{
+	if (queued == 0)
+	{
+		return true;
+	}
+
+	std::memset(payload + used, 0, payloadSize - used);
+
+	bool result = radio.write(payload, payloadSize);
+
+	messages += queued;
+	packets++;
+
+	if (!result)
+	{
+		failedPackets++;
+	}
+
+	used = 0;
+	queued = 0;
+
+	return result;
+}
+
+/**
+ * Get number of queued messages
+ *
+ * @return  queued messages
+ */
+int ORF24Coalescer::getQueued(void)
+{
+	return queued;
+}
+
+/**
+ * Get mean number of messages per packet sent
+ *
+ * @return  messages per packet
+ */
+double ORF24Coalescer::getMessagesPerPacket(void)
+{
+	return packets ? (double) messages / packets : 0;
+}
+
+/**
+ * Get number of packets not acknowledged
+ *
+ * @return  failed packets
+ */
+unsigned long ORF24Coalescer::getFailedPackets(void)
+{
+	return failedPackets;
+}
+
+ORF24CoalescedReader::ORF24CoalescedReader(const unsigned char *_payload, int _length)
+	: payload(_payload),
+	  length(_length)
+{ }
+
+/**
+ * Get next message
+ *
+ * @param  data 	set to message start
+ * @param  len  	set to message length
+ * @return      	false if there are no more messages
+ */
+bool ORF24CoalescedReader::next(const unsigned char **data, int *len)
+{
+	if (offset >= length || payload[offset] == 0)
+	{
+		return false;
+	}
+
+	int size = payload[offset];
+
+	/* Truncated message, stop reading */
+	if (offset + 1 + size > length)
+	{
+		offset = length;
+		return false;
+	}
+
+	*data = payload + offset + 1;
+	*len = size;
+	offset += 1 + size;
+
+	return true;
+}
\ No newline at end of file
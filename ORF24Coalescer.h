@@ -0,0 +1,149 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_COALESCER_H_
+#define _ORF_24_COALESCER_H_
+
+#include "ORF24.h"
+
+/**
+ * Small message aggregation
+ *
+ * Packs several application messages into one payload. Each message is
+ * prefixed with its length in one byte and a zero length ends the payload:
+ *
+ *     | len | message | len | message | ... | 0 | padding |
+ *
+ * The payload is sent when the next message does not fit, when the oldest
+ * queued message reaches the deadline, or on flush().
+ */
+class ORF24Coalescer
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	int payloadSize;				/* Payload size in bytes */
+	unsigned char payload[32];		/* Payload being filled */
+	int used = 0;					/* Bytes used in payload */
+	int queued = 0;					/* Messages in payload */
+	unsigned int deadline = 5000;	/* Longest wait in microseconds */
+	unsigned int queuedAt = 0;		/* Time of oldest queued message */
+	unsigned long messages = 0;		/* Messages sent */
+	unsigned long packets = 0;		/* Packets sent */
+	unsigned long failedPackets = 0;	/* Packets not acknowledged */
+
+public:
+
+	/**
+	 * ORF24Coalescer Constructor
+	 *
+	 * @param _radio 		radio to send with
+	 * @param _payloadSize 	payload size in bytes, clamped to 2 to 32
+	 */
+	ORF24Coalescer(ORF24 &_radio, int _payloadSize = 32);
+
+	/**
+	 * Set how long a message may wait for more to share its payload
+	 *
+	 * @param us 	deadline in microseconds
+	 */
+	void setDeadline(unsigned int us);
+
+	/**
+	 * Queue a message
+	 *
+	 * @param  data 	message
+	 * @param  len  	message length, at most payload size - 1
+	 * @return      	false if message is too long or a flush failed
+	 */
+	bool send(const unsigned char *data, int len);
+
+	/**
+	 * Send queued messages if the deadline passed
+	 *
+	 * @return  false if a flush failed
+	 */
+	bool poll(void);
+
+	/**
+	 * Send queued messages now
+	 *
+	 * @return  false if the payload was not acknowledged
+	 */
+	bool flush(void);
+
+	/**
+	 * Get number of queued messages
+	 *
+	 * @return  queued messages
+	 */
+	int getQueued(void);
+
+	/**
+	 * Get mean number of messages per packet sent
+	 *
+	 * @return  messages per packet
+	 */
+	double getMessagesPerPacket(void);
+
+	/**
+	 * Get number of packets not acknowledged
+	 *
+	 * @return  failed packets
+	 */
+	unsigned long getFailedPackets(void);
+};
+
+/**
+ * Reader over a received aggregated payload
+ *
+ * Messages are returned as pointers into the payload, nothing is copied.
+ */
+class ORF24CoalescedReader
+{
+private:
+	const unsigned char *payload;	/* Received payload */
+	int length;						/* Payload length */
+	int offset = 0;					/* Offset of next message */
+
+public:
+
+	/**
+	 * ORF24CoalescedReader Constructor
+	 *
+	 * @param _payload 	received payload
+	 * @param _length 	payload length
+	 */
+	ORF24CoalescedReader(const unsigned char *_payload, int _length);
+
+	/**
+	 * Get next message
+	 *
+	 * @param  data 	set to message start
+	 * @param  len  	set to message length
+	 * @return      	false if there are no more messages
+	 */
+	bool next(const unsigned char **data, int *len);
+};
+
+#endif
\ No newline at end of file
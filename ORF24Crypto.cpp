@@ -0,0 +1,626 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24Crypto.h"
+
+/* Define CRYPTO_SCALAR to build the portable ChaCha20 everywhere */
+#if !defined(CRYPTO_SCALAR) && defined(__GNUC__) && !defined(__clang__) && (defined(__ARM_NEON) || defined(__SSE2__)) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define		CRYPTO_VECTOR
+typedef uint32_t vec4 __attribute__((vector_size(16)));
+#endif
+
+/**
+ * Load little endian word
+ *
+ * @param  p 	4 bytes
+ * @return   	word
+ */
+static inline uint32_t load32(const unsigned char *p)
+{
+	return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/**
+ * Store little endian word
+ *
+ * @param p     	4 bytes
+ * @param value 	word
+ */
+static inline void store32(unsigned char *p, uint32_t value)
+{
+	p[0] = value;
+	p[1] = value >> 8;
+	p[2] = value >> 16;
+	p[3] = value >> 24;
+}
+
+#ifdef CRYPTO_VECTOR
+
+/**
+ * Rotate each lane left
+ *
+ * @param  v 	vector
+ * @param  n 	bits
+ * @return   	rotated vector
+ */
+static inline vec4 rotate(vec4 v, int n)
+{
+	return (v << n) | (v >> (32 - n));
+}
+
+/**
+ * ChaCha20 block, one state row per vector
+ *
+ * @param in  	input state
+ * @param out 	64 bytes of keystream
+ */
+static void chachaBlock(const uint32_t *in, unsigned char *out)
+{
+	vec4 a, b, c, d;
+
+	std::memcpy(&a, in, 16);
+	std::memcpy(&b, in + 4, 16);
+	std::memcpy(&c, in + 8, 16);
+	std::memcpy(&d, in + 12, 16);
+
+	vec4 a0 = a, b0 = b, c0 = c, d0 = d;
+	const vec4 left = {1, 2, 3, 0}, half = {2, 3, 0, 1}, right = {3, 0, 1, 2};
+
+	for (int i = 0; i < 10; i++)
+	{
+		/* Column round */
+		a += b; d ^= a; d = rotate(d, 16);
+		c += d; b ^= c; b = rotate(b, 12);
+		a += b; d ^= a; d = rotate(d, 8);
+		c += d; b ^= c; b = rotate(b, 7);
+
+		/* Rotate rows so diagonals line up as columns */
+		b = __builtin_shuffle(b, left);
+		c = __builtin_shuffle(c, half);
+		d = __builtin_shuffle(d, right);
+
+		/* Diagonal round */
+		a += b; d ^= a; d = rotate(d, 16);
+		c += d; b ^= c; b = rotate(b, 12);
+		a += b; d ^= a; d = rotate(d, 8);
+		c += d; b ^= c; b = rotate(b, 7);
+
+		b = __builtin_shuffle(b, right);
+		c = __builtin_shuffle(c, half);
+		d = __builtin_shuffle(d, left);
+	}
+
+	a += a0;
+	b += b0;
+	c += c0;
+	d += d0;
+
+	std::memcpy(out, &a, 16);
+	std::memcpy(out + 16, &b, 16);
+	std::memcpy(out + 32, &c, 16);
+	std::memcpy(out + 48, &d, 16);
+}
+
+#else
+
+#define		ROTATE(v, n)	(((v) << (n)) | ((v) >> (32 - (n))))
+#define		QUARTER(a, b, c, d) \
+	a += b; d ^= a; d = ROTATE(d, 16); \
+	c += d; b ^= c; b = ROTATE(b, 12); \
+	a += b; d ^= a; d = ROTATE(d, 8); \
+	c += d; b ^= c; b = ROTATE(b, 7)
+
+/**
+ * ChaCha20 block
+ *
+ * @param in  	input state
+ * @param out 	64 bytes of keystream
+ */
+static void chachaBlock(const uint32_t *in, unsigned char *out)
+{
+	uint32_t x[16];
+
+	std::memcpy(x, in, sizeof(x));
+
+	for (int i = 0; i < 10; i++)
+	{
+		QUARTER(x[0], x[4], x[8], x[12]);
+		QUARTER(x[1], x[5], x[9], x[13]);
+		QUARTER(x[2], x[6], x[10], x[14]);
+		QUARTER(x[3], x[7], x[11], x[15]);
+		QUARTER(x[0], x[5], x[10], x[15]);
+		QUARTER(x[1], x[6], x[11], x[12]);
+		QUARTER(x[2], x[7], x[8], x[13]);
+		QUARTER(x[3], x[4], x[9], x[14]);
+	}
+
+	for (int i = 0; i < 16; i++)
+	{
+		store32(out + 4 * i, x[i] + in[i]);
+	}
+}
+
+#endif
+
+/**
+ * Poly1305 with 26 bit limbs
+ */
+struct Poly1305
+{
+	uint32_t r[5];
+	uint32_t h[5];
+	uint32_t pad[4];
+
+	/**
+	 * Set one-time key
+	 *
+	 * @param key 	32 byte key
+	 */
+	void init(const unsigned char *key)
+	{
+		r[0] = load32(key) & 0x3FFFFFF;
+		r[1] = (load32(key + 3) >> 2) & 0x3FFFF03;
+		r[2] = (load32(key + 6) >> 4) & 0x3FFC0FF;
+		r[3] = (load32(key + 9) >> 6) & 0x3F03FFF;
+		r[4] = (load32(key + 12) >> 8) & 0x00FFFFF;
+
+		for (int i = 0; i < 5; i++)
+		{
+			h[i] = 0;
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			pad[i] = load32(key + 16 + 4 * i);
+		}
+	}
+
+	/**
+	 * Absorb data, zero padded to a multiple of 16 bytes
+	 *
+	 * @param m   	data
+	 * @param len 	data length
+	 */
+	void update(const unsigned char *m, int len)
+	{
+		const uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+		unsigned char block[16];
+
+		while (len > 0)
+		{
+			if (len < 16)
+			{
+				std::memset(block, 0, sizeof(block));
+				std::memcpy(block, m, len);
+				m = block;
+			}
+
+			h[0] += load32(m) & 0x3FFFFFF;
+			h[1] += (load32(m + 3) >> 2) & 0x3FFFFFF;
+			h[2] += (load32(m + 6) >> 4) & 0x3FFFFFF;
+			h[3] += (load32(m + 9) >> 6) & 0x3FFFFFF;
+			h[4] += (load32(m + 12) >> 8) | (1 << 24);
+
+			uint64_t d0 = (uint64_t) h[0] * r[0] + (uint64_t) h[1] * s4 + (uint64_t) h[2] * s3 + (uint64_t) h[3] * s2 + (uint64_t) h[4] * s1;
+			uint64_t d1 = (uint64_t) h[0] * r[1] + (uint64_t) h[1] * r[0] + (uint64_t) h[2] * s4 + (uint64_t) h[3] * s3 + (uint64_t) h[4] * s2;
+			uint64_t d2 = (uint64_t) h[0] * r[2] + (uint64_t) h[1] * r[1] + (uint64_t) h[2] * r[0] + (uint64_t) h[3] * s4 + (uint64_t) h[4] * s3;
+			uint64_t d3 = (uint64_t) h[0] * r[3] + (uint64_t) h[1] * r[2] + (uint64_t) h[2] * r[1] + (uint64_t) h[3] * r[0] + (uint64_t) h[4] * s4;
+			uint64_t d4 = (uint64_t) h[0] * r[4] + (uint64_t) h[1] * r[3] + (uint64_t) h[2] * r[2] + (uint64_t) h[3] * r[1] + (uint64_t) h[4] * r[0];
+
+			d1 += d0 >> 26; h[0] = d0 & 0x3FFFFFF;
+			d2 += d1 >> 26; h[1] = d1 & 0x3FFFFFF;
+			d3 += d2 >> 26; h[2] = d2 & 0x3FFFFFF;
+			d4 += d3 >> 26; h[3] = d3 & 0x3FFFFFF;
+			h[0] += (uint32_t) (d4 >> 26) * 5; h[4] = d4 & 0x3FFFFFF;
+			h[1] += h[0] >> 26; h[0] &= 0x3FFFFFF;
+
+			m += 16;
+			len -= 16;
+		}
+	}
+
+	/**
+	 * Produce tag
+	 *
+	 * @param tag 	16 bytes
+	 */
+	void finish(unsigned char *tag)
+	{
+		uint32_t c, g[5];
+
+		c = h[1] >> 26; h[1] &= 0x3FFFFFF;
+		h[2] += c; c = h[2] >> 26; h[2] &= 0x3FFFFFF;
+		h[3] += c; c = h[3] >> 26; h[3] &= 0x3FFFFFF;
+		h[4] += c; c = h[4] >> 26; h[4] &= 0x3FFFFFF;
+		h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3FFFFFF;
+		h[1] += c;
+
+		/* h - p, selected in constant time if not negative */
+		g[0] = h[0] + 5; c = g[0] >> 26; g[0] &= 0x3FFFFFF;
+		g[1] = h[1] + c; c = g[1] >> 26; g[1] &= 0x3FFFFFF;
+		g[2] = h[2] + c; c = g[2] >> 26; g[2] &= 0x3FFFFFF;
+		g[3] = h[3] + c; c = g[3] >> 26; g[3] &= 0x3FFFFFF;
+		g[4] = h[4] + c - (1 << 26);
+
+		uint32_t mask = (g[4] >> 31) - 1;
+
+		for (int i = 0; i < 5; i++)
+		{
+			h[i] = (h[i] & ~mask) | (g[i] & mask);
+		}
+
+		uint32_t w[4];
+
+		w[0] = h[0] | h[1] << 26;
+		w[1] = h[1] >> 6 | h[2] << 20;
+		w[2] = h[2] >> 12 | h[3] << 14;
+		w[3] = h[3] >> 18 | h[4] << 8;
+
+		uint64_t f = 0;
+
+		for (int i = 0; i < 4; i++)
+		{
+			f = (uint64_t) w[i] + pad[i] + (f >> 32);
+			store32(tag + 4 * i, f);
+		}
+	}
+};
+
+/**
+ * ChaCha20-Poly1305 as in RFC 8439
+ *
+ * @param key     	key words
+ * @param nonce   	12 byte nonce
+ * @param aad     	additional data
+ * @param aadLen  	additional data length
+ * @param data    	data, transformed in place
+ * @param len     	data length
+ * @param encrypt 	true to encrypt, false to decrypt
+ * @param tag     	set to 16 byte tag
+ */
+static void chachaPoly(const uint32_t *key, const unsigned char *nonce, const unsigned char *aad, int aadLen,
+	unsigned char *data, int len, bool encrypt, unsigned char *tag)
+{
+	uint32_t state[16] = {0x61707865, 0x3320646E, 0x79622D32, 0x6B206574};
+	unsigned char block[64];
+	unsigned char lengths[16];
+	Poly1305 poly;
+
+	std::memcpy(state + 4, key, 32);
+	state[12] = 0;
+	state[13] = load32(nonce);
+	state[14] = load32(nonce + 4);
+	state[15] = load32(nonce + 8);
+
+	/* First block keys Poly1305 */
+	chachaBlock(state, block);
+	poly.init(block);
+	poly.update(aad, aadLen);
+
+	if (!encrypt)
+	{
+		poly.update(data, len);
+	}
+
+	for (int pos = 0; pos < len; pos += 64)
+	{
+		state[12]++;
+		chachaBlock(state, block);
+
+		int n = len - pos < 64 ? len - pos : 64;
+
+		for (int i = 0; i < n; i++)
+		{
+			data[pos + i] ^= block[i];
+		}
+	}
+
+	if (encrypt)
+	{
+		poly.update(data, len);
+	}
+
+	store32(lengths, aadLen);
+	store32(lengths + 4, 0);
+	store32(lengths + 8, len);
+	store32(lengths + 12, 0);
+	poly.update(lengths, 16);
+	poly.finish(tag);
+}
+
+ORF24Crypto::ORF24Crypto(ORF24 &_radio, const unsigned char *_key, uint32_t _txId, uint32_t _rxId, int _payloadSize)
+	: radio(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize),
+	  txId(_txId),
+	  rxId(_rxId)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		key[i] = load32(_key + 4 * i);
+	}
+}
+
+/**
+ * Encrypt or decrypt and compute the tag
+ *
+ * @param id      	sender ID
+ * @param header  	packet header, authenticated
+ * @param data    	data, transformed in place
+ * @param len     	data length
+ * @param encrypt 	true to encrypt, false to decrypt
+ * @param tag     	set to truncated tag
+ */
+void ORF24Crypto::process(uint32_t id, const unsigned char *header, unsigned char *data, int len, bool encrypt, unsigned char *tag)
+{
+	unsigned char nonce[12];
+	unsigned char full[16];
+
+	store32(nonce, id);
+	std::memcpy(nonce + 4, header + 1, 4);
+	store32(nonce + 8, 0);
+
+	chachaPoly(key, nonce, header, CRYPTO_HEADER_SIZE, data, len, encrypt, full);
+	std::memcpy(tag, full, CRYPTO_TAG_SIZE);
+}
+
+/**
+ * Check counter against the replay window
+ *
+ * @param  counter 	received counter
+ * @return         	true if counter was not seen before
+ */
+bool ORF24Crypto::checkReplay(uint32_t counter)
+{
+	if (rxWindow == 0 || counter > rxCounter)
+	{
+		return true;
+	}
+
+	uint32_t age = rxCounter - counter;
+
+	return age < 64 && !(rxWindow & (1ULL << age));
+}
+
+/**
+ * Record counter in the replay window
+ *
+ * @param counter 	authenticated counter
+ */
+void ORF24Crypto::updateReplay(uint32_t counter)
+{
+	if (rxWindow == 0)
+	{
+		rxCounter = counter;
+		rxWindow = 1;
+	}
+	else if (counter > rxCounter)
+	{
+		uint32_t shift = counter - rxCounter;
+
+		rxWindow = shift < 64 ? rxWindow << shift | 1 : 1;
+		rxCounter = counter;
+	}
+	else
+	{
+		rxWindow |= 1ULL << (rxCounter - counter);
+	}
+}
+
+/**
+ * Seal a packet in place
+ *
+ * @param  packet 	packet buffer
+ * @param  len    	plaintext length
+ * @return        	packet length, -1 if too long or counter is exhausted
+ */
+int ORF24Crypto::seal(unsigned char *packet, int len)
+{
+	if (len < 0 || len + CRYPTO_OVERHEAD > 32 || txExhausted)
+	{
+		return -1;
+	}
+
+	packet[0] = len;
+	store32(packet + 1, txCounter);
+
+	process(txId, packet, packet + CRYPTO_HEADER_SIZE, len, true, packet + CRYPTO_HEADER_SIZE + len);
+
+	/* A repeated nonce leaks plaintext, stop instead of wrapping */
+	if (++txCounter == 0)
+	{
+		txExhausted = true;
+	}
+
+	sealed++;
+
+	return len + CRYPTO_OVERHEAD;
+}
+
+/**
+ * Open a packet in place
+ *
+ * @param  packet 	packet buffer
+ * @param  len    	received length, padding allowed
+ * @return        	plaintext length, -1 if forged, replayed or malformed
+ */
+int ORF24Crypto::open(unsigned char *packet, int len)
+{
+	unsigned char tag[CRYPTO_TAG_SIZE];
+	unsigned char diff = 0;
+
+	if (len < CRYPTO_OVERHEAD || packet[0] > len - CRYPTO_OVERHEAD)
+	{
+		return -1;
+	}
+
+	int dataLen = packet[0];
+	uint32_t counter = load32(packet + 1);
+
+	/* Cheap check first, a replay needs no decryption */
+	if (!checkReplay(counter))
+	{
+		replayed++;
+		return -1;
+	}
+
+	unsigned char *received = packet + CRYPTO_HEADER_SIZE + dataLen;
+
+	process(rxId, packet, packet + CRYPTO_HEADER_SIZE, dataLen, false, tag);
+
+	for (int i = 0; i < CRYPTO_TAG_SIZE; i++)
+	{
+		diff |= tag[i] ^ received[i];
+	}
+
+	if (diff)
+	{
+		/* Leave no plaintext of a forgery behind */
+		std::memset(packet + CRYPTO_HEADER_SIZE, 0, dataLen);
+		forged++;
+		return -1;
+	}
+
+	updateReplay(counter);
+	opened++;
+
+	return dataLen;
+}
+
+/**
+ * Seal and write data
+ *
+ * @param  data 	plaintext
+ * @param  len  	plaintext length, at most payload size - CRYPTO_OVERHEAD
+ * @return      	false if not sealed or not acknowledged
+ */
+bool ORF24Crypto::write(const unsigned char *data, int len)
+{
+	unsigned char packet[32];
+
+	if (len < 0 || len > payloadSize - CRYPTO_OVERHEAD)
+	{
+		return false;
+	}
+
+	std::memcpy(packet + CRYPTO_HEADER_SIZE, data, len);
+
+	int packetLen = seal(packet, len);
+
+	if (packetLen < 0)
+	{
+		return false;
+	}
+
+	std::memset(packet + packetLen, 0, payloadSize - packetLen);
+
+	return radio.write(packet, payloadSize);
+}
+
+/**
+ * Read and open a packet
+ *
+ * @param  data 	set to plaintext, payload size bytes
+ * @return      	plaintext length, -1 if nothing valid was received
+ */
+int ORF24Crypto::read(unsigned char *data)
+{
+	unsigned char packet[32];
+
+	if (!radio.available())
+	{
+		return -1;
+	}
+
+	radio.read(packet, payloadSize);
+
+	int len = open(packet, payloadSize);
+
+	if (len >= 0)
+	{
+		std::memcpy(data, packet + CRYPTO_HEADER_SIZE, len);
+	}
+
+	return len;
+}
+
+/**
+ * Set counter of next sent packet
+ *
+ * @param counter 	counter
+ */
+void ORF24Crypto::setCounter(uint32_t counter)
+{
+	txCounter = counter;
+}
+
+/**
+ * Get counter of next sent packet
+ *
+ * @return  counter
+ */
+uint32_t ORF24Crypto::getCounter(void)
+{
+	return txCounter;
+}
+
+/**
+ * Get number of packets sealed
+ *
+ * @return  sealed packets
+ */
+unsigned long ORF24Crypto::getSealed(void)
+{
+	return sealed;
+}
+
+/**
+ * Get number of packets opened
+ *
+ * @return  opened packets
+ */
+unsigned long ORF24Crypto::getOpened(void)
+{
+	return opened;
+}
+
+/**
+ * Get number of packets rejected for a bad tag
+ *
+ * @return  forged packets
+ */
+unsigned long ORF24Crypto::getForged(void)
+{
+	return forged;
+}
+
+/**
+ * Get number of packets rejected as replays
+ *
+ * @return  replayed packets
+ */
+unsigned long ORF24Crypto::getReplayed(void)
+{
+	return replayed;
+}
\ No newline at end of file
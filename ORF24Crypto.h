@@ -0,0 +1,195 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_CRYPTO_H_
+#define _ORF_24_CRYPTO_H_
+
+#include <stdint.h>
+#include "ORF24.h"
+
+#define		CRYPTO_KEY_SIZE		32
+#define		CRYPTO_HEADER_SIZE	5
+#define		CRYPTO_TAG_SIZE		8
+#define		CRYPTO_OVERHEAD		(CRYPTO_HEADER_SIZE + CRYPTO_TAG_SIZE)
+
+/**
+ * ChaCha20-Poly1305 authenticated encryption of payloads
+ *
+ * Packets are sealed in place in the payload buffer:
+ *
+ *     | length | counter (4) | ciphertext ... | tag (8) | padding |
+ *
+ * Length and counter are authenticated but not encrypted. The nonce is the
+ * sender ID followed by the counter, so each direction needs its own ID
+ * and a key must never be used again after the counter restarts. Tags are
+ * truncated to 64 bits. Received counters go through a 64 packet sliding
+ * window to reject replays.
+ *
+ * ChaCha20 uses 128 bit vectors on ARM NEON and x86 SSE2 when built with
+ * GCC, scalar code elsewhere or with CRYPTO_SCALAR defined. Nothing is
+ * allocated. test/benchmark.cpp compares the packet rate with plaintext.
+ */
+class ORF24Crypto
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	int payloadSize;				/* Radio payload size */
+	uint32_t key[8];				/* ChaCha20 key words */
+	uint32_t txId;					/* Nonce prefix of sent packets */
+	uint32_t rxId;					/* Nonce prefix of received packets */
+	uint32_t txCounter = 0;			/* Counter of next sent packet */
+	uint32_t rxCounter = 0;			/* Highest received counter */
+	uint64_t rxWindow = 0;			/* Received counters below rxCounter */
+	bool txExhausted = false;		/* Whether every counter was used */
+	unsigned long sealed = 0;		/* Packets sealed */
+	unsigned long opened = 0;		/* Packets opened */
+	unsigned long forged = 0;		/* Packets with a bad tag */
+	unsigned long replayed = 0;		/* Packets with a used counter */
+
+	/**
+	 * Encrypt or decrypt and compute the tag
+	 *
+	 * @param id      	sender ID
+	 * @param header  	packet header, authenticated
+	 * @param data    	data, transformed in place
+	 * @param len     	data length
+	 * @param encrypt 	true to encrypt, false to decrypt
+	 * @param tag     	set to truncated tag
+	 */
+	void process(uint32_t id, const unsigned char *header, unsigned char *data, int len, bool encrypt, unsigned char *tag);
+
+	/**
+	 * Check counter against the replay window
+	 *
+	 * @param  counter 	received counter
+	 * @return         	true if counter was not seen before
+	 */
+	bool checkReplay(uint32_t counter);
+
+	/**
+	 * Record counter in the replay window
+	 *
+	 * @param counter 	authenticated counter
+	 */
+	void updateReplay(uint32_t counter);
+
+public:
+
+	/**
+	 * ORF24Crypto Constructor
+	 *
+	 * @param _radio 		radio to send with
+	 * @param _key   		32 byte key shared with the peer
+	 * @param _txId  		ID of this node
+	 * @param _rxId  		ID of the peer
+	 * @param _payloadSize 	radio payload size
+	 */
+	ORF24Crypto(ORF24 &_radio, const unsigned char *_key, uint32_t _txId, uint32_t _rxId, int _payloadSize = 32);
+
+	/**
+	 * Seal a packet in place
+	 *
+	 * Plaintext goes at packet + CRYPTO_HEADER_SIZE, the buffer must hold
+	 * len + CRYPTO_OVERHEAD bytes.
+	 *
+	 * @param  packet 	packet buffer
+	 * @param  len    	plaintext length
+	 * @return        	packet length, -1 if too long or counter is exhausted
+	 */
+	int seal(unsigned char *packet, int len);
+
+	/**
+	 * Open a packet in place
+	 *
+	 * Plaintext is left at packet + CRYPTO_HEADER_SIZE.
+	 *
+	 * @param  packet 	packet buffer
+	 * @param  len    	received length, padding allowed
+	 * @return        	plaintext length, -1 if forged, replayed or malformed
+	 */
+	int open(unsigned char *packet, int len);
+
+	/**
+	 * Seal and write data
+	 *
+	 * @param  data 	plaintext
+	 * @param  len  	plaintext length, at most payload size - CRYPTO_OVERHEAD
+	 * @return      	false if not sealed or not acknowledged
+	 */
+	bool write(const unsigned char *data, int len);
+
+	/**
+	 * Read and open a packet
+	 *
+	 * @param  data 	set to plaintext, payload size bytes
+	 * @return      	plaintext length, -1 if nothing valid was received
+	 */
+	int read(unsigned char *data);
+
+	/**
+	 * Set counter of next sent packet
+	 *
+	 * Restore a persisted counter after restart, never go back.
+	 *
+	 * @param counter 	counter
+	 */
+	void setCounter(uint32_t counter);
+
+	/**
+	 * Get counter of next sent packet
+	 *
+	 * @return  counter
+	 */
+	uint32_t getCounter(void);
+
+	/**
+	 * Get number of packets sealed
+	 *
+	 * @return  sealed packets
+	 */
+	unsigned long getSealed(void);
+
+	/**
+	 * Get number of packets opened
+	 *
+	 * @return  opened packets
+	 */
+	unsigned long getOpened(void);
+
+	/**
+	 * Get number of packets rejected for a bad tag
+	 *
+	 * @return  forged packets
+	 */
+	unsigned long getForged(void);
+
+	/**
+	 * Get number of packets rejected as replays
+	 *
+	 * @return  replayed packets
+	 */
+	unsigned long getReplayed(void);
+};
+
+#endif
\ No newline at end of file
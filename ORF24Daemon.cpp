@@ -0,0 +1,458 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include "ORF24Daemon.h"
+
+ORF24Daemon::ORF24Daemon(ORF24 &_radio, const char *_name, int _payloadSize)
+	: radio(_radio),
+	  name(_name),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize)
+{ }
+
+ORF24Daemon::~ORF24Daemon()
+{
+	close();
+}
+
+/**
+ * Create shared memory and start listening
+ *
+ * @return  true on success
+ */
+bool ORF24Daemon::open(void)
+{
+	int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0660);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	if (ftruncate(fd, sizeof(SharedRadio)) < 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void *map = mmap(NULL, sizeof(SharedRadio), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	shared = (SharedRadio *) map;
+	shared->doorbell.store(0);
+
+	for (int i = 0; i < ORF24_MAX_CLIENTS; i++)
+	{
+		SharedClient &client = shared->clients[i];
+
+		client.state.store(0);
+		client.pid.store(0);
+		client.pipeMask.store(0);
+		client.sent.store(0);
+		client.failed.store(0);
+		client.dropped.store(0);
+		client.tx.reset();
+		client.rx.reset();
+	}
+
+	/* Clients check the magic last */
+	std::atomic_thread_fence(std::memory_order_release);
+	shared->magic = ORF24_SHARED_MAGIC;
+
+	radio.startListening();
+
+	return true;
+}
+
+/**
+ * Remove shared memory
+ */
+void ORF24Daemon::close(void)
+{
+	if (shared)
+	{
+		shared->magic = 0;
+		munmap(shared, sizeof(SharedRadio));
+		shm_unlink(name.c_str());
+
+		shared = NULL;
+	}
+}
+
+/**
+ * Transmit one packet from a client
+ *
+ * @param  client 	client slot
+ * @param  packet 	private copy of the packet to send
+ */
+void ORF24Daemon::transmit(SharedClient &client, const SharedPacket &packet)
+{
+	/* Any client can write the ring, never trust the length */
+	if (packet.len < 1 || packet.len > payloadSize)
+	{
+		rejected++;
+		return;
+	}
+
+	radio.stopListening();
+
+	if (!addressSet || std::memcmp(address, packet.address, sizeof(address)) != 0)
+	{
+		std::memcpy(address, packet.address, sizeof(address));
+		addressSet = true;
+
+		radio.openWritingPipe((const char *) address);
+	}
+
+	bool delivered;
+
+	radio.startWrite((unsigned char *) packet.data, packet.len);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	if (delivered)
+		client.sent++;
+	else
+		client.failed++;
+
+	radio.startListening();
+}
+
+/**
+ * Route received packets to clients
+ *
+ * @return  number of packets received
+ */
+int ORF24Daemon::receive(void)
+{
+	const int fifoDepth = 3;
+	int count = 0;
+	int pipe;
+
+	/* Bounded by the RX FIFO depth so TX rings get their turn */
+	while (count < fifoDepth && radio.available(&pipe))
+	{
+		SharedPacket packet;
+
+		packet.pipe = pipe;
+		packet.len = payloadSize;
+		radio.read(packet.data, payloadSize);
+
+		for (int i = 0; i < ORF24_MAX_CLIENTS; i++)
+		{
+			SharedClient &client = shared->clients[i];
+
+			if (client.state.load(std::memory_order_acquire) != 2 || !(client.pipeMask.load() & (1 << pipe)))
+			{
+				continue;
+			}
+
+			SharedPacket *slot = client.rx.reserve();
+
+			if (!slot)
+			{
+				client.dropped++;
+				continue;
+			}
+
+			*slot = packet;
+			client.rx.commit();
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * Free slots of clients that exited without detaching
+ *
+ * A slot still attaching on two reaps in a row is freed too if its
+ * process is gone or never stored its PID.
+ */
+void ORF24Daemon::reap(void)
+{
+	for (int i = 0; i < ORF24_MAX_CLIENTS; i++)
+	{
+		SharedClient &client = shared->clients[i];
+		unsigned int state = client.state.load();
+
+		if (state == 0)
+		{
+			attaching[i] = false;
+			continue;
+		}
+
+		int pid = client.pid.load();
+		bool gone = pid == 0 || (kill(pid, 0) < 0 && errno == ESRCH);
+
+		/* Attaching takes a few stores, a client that died there never finishes */
+		bool stale = state == 1 && attaching[i] && gone;
+
+		attaching[i] = state == 1;
+
+		if ((state == 2 && pid != 0 && gone) || stale)
+		{
+			client.tx.reset();
+			client.rx.reset();
+			client.pid.store(0);
+
+			/* Only free the slot if the client did not finish attaching meanwhile */
+			client.state.compare_exchange_strong(state, 0, std::memory_order_release);
+
+			attaching[i] = false;
+		}
+	}
+}
+
+/**
+ * Run one service iteration
+ *
+ * @param  idleMs 	longest sleep when idle in milliseconds
+ * @return        	number of packets sent and received
+ */
+int ORF24Daemon::service(int idleMs)
+{
+	const unsigned long reapInterval = 1024;
+
+	if (!shared)
+	{
+		return 0;
+	}
+
+	unsigned int doorbell = shared->doorbell.load(std::memory_order_acquire);
+	int count = 0;
+
+	/* One packet per client per round keeps a busy client from starving others */
+	for (int i = 0; i < ORF24_MAX_CLIENTS; i++)
+	{
+		SharedClient &client = shared->clients[(next + i) % ORF24_MAX_CLIENTS];
+
+		if (client.state.load(std::memory_order_acquire) != 2)
+		{
+			continue;
+		}
+
+		const SharedPacket *packet = client.tx.peek();
+
+		if (packet)
+		{
+			/* The client may still write the slot, send a copy */
+			SharedPacket copy = *packet;
+
+			transmit(client, copy);
+			client.tx.release();
+			count++;
+		}
+	}
+
+	next = (next + 1) % ORF24_MAX_CLIENTS;
+
+	count += receive();
+
+	if (++iterations % reapInterval == 0)
+	{
+		reap();
+	}
+
+	/* Nothing to do, sleep until a client sends or it is time to poll RX */
+	if (count == 0)
+	{
+		futexWait(&shared->doorbell, doorbell, idleMs);
+	}
+
+	return count;
+}
+
+/**
+ * Get number of TX packets dropped for a length outside 1 to payload size
+ *
+ * @return  rejected packets
+ */
+unsigned long ORF24Daemon::getRejected(void)
+{
+	return rejected;
+}
+
+ORF24Client::~ORF24Client()
+{
+	detach();
+}
+
+/**
+ * Attach to the radio daemon
+ *
+ * @param  name 		shared memory object name
+ * @param  pipeMask 	pipes to receive packets from
+ * @return          	false if daemon is not running or all slots are taken
+ */
+bool ORF24Client::attach(const char *name, unsigned char pipeMask)
+{
+	int fd = shm_open(name, O_RDWR, 0);
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	void *map = mmap(NULL, sizeof(SharedRadio), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	shared = (SharedRadio *) map;
+
+	if (shared->magic != ORF24_SHARED_MAGIC)
+	{
+		detach();
+		return false;
+	}
+
+	for (int i = 0; i < ORF24_MAX_CLIENTS; i++)
+	{
+		SharedClient &client = shared->clients[i];
+		unsigned int free = 0;
+
+		if (client.state.compare_exchange_strong(free, 1))
+		{
+			client.tx.reset();
+			client.rx.reset();
+			client.pid.store(getpid());
+			client.pipeMask.store(pipeMask);
+			client.sent.store(0);
+			client.failed.store(0);
+			client.dropped.store(0);
+			client.state.store(2, std::memory_order_release);
+
+			slot = &client;
+
+			return true;
+		}
+	}
+
+	detach();
+
+	return false;
+}
+
+/**
+ * Release client slot
+ */
+void ORF24Client::detach(void)
+{
+	if (slot)
+	{
+		/* Cleared so a client that dies while attaching here is seen as gone */
+		slot->pid.store(0);
+		slot->state.store(0, std::memory_order_release);
+		slot = NULL;
+	}
+
+	if (shared)
+	{
+		munmap(shared, sizeof(SharedRadio));
+		shared = NULL;
+	}
+}
+
+/**
+ * Queue a packet for transmission
+ *
+ * @param  address 	destination address, 5 bytes
+ * @param  data 	payload
+ * @param  len 		payload length
+ * @return         	false if TX ring is full
+ */
+bool ORF24Client::send(const char *address, const unsigned char *data, int len)
+{
+	if (!slot || len <= 0 || len > 32)
+	{
+		return false;
+	}
+
+	SharedPacket *packet = slot->tx.reserve();
+
+	if (!packet)
+	{
+		return false;
+	}
+
+	std::memcpy(packet->address, address, sizeof(packet->address));
+	std::memcpy(packet->data, data, len);
+	packet->len = len;
+
+	slot->tx.commit();
+
+	shared->doorbell.fetch_add(1, std::memory_order_release);
+	futexWake(&shared->doorbell);
+
+	return true;
+}
+
+/**
+ * Wait for a received packet
+ *
+ * @param  timeoutMs 	timeout in milliseconds
+ * @return           	packet, NULL on timeout
+ */
+const SharedPacket *ORF24Client::receive(int timeoutMs)
+{
+	return slot ? slot->rx.wait(timeoutMs) : NULL;
+}
+
+/**
+ * Free packet returned by receive
+ */
+void ORF24Client::release(void)
+{
+	if (slot)
+	{
+		slot->rx.release();
+	}
+}
+
+/**
+ * Get number of packets acknowledged and not acknowledged
+ *
+ * @param sent 		set to acknowledged packets
+ * @param failed 	set to packets not acknowledged
+ */
+void ORF24Client::getStatistics(unsigned long *sent, unsigned long *failed)
+{
+	*sent = slot ? slot->sent.load() : 0;
+	*failed = slot ? slot->failed.load() : 0;
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_DAEMON_H_
+#define _ORF_24_DAEMON_H_
+
+#include <string>
+#include "ORF24.h"
+#include "ORF24SharedRing.h"
+
+/**
+ * Radio daemon sharing one ORF24 between processes
+ *
+ * Owns the chip and a POSIX shared memory object holding a TX and an RX
+ * ring per client. TX rings are served round robin, one packet per client
+ * per round, and received packets are copied into the RX ring of every
+ * client whose pipe mask includes the receiving pipe. Clients and daemon
+ * wake each other through futexes in the shared memory. The radio stays in
+ * RX between transmissions.
+ */
+class ORF24Daemon
+{
+private:
+	ORF24 &radio;					/* Radio owned by the daemon */
+	std::string name;				/* Shared memory object name */
+	int payloadSize;				/* Payload size in bytes */
+	SharedRadio *shared = NULL;		/* Mapped shared memory */
+	int next = 0;					/* Round robin position */
+	unsigned char address[5];		/* Open writing pipe */
+	bool addressSet = false;		/* Whether a writing pipe is open */
+	unsigned long iterations = 0;	/* Service iterations */
+	bool attaching[ORF24_MAX_CLIENTS] = {};	/* Slots found attaching by the last reap */
+	unsigned long rejected = 0;		/* TX packets with an invalid length */
+
+protected:
+
+	/**
+	 * Transmit one packet from a client
+	 *
+	 * @param  client 	client slot
+	 * @param  packet 	private copy of the packet to send
+	 */
+	void transmit(SharedClient &client, const SharedPacket &packet);
+
+	/**
+	 * Route received packets to clients
+	 *
+	 * @return  number of packets received
+	 */
+	int receive(void);
+
+	/**
+	 * Free slots of clients that exited without detaching
+	 *
+	 * A slot still attaching on two reaps in a row is freed too if its
+	 * process is gone or never stored its PID.
+	 */
+	void reap(void);
+
+public:
+
+	/**
+	 * ORF24Daemon Constructor
+	 *
+	 * @param _radio 	radio, already initialized with begin()
+	 * @param _name 	shared memory object name, e.g. "/orf24"
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24Daemon(ORF24 &_radio, const char *_name, int _payloadSize = 32);
+
+	~ORF24Daemon();
+
+	/**
+	 * Create shared memory and start listening
+	 *
+	 * @return  true on success
+	 */
+	bool open(void);
+
+	/**
+	 * Remove shared memory
+	 */
+	void close(void);
+
+	/**
+	 * Run one service iteration
+	 *
+	 * Serves every TX ring once, routes received packets and sleeps on the
+	 * doorbell when there was nothing to do.
+	 *
+	 * @param  idleMs 	longest sleep when idle in milliseconds
+	 * @return        	number of packets sent and received
+	 */
+	int service(int idleMs);
+
+	/**
+	 * Get number of TX packets dropped for a length outside 1 to payload size
+	 *
+	 * @return  rejected packets
+	 */
+	unsigned long getRejected(void);
+};
+
+/**
+ * Client of the radio daemon
+ */
+class ORF24Client
+{
+private:
+	SharedRadio *shared = NULL;		/* Mapped shared memory */
+	SharedClient *slot = NULL;		/* Claimed client slot */
+
+public:
+
+	~ORF24Client();
+
+	/**
+	 * Attach to the radio daemon
+	 *
+	 * @param  name 		shared memory object name
+	 * @param  pipeMask 	pipes to receive packets from
+	 * @return          	false if daemon is not running or all slots are taken
+	 */
+	bool attach(const char *name, unsigned char pipeMask);
+
+	/**
+	 * Release client slot
+	 */
+	void detach(void);
+
+	/**
+	 * Queue a packet for transmission
+	 *
+	 * @param  address 	destination address, 5 bytes
+	 * @param  data 	payload
+	 * @param  len 		payload length
+	 * @return         	false if TX ring is full
+	 */
+	bool send(const char *address, const unsigned char *data, int len);
+
+	/**
+	 * Wait for a received packet
+	 *
+	 * The packet stays in the ring until release() is called.
+	 *
+	 * @param  timeoutMs 	timeout in milliseconds
+	 * @return           	packet, NULL on timeout
+	 */
+	const SharedPacket *receive(int timeoutMs);
+
+	/**
+	 * Free packet returned by receive
+	 */
+	void release(void);
+
+	/**
+	 * Get number of packets acknowledged and not acknowledged
+	 *
+	 * @param sent 		set to acknowledged packets
+	 * @param failed 	set to packets not acknowledged
+	 */
+	void getStatistics(unsigned long *sent, unsigned long *failed);
+};
+
+#endif
\ No newline at end of file
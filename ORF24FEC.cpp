@@ -0,0 +1,609 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <utility>
+#include "ORF24FEC.h"
+
+/* GF(256) with polynomial x^8 + x^4 + x^3 + x^2 + 1 */
+static unsigned char gfExp[512];
+static unsigned char gfLog[256];
+static unsigned char gfMul[256][256];
+static bool gfReady = false;
+
+/**
+ * Build GF(256) log, exponent and multiplication tables
+ */
+static void gfInit(void)
+{
+	if (gfReady)
+	{
+		return;
+	}
+
+	unsigned int x = 1;
+
+	for (int i = 0; i < 255; i++)
+	{
+		gfExp[i] = x;
+		gfExp[i + 255] = x;
+		gfLog[x] = i;
+
+		x <<= 1;
+
+		if (x & 0x100)
+		{
+			x ^= 0x11D;
+		}
+	}
+
+	for (int a = 1; a < 256; a++)
+	{
+		for (int b = 1; b < 256; b++)
+		{
+			gfMul[a][b] = gfExp[gfLog[a] + gfLog[b]];
+		}
+	}
+
+	gfReady = true;
+}
+
+/**
+ * Multiplicative inverse in GF(256)
+ *
+ * @param  a 	non-zero element
+ * @return   	inverse of a
+ */
+static unsigned char gfInverse(unsigned char a)
+{
+	return gfExp[255 - gfLog[a]];
+}
+
+/**
+ * Multiply buffer by a constant and add it to another
+ *
+ * One table row lookup per byte. Row of the constant stays in cache for the
+ * whole buffer.
+ *
+ * @param dst 	buffer to add to
+ * @param src 	buffer to multiply
+ * @param c   	constant
+ * @param len 	buffer length
+ */
+static void gfMulAdd(unsigned char *dst, const unsigned char *src, unsigned char c, int len)
+{
+	if (c == 0)
+	{
+		return;
+	}
+
+	const unsigned char *row = gfMul[c];
+
+	for (int i = 0; i < len; i++)
+	{
+		dst[i] ^= row[src[i]];
+	}
+}
+
+/**
+ * Cauchy generator matrix coefficient
+ *
+ * Parity rows use x = 16 + row and data columns y = column, so coefficients
+ * do not depend on the group size and every square submatrix is invertible.
+ *
+ * @param  row    	parity shard
+ * @param  column 	data shard
+ * @return        	coefficient
+ */
+static unsigned char cauchy(int row, int column)
+{
+	return gfInverse((FEC_PARITY_INDEX + row) ^ column);
+}
+
+/**
+ * Invert matrix in GF(256) with Gauss-Jordan elimination
+ *
+ * @param  m   	matrix, destroyed
+ * @param  inv 	set to inverse
+ * @param  n   	matrix size
+ * @return     	false if matrix is singular
+ */
+static bool gfInvert(unsigned char (*m)[FEC_MAX_SHARDS], unsigned char (*inv)[FEC_MAX_SHARDS], int n)
+{
+	for (int r = 0; r < n; r++)
+	{
+		std::memset(inv[r], 0, n);
+		inv[r][r] = 1;
+	}
+
+	for (int c = 0; c < n; c++)
+	{
+		int pivot = c;
+
+		while (pivot < n && m[pivot][c] == 0)
+		{
+			pivot++;
+		}
+
+		if (pivot == n)
+		{
+			return false;
+		}
+
+		if (pivot != c)
+		{
+			for (int i = 0; i < n; i++)
+			{
+				std::swap(m[c][i], m[pivot][i]);
+				std::swap(inv[c][i], inv[pivot][i]);
+			}
+		}
+
+		unsigned char scale = gfInverse(m[c][c]);
+
+		for (int i = 0; i < n; i++)
+		{
+			m[c][i] = gfMul[scale][m[c][i]];
+			inv[c][i] = gfMul[scale][inv[c][i]];
+		}
+
+		for (int r = 0; r < n; r++)
+		{
+			if (r != c && m[r][c] != 0)
+			{
+				unsigned char factor = m[r][c];
+
+				gfMulAdd(m[r], m[c], factor, n);
+				gfMulAdd(inv[r], inv[c], factor, n);
+			}
+		}
+	}
+
+	return true;
+}
+
+ORF24FECEncoder::ORF24FECEncoder(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  shardSize((_payloadSize > 32 ? 32 : _payloadSize) - FEC_HEADER_SIZE)
+{
+	gfInit();
+	std::memset(parity, 0, sizeof(parity));
+}
+
+/**
+ * Set coding rate
+ *
+ * @param  data   	data shards per group, 1 to 16
+ * @param  parity 	parity shards per group, 0 to 16
+ * @return        	false if out of range
+ */
+bool ORF24FECEncoder::setRate(int data, int parity)
+{
+	if (data < 1 || data > FEC_MAX_SHARDS || parity < 0 || parity > FEC_MAX_SHARDS)
+	{
+		return false;
+	}
+
+	pendingData = data;
+	pendingParity = parity;
+
+	/* Parity of a started group is accumulated for its rate */
+	if (queued == 0)
+	{
+		flush();
+	}
+
+	return true;
+}
+
+/**
+ * Send one shard
+ *
+ * @param  index 	shard index
+ * @param  k     	data shards in group
+ * @param  shard 	shard content
+ * @return       	result of ORF24::write
+ */
+bool ORF24FECEncoder::sendShard(int index, int k, const unsigned char *shard)
+{
+	unsigned char payload[32];
+
+	payload[0] = group;
+	payload[1] = index;
+	payload[2] = k;
+	std::memcpy(payload + FEC_HEADER_SIZE, shard, shardSize);
+
+	bool result = radio.write(payload, shardSize + FEC_HEADER_SIZE);
+
+	packets++;
+
+	if (!result)
+	{
+		failedPackets++;
+	}
+
+	return result;
+}
+
+/**
+ * Send a message as the next data shard
+ *
+ * @param  data 	message
+ * @param  len  	message length, at most payload size - 4
+ * @return      	false if message is too long or a write failed
+ */
+bool ORF24FECEncoder::send(const unsigned char *data, int len)
+{
+	if (len < 0 || len > shardSize - 1)
+	{
+		return false;
+	}
+
+	unsigned char shard[32];
+
+	shard[0] = len;
+	std::memcpy(shard + 1, data, len);
+	std::memset(shard + 1 + len, 0, shardSize - 1 - len);
+
+	/* Parity is accumulated as data goes out, data shards are not kept */
+	for (int i = 0; i < parityShards; i++)
+	{
+		gfMulAdd(parity[i], shard, cauchy(i, queued), shardSize);
+	}
+
+	bool result = sendShard(queued, dataShards, shard);
+
+	if (++queued == dataShards)
+	{
+		return flush() && result;
+	}
+
+	return result;
+}
+
+/**
+ * Close current group early and send its parity shards
+ *
+ * Data shards not sent are zero and add nothing to parity, the parity
+ * shards tell the receiver the actual group size. A rate set while the
+ * group was open takes effect here.
+ *
+ * @return  false if a write failed
+ */
+bool ORF24FECEncoder::flush(void)
+{
+	bool result = true;
+
+	if (queued > 0)
+	{
+		for (int i = 0; i < parityShards; i++)
+		{
+			result = sendShard(FEC_PARITY_INDEX + i, queued, parity[i]) && result;
+		}
+
+		std::memset(parity, 0, sizeof(parity));
+		queued = 0;
+		group++;
+	}
+
+	/* Rate changed while the group was open */
+	if (pendingData > 0)
+	{
+		dataShards = pendingData;
+		parityShards = pendingParity;
+		pendingData = 0;
+	}
+
+	return result;
+}
+
+/**
+ * Get number of packets sent, parity included
+ *
+ * @return  packets
+ */
+unsigned long ORF24FECEncoder::getPackets(void)
+{
+	return packets;
+}
+
+/**
+ * Get number of packets that failed to send
+ *
+ * @return  failed packets
+ */
+unsigned long ORF24FECEncoder::getFailedPackets(void)
+{
+	return failedPackets;
+}
+
+ORF24FECDecoder::ORF24FECDecoder(int _payloadSize)
+	: shardSize((_payloadSize > 32 ? 32 : _payloadSize) - FEC_HEADER_SIZE)
+{
+	gfInit();
+}
+
+/**
+ * Rebuild missing data shards of current group
+ *
+ * Known data shards are subtracted from the parity shards, leaving a
+ * square Cauchy system in the missing shards only.
+ */
+void ORF24FECDecoder::decode(void)
+{
+	int missing[FEC_MAX_SHARDS];
+	int rows[FEC_MAX_SHARDS];
+	int e = 0;
+	int p = 0;
+
+	for (int i = 0; i < dataShards; i++)
+	{
+		if (!(present & (1u << i)))
+		{
+			missing[e++] = i;
+		}
+	}
+
+	for (int i = 0; i < FEC_MAX_SHARDS && p < e; i++)
+	{
+		if (present & (1u << (FEC_PARITY_INDEX + i)))
+		{
+			rows[p++] = i;
+		}
+	}
+
+	if (e == 0 || p < e)
+	{
+		return;
+	}
+
+	unsigned char m[FEC_MAX_SHARDS][FEC_MAX_SHARDS];
+	unsigned char inv[FEC_MAX_SHARDS][FEC_MAX_SHARDS];
+
+	for (int r = 0; r < e; r++)
+	{
+		unsigned char *syndrome = shards[FEC_PARITY_INDEX + rows[r]];
+
+		for (int i = 0; i < dataShards; i++)
+		{
+			if (present & (1u << i))
+			{
+				gfMulAdd(syndrome, shards[i], cauchy(rows[r], i), shardSize);
+			}
+		}
+
+		for (int c = 0; c < e; c++)
+		{
+			m[r][c] = cauchy(rows[r], missing[c]);
+		}
+	}
+
+	if (!gfInvert(m, inv, e))
+	{
+		return;
+	}
+
+	for (int c = 0; c < e; c++)
+	{
+		unsigned char *shard = shards[missing[c]];
+
+		std::memset(shard, 0, shardSize);
+
+		for (int r = 0; r < e; r++)
+		{
+			gfMulAdd(shard, shards[FEC_PARITY_INDEX + rows[r]], inv[c][r], shardSize);
+		}
+
+		present |= 1u << missing[c];
+	}
+
+	recovered += e;
+}
+
+/**
+ * Move current group to output
+ */
+void ORF24FECDecoder::finish(void)
+{
+	outputMask = 0;
+	outputCount = dataShards;
+	outputNext = 0;
+
+	int missing = 0;
+
+	for (int i = 0; i < dataShards; i++)
+	{
+		if (present & (1u << i))
+		{
+			std::memcpy(output[i], shards[i], shardSize);
+			outputMask |= 1u << i;
+		}
+		else
+		{
+			missing++;
+		}
+	}
+
+	groups++;
+
+	if (missing)
+	{
+		failedGroups++;
+		lost += missing;
+	}
+
+	decoded = true;
+}
+
+/**
+ * Process a received payload
+ *
+ * @param  payload 	received payload
+ * @param  len     	payload length
+ * @return         	true if a group was finished and messages are ready
+ */
+bool ORF24FECDecoder::receive(const unsigned char *payload, int len)
+{
+	if (len < shardSize + FEC_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	int index = payload[1];
+	int k = payload[2];
+
+	if (index >= FEC_MAX_SHARDS * 2 || k < 1 || k > FEC_MAX_SHARDS)
+	{
+		return false;
+	}
+
+	bool ready = false;
+
+	if (!active || payload[0] != group)
+	{
+		if (active && !decoded)
+		{
+			finish();
+			ready = true;
+		}
+
+		active = true;
+		decoded = false;
+		group = payload[0];
+		dataShards = k;
+		present = 0;
+	}
+
+	if (decoded)
+	{
+		return ready;
+	}
+
+	/* Parity of a flushed group carries the actual group size */
+	if (k < dataShards)
+	{
+		dataShards = k;
+	}
+
+	std::memcpy(shards[index], payload + FEC_HEADER_SIZE, shardSize);
+	present |= 1u << index;
+
+	unsigned int dataMask = (1u << dataShards) - 1;
+	unsigned int parityMask = present >> FEC_PARITY_INDEX;
+	int count = __builtin_popcount(present & dataMask) + __builtin_popcount(parityMask);
+
+	if (count >= dataShards)
+	{
+		decode();
+		finish();
+		ready = true;
+	}
+
+	return ready;
+}
+
+/**
+ * Finish current group at the end of a stream
+ *
+ * @return  true if messages are ready
+ */
+bool ORF24FECDecoder::flush(void)
+{
+	if (!active || decoded)
+	{
+		return false;
+	}
+
+	finish();
+
+	return true;
+}
+
+/**
+ * Get next decoded message
+ *
+ * @param  data 	set to message start
+ * @param  len  	set to message length
+ * @return      	false if there are no more messages
+ */
+bool ORF24FECDecoder::next(const unsigned char **data, int *len)
+{
+	while (outputNext < outputCount)
+	{
+		int i = outputNext++;
+
+		/* Lost shard, or corrupted length */
+		if (!(outputMask & (1u << i)) || output[i][0] > shardSize - 1)
+		{
+			continue;
+		}
+
+		*data = output[i] + 1;
+		*len = output[i][0];
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Get number of data shards rebuilt from parity
+ *
+ * @return  recovered shards
+ */
+unsigned long ORF24FECDecoder::getRecovered(void)
+{
+	return recovered;
+}
+
+/**
+ * Get number of data shards lost
+ *
+ * @return  lost shards
+ */
+unsigned long ORF24FECDecoder::getLost(void)
+{
+	return lost;
+}
+
+/**
+ * Get number of groups finished
+ *
+ * @return  groups
+ */
+unsigned long ORF24FECDecoder::getGroups(void)
+{
+	return groups;
+}
+
+/**
+ * Get number of groups with lost data shards
+ *
+ * @return  failed groups
+ */
+unsigned long ORF24FECDecoder::getFailedGroups(void)
+{
+	return failedGroups;
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_FEC_H_
+#define _ORF_24_FEC_H_
+
+#include "ORF24.h"
+
+#define		FEC_HEADER_SIZE 	3
+#define		FEC_MAX_SHARDS		16
+#define		FEC_PARITY_INDEX	16
+
+/**
+ * Forward error correction for broadcasts without auto-ACK
+ *
+ * Messages are grouped into data shards and every group is followed by
+ * parity shards of a systematic Reed-Solomon erasure code over GF(256)
+ * with a Cauchy generator matrix. Lost data shards of a group are rebuilt
+ * as long as at least as many shards arrive as the group has data shards.
+ * Every payload carries a 3 byte header:
+ *
+ *     | group | index | data shards | len | message | padding |
+ *
+ * Index 0 to 15 is a data shard, 16 to 31 a parity shard. The message
+ * length is part of the shard so it is recovered along with the message.
+ */
+class ORF24FECEncoder
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	int shardSize;					/* Shard size in bytes, len included */
+	int dataShards = 8;				/* Data shards per group */
+	int parityShards = 2;			/* Parity shards per group */
+	int queued = 0;					/* Data shards sent in current group */
+	int pendingData = 0;			/* Data shards of the next group, 0 if unchanged */
+	int pendingParity = 0;			/* Parity shards of the next group */
+	unsigned char group = 0;		/* Current group */
+	unsigned char parity[FEC_MAX_SHARDS][32];	/* Parity being accumulated */
+	unsigned long packets = 0;		/* Packets sent */
+	unsigned long failedPackets = 0;	/* Packets not sent */
+
+	/**
+	 * Send one shard
+	 *
+	 * @param  index 	shard index
+	 * @param  k     	data shards in group
+	 * @param  shard 	shard content
+	 * @return       	result of ORF24::write
+	 */
+	bool sendShard(int index, int k, const unsigned char *shard);
+
+public:
+
+	/**
+	 * ORF24FECEncoder Constructor
+	 *
+	 * Disable auto-ACK with ORF24::setAutoACK(false) before sending.
+	 *
+	 * @param _radio 		radio to send with
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24FECEncoder(ORF24 &_radio, int _payloadSize = 32);
+
+	/**
+	 * Set coding rate
+	 *
+	 * Takes effect from the next group, the current group keeps the rate
+	 * its parity is accumulated with.
+	 *
+	 * @param  data   	data shards per group, 1 to 16
+	 * @param  parity 	parity shards per group, 0 to 16
+	 * @return        	false if out of range
+	 */
+	bool setRate(int data, int parity);
+
+	/**
+	 * Send a message as the next data shard
+	 *
+	 * Parity shards are sent after the last data shard of the group.
+	 *
+	 * @param  data 	message
+	 * @param  len  	message length, at most payload size - 4
+	 * @return      	false if message is too long or a write failed
+	 */
+	bool send(const unsigned char *data, int len);
+
+	/**
+	 * Close current group early and send its parity shards
+	 *
+	 * A rate set while the group was open takes effect here.
+	 *
+	 * @return  false if a write failed
+	 */
+	bool flush(void);
+
+	/**
+	 * Get number of packets sent, parity included
+	 *
+	 * @return  packets
+	 */
+	unsigned long getPackets(void);
+
+	/**
+	 * Get number of packets that failed to send
+	 *
+	 * @return  failed packets
+	 */
+	unsigned long getFailedPackets(void);
+};
+
+/**
+ * Receiver side of ORF24FECEncoder
+ *
+ * Feed every received payload to receive(). A group is decoded as soon as
+ * enough shards arrived, or given up when a payload of the next group
+ * arrives. Decoded messages are then available from next() until the
+ * following group is decoded.
+ */
+class ORF24FECDecoder
+{
+private:
+	int shardSize;					/* Shard size in bytes, len included */
+	bool active = false;			/* Whether a group is being collected */
+	bool decoded = false;			/* Whether current group was decoded */
+	unsigned char group = 0;		/* Current group */
+	int dataShards = 0;				/* Data shards in current group */
+	unsigned int present = 0;		/* Received shard bitmask */
+	unsigned char shards[FEC_MAX_SHARDS * 2][32];	/* Received shards */
+	unsigned char output[FEC_MAX_SHARDS][32];	/* Shards of last decoded group */
+	unsigned int outputMask = 0;	/* Valid shards in output */
+	int outputCount = 0;			/* Data shards in output */
+	int outputNext = 0;				/* Next output shard */
+	unsigned long groups = 0;		/* Groups finished */
+	unsigned long failedGroups = 0;	/* Groups with lost shards */
+	unsigned long recovered = 0;	/* Data shards rebuilt from parity */
+	unsigned long lost = 0;			/* Data shards not recovered */
+
+	/**
+	 * Rebuild missing data shards of current group
+	 */
+	void decode(void);
+
+	/**
+	 * Move current group to output
+	 */
+	void finish(void);
+
+public:
+
+	/**
+	 * ORF24FECDecoder Constructor
+	 *
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24FECDecoder(int _payloadSize = 32);
+
+	/**
+	 * Process a received payload
+	 *
+	 * @param  payload 	received payload
+	 * @param  len     	payload length
+	 * @return         	true if a group was finished and messages are ready
+	 */
+	bool receive(const unsigned char *payload, int len);
+
+	/**
+	 * Finish current group at the end of a stream
+	 *
+	 * @return  true if messages are ready
+	 */
+	bool flush(void);
+
+	/**
+	 * Get next decoded message
+	 *
+	 * @param  data 	set to message start
+	 * @param  len  	set to message length
+	 * @return      	false if there are no more messages
+	 */
+	bool next(const unsigned char **data, int *len);
+
+	/**
+	 * Get number of data shards rebuilt from parity
+	 *
+	 * @return  recovered shards
+	 */
+	unsigned long getRecovered(void);
+
+	/**
+	 * Get number of data shards lost
+	 *
+	 * @return  lost shards
+	 */
+	unsigned long getLost(void);
+
+	/**
+	 * Get number of groups finished
+	 *
+	 * @return  groups
+	 */
+	unsigned long getGroups(void);
+
+	/**
+	 * Get number of groups with lost data shards
+	 *
+	 * @return  failed groups
+	 */
+	unsigned long getFailedGroups(void);
+};
+
+#endif
\ No newline at end of file
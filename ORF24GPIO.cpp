@@ -0,0 +1,227 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* GPIO base is above 2 GB, mmap needs a 64 bit offset on 32 bit ARM */
+#define 	_FILE_OFFSET_BITS		64
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "ORF24GPIO.h"
+
+/**
+ * Read CLOCK_MONOTONIC
+ *
+ * @return  time in nanoseconds
+ */
+static inline unsigned long long monotonicNanos(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+ORF24GPIO::~ORF24GPIO()
+{
+	if (mapped)
+	{
+		munmap((void *) gpio, S805_GPIO_BLOCK_SIZE);
+	}
+}
+
+/**
+ * Map GPIO registers
+ *
+ * @return  true on success
+ */
+bool ORF24GPIO::open(void)
+{
+	if (gpio)
+	{
+		return true;
+	}
+
+	int fd = ::open("/dev/gpiomem", O_RDWR | O_SYNC | O_CLOEXEC);
+
+	if (fd < 0)
+	{
+		fd = ::open("/dev/mem", O_RDWR | O_SYNC | O_CLOEXEC);
+	}
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	void *map = mmap(NULL, S805_GPIO_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, S805_GPIO_BASE);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		return false;
+	}
+
+	gpio = (volatile unsigned int *) map;
+	mapped = true;
+
+	return true;
+}
+
+/**
+ * Use memory instead of GPIO registers
+ *
+ * @param memory 	at least S805_GPIO_BLOCK_SIZE bytes
+ */
+void ORF24GPIO::useMemory(volatile unsigned int *memory)
+{
+	if (mapped)
+	{
+		munmap((void *) gpio, S805_GPIO_BLOCK_SIZE);
+		mapped = false;
+	}
+
+	gpio = memory;
+}
+
+/**
+ * Set a pin as output
+ *
+ * @param  gpioPin 	S805 GPIO number
+ * @param  pin 		resolved pin
+ * @return         	false if pin is not on GPIOX or GPIOY
+ */
+bool ORF24GPIO::output(int gpioPin, Pin *pin)
+{
+	int fsel, outp, bit;
+
+	if (!gpio)
+	{
+		return false;
+	}
+
+	if (gpioPin >= S805_GPIOX_START && gpioPin <= S805_GPIOX_END)
+	{
+		fsel = S805_GPIOX_FSEL;
+		outp = S805_GPIOX_OUTP;
+		bit = gpioPin - S805_GPIOX_START;
+	}
+	else if (gpioPin >= S805_GPIOY_START && gpioPin <= S805_GPIOY_END)
+	{
+		fsel = S805_GPIOY_FSEL;
+		outp = S805_GPIOY_OUTP;
+		bit = gpioPin - S805_GPIOY_START;
+	}
+	else
+	{
+		return false;
+	}
+
+	/* Cleared FSEL bit selects output */
+	*(gpio + fsel) &= ~(1 << bit);
+
+	pin->output = gpio + outp;
+	pin->mask = 1 << bit;
+
+	return true;
+}
+
+/**
+ * Use memory instead of GPIO registers
+ *
+ * @param memory 	at least S805_GPIO_BLOCK_SIZE bytes
+ */
+void GPIOTransport::useMemory(volatile unsigned int *memory)
+{
+	gpio.useMemory(memory);
+}
+
+bool GPIOTransport::setup(int ce, int spiChannel, int spiSpeed)
+{
+	bool result = WiringPiTransport::setup(ce, spiChannel, spiSpeed);
+
+	fast = gpio.open() && gpio.output(wpiPinToGpio(ce), &cePin);
+
+	if (fast)
+	{
+		ORF24GPIO::write(cePin, LOW);
+	}
+
+	return result;
+}
+
+void GPIOTransport::writeCE(int ce, int value)
+{
+	if (fast)
+		ORF24GPIO::write(cePin, value);
+	else
+		WiringPiTransport::writeCE(ce, value);
+}
+
+void GPIOTransport::pulseCE(int ce, unsigned int us)
+{
+	if (!fast)
+	{
+		WiringPiTransport::pulseCE(ce, us);
+		return;
+	}
+
+	unsigned long long begin = monotonicNanos();
+
+	ORF24GPIO::write(cePin, HIGH);
+
+	/* Read back so the store has reached the pin before timing starts */
+	(void) *cePin.output;
+
+	unsigned long long high = monotonicNanos();
+
+	while (monotonicNanos() - high < us * 1000ULL)
+		;
+
+	ORF24GPIO::write(cePin, LOW);
+
+	unsigned int width = monotonicNanos() - begin;
+
+	longestPulse = width > longestPulse ? width : longestPulse;
+}
+
+/**
+ * Check whether CE goes through memory mapped GPIO
+ *
+ * @return  true if memory mapped
+ */
+bool GPIOTransport::isMapped(void)
+{
+	return fast;
+}
+
+/**
+ * Get longest CE pulse measured
+ *
+ * @return  pulse width in nanoseconds
+ */
+unsigned int GPIOTransport::getLongestPulse(void)
+{
+	return longestPulse;
+}
\ No newline at end of file
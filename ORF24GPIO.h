@@ -0,0 +1,153 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_GPIO_H_
+#define _ORF_24_GPIO_H_
+
+#include "ORF24Transport.h"
+
+/* S805 GPIO registers, offsets in 32 bit words */
+#define 	S805_GPIO_BASE			0xC1108000
+#define 	S805_GPIO_BLOCK_SIZE	4096
+#define 	S805_GPIOX_START		97
+#define 	S805_GPIOX_END			118
+#define 	S805_GPIOX_FSEL			0x0C
+#define 	S805_GPIOX_OUTP			0x0D
+#define 	S805_GPIOY_START		80
+#define 	S805_GPIOY_END			96
+#define 	S805_GPIOY_FSEL			0x0F
+#define 	S805_GPIOY_OUTP			0x10
+
+/**
+ * Memory mapped S805 GPIO
+ *
+ * Maps the GPIO block through /dev/gpiomem, or /dev/mem as root, so a pin
+ * is driven by writing its output register directly instead of going
+ * through wiringPi's pin layer. Any word array can stand in for the
+ * registers for testing.
+ */
+class ORF24GPIO
+{
+private:
+	volatile unsigned int *gpio = NULL;	/* GPIO registers */
+	bool mapped = false;			/* Whether gpio is an mmap */
+
+public:
+
+	/**
+	 * Output pin resolved to its register and bit
+	 */
+	struct Pin
+	{
+		volatile unsigned int *output = NULL;	/* Output register */
+		unsigned int mask = 0;		/* Pin bit */
+	};
+
+	~ORF24GPIO();
+
+	/**
+	 * Map GPIO registers
+	 *
+	 * @return  true on success
+	 */
+	bool open(void);
+
+	/**
+	 * Use memory instead of GPIO registers
+	 *
+	 * @param memory 	at least S805_GPIO_BLOCK_SIZE bytes
+	 */
+	void useMemory(volatile unsigned int *memory);
+
+	/**
+	 * Set a pin as output
+	 *
+	 * @param  gpioPin 	S805 GPIO number
+	 * @param  pin 		resolved pin
+	 * @return         	false if pin is not on GPIOX or GPIOY
+	 */
+	bool output(int gpioPin, Pin *pin);
+
+	/**
+	 * Drive a pin
+	 *
+	 * @param pin 		resolved pin
+	 * @param value 	HIGH or LOW
+	 */
+	static inline void write(const Pin &pin, int value)
+	{
+		if (value)
+			*pin.output |= pin.mask;
+		else
+			*pin.output &= ~pin.mask;
+	}
+};
+
+/**
+ * Transport driving CE through memory mapped GPIO
+ *
+ * SPI and timing still go through wiringPi. CE pulses are timed against
+ * CLOCK_MONOTONIC after the high level is read back from the register, so
+ * they are never shorter than requested; the longest pulse seen is kept.
+ * Falls back to wiringPi when the registers can not be mapped.
+ */
+class GPIOTransport : public WiringPiTransport
+{
+private:
+	ORF24GPIO gpio;					/* GPIO registers */
+	ORF24GPIO::Pin cePin;			/* Resolved CE pin */
+	bool fast = false;				/* Whether CE is memory mapped */
+	unsigned int longestPulse = 0;	/* Longest CE pulse in nanoseconds */
+
+public:
+
+	/**
+	 * Use memory instead of GPIO registers
+	 *
+	 * @param memory 	at least S805_GPIO_BLOCK_SIZE bytes
+	 */
+	void useMemory(volatile unsigned int *memory);
+
+	bool setup(int ce, int spiChannel, int spiSpeed);
+
+	void writeCE(int ce, int value);
+
+	void pulseCE(int ce, unsigned int us);
+
+	/**
+	 * Check whether CE goes through memory mapped GPIO
+	 *
+	 * @return  true if memory mapped
+	 */
+	bool isMapped(void);
+
+	/**
+	 * Get longest CE pulse measured
+	 *
+	 * @return  pulse width in nanoseconds
+	 */
+	unsigned int getLongestPulse(void);
+};
+
+#endif
\ No newline at end of file
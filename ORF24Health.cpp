@@ -0,0 +1,245 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "ORF24Health.h"
+
+ORF24Health::ORF24Health(ORF24 &_radio)
+	: radio(_radio)
+{
+	lastCheck = radio.getTransport()->micros();
+	seenTimeouts = radio.getWriteTimeouts();
+}
+
+/**
+ * Set time between checks run by service()
+ *
+ * @param us 	interval in microseconds
+ */
+void ORF24Health::setInterval(unsigned int us)
+{
+	interval = us;
+}
+
+/**
+ * Check the chip and recover from any fault found
+ *
+ * @return  HealthFault bit mask found before recovery
+ */
+int ORF24Health::check(void)
+{
+	ORF24Transport *transport = radio.getTransport();
+
+	checks++;
+
+	int faults = radio.checkHealth();
+
+	/* A snapshot of reset registers would make recover() restore them */
+	if (!saved && faults == HEALTH_OK)
+	{
+		radio.saveConfig();
+		saved = true;
+	}
+
+	unsigned long timeouts = radio.getWriteTimeouts();
+
+	if (timeouts != seenTimeouts)
+	{
+		faults |= HEALTH_TIMEOUT;
+		seenTimeouts = timeouts;
+	}
+
+	lastFaults = faults;
+
+	if (faults == HEALTH_OK)
+	{
+		return faults;
+	}
+
+	for (int i = 0; i < HEALTH_FAULT_TYPES; i++)
+	{
+		if (faults & (1 << i))
+		{
+			faultCounts[i]++;
+		}
+	}
+
+	unsigned int start = transport->micros();
+
+	radio.recover(faults);
+
+	bool healthy = radio.checkHealth() == HEALTH_OK;
+
+	lastRecoveryTime = transport->micros() - start;
+	totalRecoveryTime += lastRecoveryTime;
+
+	if (lastRecoveryTime > maxRecoveryTime)
+	{
+		maxRecoveryTime = lastRecoveryTime;
+	}
+
+	if (healthy)
+	{
+		recoveries++;
+	}
+	else
+	{
+		failedRecoveries++;
+	}
+
+	return faults;
+}
+
+/**
+ * Run check() once per interval
+ *
+ * @return  HealthFault bit mask, HEALTH_OK if no check was due
+ */
+int ORF24Health::service(void)
+{
+	unsigned int now = radio.getTransport()->micros();
+
+	if (now - lastCheck < interval)
+	{
+		return HEALTH_OK;
+	}
+
+	lastCheck = now;
+
+	return check();
+}
+
+/**
+ * Write payload, check the chip on failure and retry once if a fault
+ * was recovered
+ *
+ * @param  data 	data to write
+ * @param  len  	data length
+ * @return      	true if acknowledged
+ */
+bool ORF24Health::write(unsigned char *data, int len)
+{
+	if (radio.write(data, len))
+	{
+		return true;
+	}
+
+	/* Plain MAX_RT is cleared by write, only retry after a repair */
+	if (check() == HEALTH_OK)
+	{
+		return false;
+	}
+
+	return radio.write(data, len);
+}
+
+/**
+ * Get faults found by the last check
+ *
+ * @return  HealthFault bit mask
+ */
+int ORF24Health::getLastFaults(void)
+{
+	return lastFaults;
+}
+
+/**
+ * Get number of checks run
+ *
+ * @return  checks
+ */
+unsigned long ORF24Health::getChecks(void)
+{
+	return checks;
+}
+
+/**
+ * Get number of checks that found a fault
+ *
+ * @param  fault 	single HealthFault bit
+ * @return       	detections
+ */
+unsigned long ORF24Health::getFaults(HealthFault fault)
+{
+	for (int i = 0; i < HEALTH_FAULT_TYPES; i++)
+	{
+		if (fault == (1 << i))
+		{
+			return faultCounts[i];
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get number of recoveries that left the chip healthy
+ *
+ * @return  recoveries
+ */
+unsigned long ORF24Health::getRecoveries(void)
+{
+	return recoveries;
+}
+
+/**
+ * Get number of recoveries after which a fault remained
+ *
+ * @return  failed recoveries
+ */
+unsigned long ORF24Health::getFailedRecoveries(void)
+{
+	return failedRecoveries;
+}
+
+/**
+ * Get duration of last recovery
+ *
+ * @return  time in microseconds
+ */
+unsigned int ORF24Health::getLastRecoveryTime(void)
+{
+	return lastRecoveryTime;
+}
+
+/**
+ * Get longest recovery
+ *
+ * @return  time in microseconds
+ */
+unsigned int ORF24Health::getMaxRecoveryTime(void)
+{
+	return maxRecoveryTime;
+}
+
+/**
+ * Get mean recovery duration
+ *
+ * @return  time in microseconds
+ */
+double ORF24Health::getMeanRecoveryTime(void)
+{
+	unsigned long total = recoveries + failedRecoveries;
+
+	return total ? (double) totalRecoveryTime / total : 0;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_HEALTH_H_
+#define _ORF_24_HEALTH_H_
+
+#include "ORF24.h"
+
+#define		HEALTH_FAULT_TYPES	6
+
+/**
+ * Chip health watchdog
+ *
+ * Checks STATUS, FIFO_STATUS and the configuration registers between writes
+ * and repairs what it finds in place: a latched MAX_RT or a stuck TX FIFO is
+ * flushed and cleared, an inconsistent RX FIFO is flushed, and registers
+ * reset by a brown-out are written back from the configuration the driver
+ * last wrote. A recovery takes a few SPI transfers instead of the 100 ms
+ * power on reset wait of begin(). Writes that time out are also counted as
+ * a fault.
+ *
+ * Call service() from the main loop while no write is in flight, or use
+ * write() to check and retry once after a failed write.
+ */
+class ORF24Health
+{
+private:
+	ORF24 &radio;					/* Radio to watch */
+	unsigned int interval = 1000000;	/* Time between checks in microseconds */
+	unsigned int lastCheck;			/* Time of last check */
+	bool saved = false;				/* Whether the known configuration was read */
+	unsigned long seenTimeouts = 0;	/* Write timeouts already handled */
+	int lastFaults = HEALTH_OK;		/* Faults found by last check */
+	unsigned long checks = 0;		/* Checks run */
+	unsigned long faultCounts[HEALTH_FAULT_TYPES] = {};	/* Detections per fault */
+	unsigned long recoveries = 0;	/* Recoveries that left the chip healthy */
+	unsigned long failedRecoveries = 0;	/* Recoveries that did not */
+	unsigned int lastRecoveryTime = 0;	/* Duration of last recovery in microseconds */
+	unsigned int maxRecoveryTime = 0;	/* Longest recovery in microseconds */
+	unsigned long long totalRecoveryTime = 0;	/* Sum of recovery durations */
+
+public:
+
+	/**
+	 * ORF24Health Constructor
+	 *
+	 * @param _radio 	radio to watch
+	 */
+	ORF24Health(ORF24 &_radio);
+
+	/**
+	 * Set time between checks run by service()
+	 *
+	 * @param us 	interval in microseconds
+	 */
+	void setInterval(unsigned int us);
+
+	/**
+	 * Check the chip and recover from any fault found
+	 *
+	 * The first check that finds no fault reads the configuration to
+	 * restore later, so call it after the radio is configured. Until then
+	 * only registers the driver wrote are restored.
+	 *
+	 * @return  HealthFault bit mask found before recovery
+	 */
+	int check(void);
+
+	/**
+	 * Run check() once per interval, call frequently
+	 *
+	 * @return  HealthFault bit mask, HEALTH_OK if no check was due
+	 */
+	int service(void);
+
+	/**
+	 * Write payload, check the chip on failure and retry once if a fault
+	 * was recovered
+	 *
+	 * @param  data 	data to write
+	 * @param  len  	data length
+	 * @return      	true if acknowledged
+	 */
+	bool write(unsigned char *data, int len);
+
+	/**
+	 * Get faults found by the last check
+	 *
+	 * @return  HealthFault bit mask
+	 */
+	int getLastFaults(void);
+
+	/**
+	 * Get number of checks run
+	 *
+	 * @return  checks
+	 */
+	unsigned long getChecks(void);
+
+	/**
+	 * Get number of checks that found a fault
+	 *
+	 * @param  fault 	single HealthFault bit
+	 * @return       	detections
+	 */
+	unsigned long getFaults(HealthFault fault);
+
+	/**
+	 * Get number of recoveries that left the chip healthy
+	 *
+	 * @return  recoveries
+	 */
+	unsigned long getRecoveries(void);
+
+	/**
+	 * Get number of recoveries after which a fault remained
+	 *
+	 * @return  failed recoveries
+	 */
+	unsigned long getFailedRecoveries(void);
+
+	/**
+	 * Get duration of last recovery, the check that confirms it included
+	 *
+	 * @return  time in microseconds
+	 */
+	unsigned int getLastRecoveryTime(void);
+
+	/**
+	 * Get longest recovery
+	 *
+	 * @return  time in microseconds
+	 */
+	unsigned int getMaxRecoveryTime(void);
+
+	/**
+	 * Get mean recovery duration
+	 *
+	 * @return  time in microseconds
+	 */
+	double getMeanRecoveryTime(void);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,642 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "ORF24LinkAdapter.h"
+#include "nRF24L01Register.h"
+
+using namespace nRF24L01;
+
+/* Profiles from most robust to fastest, 250 kbps needs nRF24L01+ */
+static const LinkProfile defaultProfiles[] =
+{
+	{ RF_DR_250KBPS, RF_PA_MAX, CRC_2_BYTE, 15 },
+	{ RF_DR_1MBPS, RF_PA_MAX, CRC_2_BYTE, 15 },
+	{ RF_DR_2MBPS, RF_PA_MAX, CRC_2_BYTE, 10 },
+	{ RF_DR_2MBPS, RF_PA_LOW, CRC_1_BYTE, 5 }
+};
+
+ORF24LinkAdapter::ORF24LinkAdapter(int _payloadSize)
+	: profiles(defaultProfiles),
+	  profileCount(sizeof(defaultProfiles) / sizeof(defaultProfiles[0])),
+	  payloadSize(_payloadSize),
+	  usable(profileCount, true)
+{ }
+
+/**
+ * Set profile ladder
+ *
+ * @param _profiles 	profiles from most robust to fastest
+ * @param count 		number of profiles
+ */
+void ORF24LinkAdapter::setProfiles(const LinkProfile *_profiles, int count)
+{
+	profiles = _profiles;
+	profileCount = count;
+
+	usable.assign(count, true);
+	localProfile = 0;
+
+	links.clear();
+}
+
+/**
+ * Set evaluation window and hysteresis
+ *
+ * @param packets 	packets per window
+ * @param hold 		clean windows before stepping up
+ * @param _maxHold 	longest hold after failed probes
+ */
+void ORF24LinkAdapter::setWindow(int packets, int hold, int _maxHold)
+{
+	window = packets > 0 ? packets : 1;
+	baseHold = hold > 0 ? hold : 1;
+	maxHold = _maxHold > baseHold ? _maxHold : baseHold;
+}
+
+/**
+ * Set thresholds of degraded and clean windows
+ *
+ * @param loss 			loss ratio of a degraded window
+ * @param retries 		mean retransmissions of a degraded window
+ * @param clean 		mean retransmissions of a clean window
+ */
+void ORF24LinkAdapter::setThresholds(double loss, double retries, double clean)
+{
+	maxLoss = loss;
+	maxRetries = retries;
+	cleanRetries = clean;
+}
+
+/**
+ * Skip profiles the radio cannot run
+ *
+ * @param radio 	radio
+ */
+void ORF24LinkAdapter::skipUnsupported(ORF24 &radio)
+{
+	for (int i = 0; i < profileCount; i++)
+	{
+		if (profiles[i].rate == RF_DR_250KBPS && !radio.isPlusVariant())
+		{
+			usable[i] = false;
+		}
+	}
+
+	if (localProfile >= 0 && !usable[localProfile])
+	{
+		localProfile = robust();
+	}
+}
+
+/**
+ * Set how long a peer waits for a payload before falling back
+ *
+ * @param timeout 	silence in milliseconds
+ */
+void ORF24LinkAdapter::setSilenceTimeout(unsigned int timeout)
+{
+	silenceTimeout = timeout;
+}
+
+/**
+ * Get link state, creating it on first use
+ *
+ * @param  peer 	destination identifier
+ * @return      	link state
+ */
+LinkState &ORF24LinkAdapter::link(int peer)
+{
+	std::map<int, LinkState>::iterator it = links.find(peer);
+
+	if (it == links.end())
+	{
+		int first = robust();
+
+		LinkState state;
+		state.hold = baseHold;
+		state.profile = first > 0 ? first : 0;
+
+		it = links.insert(std::make_pair(peer, state)).first;
+	}
+
+	return it->second;
+}
+
+/**
+ * Find the nearest usable profile in a direction
+ *
+ * @param  profile 		profile to start from, excluded
+ * @param  direction 	1 for faster, -1 for more robust
+ * @return           	profile index, -1 if there is none
+ */
+int ORF24LinkAdapter::step(int profile, int direction)
+{
+	for (int i = profile + direction; i >= 0 && i < profileCount; i += direction)
+	{
+		if (usable[i])
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Get the most robust usable profile
+ *
+ * @return  profile index, -1 if no profile is usable
+ */
+int ORF24LinkAdapter::robust(void)
+{
+	return step(-1, 1);
+}
+
+/**
+ * Estimate goodput of a window
+ *
+ * Every attempt costs TX settling, packet air time and the retransmission
+ * delay that waits for the ACK.
+ *
+ * @param  state 	link state
+ * @return       	goodput in bit/s
+ */
+double ORF24LinkAdapter::estimateGoodput(const LinkState &state)
+{
+	const LinkProfile &p = profiles[state.profile];
+	const double settling = 130;
+
+	double attempt = settling + packetAirTime(p.rate, payloadSize, p.crc) +
+		(minimumRetryDelay(p.rate, 0) + 1) * 250;
+	double time = (state.packets + state.retransmissions) * attempt;
+	double delivered = state.packets - state.lost;
+
+	return time > 0 ? delivered * payloadSize * 8 * 1e6 / time : 0;
+}
+
+/**
+ * Evaluate a finished window
+ *
+ * @param  state 	link state
+ */
+void ORF24LinkAdapter::evaluate(LinkState &state)
+{
+	double loss = (double) state.lost / state.packets;
+	double retries = (double) state.retransmissions / state.packets;
+
+	state.goodput = estimateGoodput(state);
+
+	state.packets = 0;
+	state.retransmissions = 0;
+	state.lost = 0;
+
+	/* Revert an upward probe that did not pay off and wait longer next time */
+	if (state.previousProfile >= 0)
+	{
+		int profile = state.previousProfile;
+		int power = state.previousPower;
+		double goodput = state.previousGoodput;
+
+		state.previousProfile = -1;
+
+		if (state.goodput < goodput)
+		{
+			state.hold = state.hold * 2 < maxHold ? state.hold * 2 : maxHold;
+			state.ceiling = state.profile;
+			state.cleanWindows = 0;
+
+			request(state, profile, power);
+			return;
+		}
+
+		if (state.profile >= state.ceiling)
+		{
+			state.hold = baseHold;
+			state.ceiling = -1;
+		}
+	}
+
+	if (loss > maxLoss || retries > maxRetries)
+	{
+		state.cleanWindows = 0;
+
+		int lower = step(state.profile, -1);
+
+		if (state.power < RF_PA_MAX)
+		{
+			request(state, state.profile, state.power + 1);
+		}
+		else if (lower >= 0)
+		{
+			request(state, lower, RF_PA_MAX);
+		}
+	}
+	else if (loss == 0 && retries < cleanRetries)
+	{
+		int higher = step(state.profile, 1);
+
+		/* Only a probe to the profile that failed before waits longer */
+		if (++state.cleanWindows < (higher >= 0 && higher == state.ceiling ? state.hold : baseHold))
+		{
+			return;
+		}
+
+		state.cleanWindows = 0;
+
+		if (higher >= 0)
+		{
+			state.previousProfile = state.profile;
+			state.previousPower = state.power;
+			state.previousGoodput = state.goodput;
+
+			request(state, higher, RF_PA_MAX);
+		}
+		else if (state.power > profiles[state.profile].power)
+		{
+			request(state, state.profile, state.power - 1);
+		}
+	}
+	else
+	{
+		state.cleanWindows = 0;
+	}
+}
+
+/**
+ * Request a profile and power change
+ *
+ * @param  state 	link state
+ * @param  profile 	new profile index
+ * @param  power 	new power level
+ */
+void ORF24LinkAdapter::request(LinkState &state, int profile, int power)
+{
+	state.pendingProfile = profile;
+	state.pendingPower = power;
+}
+
+/**
+ * Record result of one transmission
+ *
+ * @param  peer 		destination identifier
+ * @param  observeTX 	OBSERVE_TX value after the transmission
+ * @param  delivered 	whether TX_DS was set
+ * @return           	true if settings changed or a change is pending
+ */
+bool ORF24LinkAdapter::record(int peer, unsigned char observeTX, bool delivered)
+{
+	LinkState &state = link(peer);
+
+	state.packets++;
+	state.retransmissions += RetransmitCounter::decode(observeTX);
+
+	if (delivered)
+	{
+		state.failStreak = 0;
+	}
+	else
+	{
+		state.lost++;
+		state.failStreak++;
+	}
+
+	int first = robust();
+
+	if (first < 0)
+	{
+		first = 0;
+	}
+
+	/* Peer may have missed a switch, meet it on the most robust profile */
+	if (state.failStreak >= fallbackFailures && (state.profile != first || state.power < RF_PA_MAX))
+	{
+		/* An upward probe that broke the link failed too */
+		if (state.previousProfile >= 0)
+		{
+			state.hold = state.hold * 2 < maxHold ? state.hold * 2 : maxHold;
+			state.ceiling = state.profile;
+		}
+
+		state.profile = first;
+		state.power = RF_PA_MAX;
+		state.pendingProfile = -1;
+		state.previousProfile = -1;
+		state.failStreak = 0;
+		state.cleanWindows = 0;
+		state.packets = 0;
+		state.retransmissions = 0;
+		state.lost = 0;
+		state.switches++;
+
+		return true;
+	}
+
+	if (state.packets >= window)
+	{
+		evaluate(state);
+	}
+
+	return state.pendingProfile >= 0;
+}
+
+/**
+ * Check whether a change is waiting for the peer
+ *
+ * @param  peer 	destination identifier
+ * @return      	true if a change is pending
+ */
+bool ORF24LinkAdapter::hasPendingSwitch(int peer)
+{
+	return link(peer).pendingProfile >= 0;
+}
+
+/**
+ * Build switch command for the peer
+ *
+ * @param  peer 	destination identifier
+ * @param  buf 		payload buffer of at least 3 bytes
+ * @return      	command length
+ */
+int ORF24LinkAdapter::buildSwitch(int peer, unsigned char *buf)
+{
+	LinkState &state = link(peer);
+
+	buf[0] = LINK_SWITCH_COMMAND;
+	buf[1] = state.pendingProfile;
+	buf[2] = state.pendingPower;
+
+	return 3;
+}
+
+/**
+ * Commit pending change after the peer acknowledged it
+ *
+ * @param  peer 	destination identifier
+ */
+void ORF24LinkAdapter::commitSwitch(int peer)
+{
+	LinkState &state = link(peer);
+
+	if (state.pendingProfile < 0)
+	{
+		return;
+	}
+
+	state.profile = state.pendingProfile;
+	state.power = state.pendingPower;
+	state.pendingProfile = -1;
+	state.packets = 0;
+	state.retransmissions = 0;
+	state.lost = 0;
+	state.switches++;
+}
+
+/**
+ * Drop pending change after the peer missed it
+ *
+ * @param  peer 	destination identifier
+ */
+void ORF24LinkAdapter::cancelSwitch(int peer)
+{
+	LinkState &state = link(peer);
+
+	state.pendingProfile = -1;
+	state.previousProfile = -1;
+}
+
+/**
+ * Parse switch command on the peer side
+ *
+ * @param  buf 			received payload
+ * @param  len 			payload length
+ * @param  profile 		received profile index
+ * @param  power 		received power level
+ * @return         		true if payload is a valid switch command
+ */
+bool ORF24LinkAdapter::acceptSwitch(const unsigned char *buf, int len, int *profile, int *power)
+{
+	if (len < 3 || buf[0] != LINK_SWITCH_COMMAND || buf[1] >= profileCount || !usable[buf[1]] || buf[2] > RF_PA_MAX)
+	{
+		return false;
+	}
+
+	*profile = buf[1];
+	*power = buf[2];
+
+	return true;
+}
+
+/**
+ * Handle a received payload on the peer side
+ *
+ * Any payload restarts the silence timer, a switch command is applied
+ * to the radio.
+ *
+ * @param  radio 	radio
+ * @param  buf 		received payload
+ * @param  len 		payload length
+ * @return     		true if payload was a switch command
+ */
+bool ORF24LinkAdapter::receive(ORF24 &radio, const unsigned char *buf, int len)
+{
+	int profile, power;
+
+	lastHeard = radio.getTransport()->millis();
+
+	if (!acceptSwitch(buf, len, &profile, &power))
+	{
+		return false;
+	}
+
+	/* The chip already sent the ACK on the old settings */
+	if (apply(radio, profile, power))
+	{
+		localProfile = profile;
+	}
+
+	return true;
+}
+
+/**
+ * Fall back to the most robust profile after silence on the peer side
+ *
+ * The gateway falls back after repeated MAX_RT, so both ends meet on the
+ * first profile when a switch was lost in either direction.
+ *
+ * @param  radio 	radio
+ * @return       	true if settings changed
+ */
+bool ORF24LinkAdapter::service(ORF24 &radio)
+{
+	int first = robust();
+	unsigned int now = radio.getTransport()->millis();
+
+	if (first < 0 || localProfile == first || now - lastHeard < silenceTimeout)
+	{
+		return false;
+	}
+
+	lastHeard = now;
+
+	if (!apply(radio, first, RF_PA_MAX))
+	{
+		return false;
+	}
+
+	localProfile = first;
+
+	return true;
+}
+
+/**
+ * Apply settings of a destination to the radio
+ *
+ * A profile the radio rejects is skipped from then on and the link
+ * moves to the most robust usable profile.
+ *
+ * @param  radio 	radio
+ * @param  peer 	destination identifier
+ * @return       	false if no usable profile was applied
+ */
+bool ORF24LinkAdapter::apply(ORF24 &radio, int peer)
+{
+	LinkState &state = link(peer);
+
+	while (!apply(radio, state.profile, state.power))
+	{
+		int first = robust();
+
+		if (first < 0)
+		{
+			return false;
+		}
+
+		state.profile = first;
+		state.power = RF_PA_MAX;
+		state.pendingProfile = -1;
+		state.previousProfile = -1;
+	}
+
+	return true;
+}
+
+/**
+ * Apply a profile and power level to the radio
+ *
+ * @param  radio 	radio
+ * @param  profile 	profile index
+ * @param  power 	power level
+ * @return       	false if the radio can not run the profile
+ */
+bool ORF24LinkAdapter::apply(ORF24 &radio, int profile, int power)
+{
+	if (profile < 0 || profile >= profileCount || !usable[profile])
+	{
+		return false;
+	}
+
+	const LinkProfile &p = profiles[profile];
+
+	/* Data rate first, nothing is changed if the chip rejects it */
+	if (!radio.setDataRate(p.rate))
+	{
+		usable[profile] = false;
+		return false;
+	}
+
+	radio.setRetries(p.retryCount);
+	radio.setCRCLength(p.crc);
+	radio.setPowerLevel((RFPower) power);
+
+	return true;
+}
+
+/**
+ * Write payload, record the result and run a pending switch
+ *
+ * @param  radio 	radio
+ * @param  peer 	destination identifier
+ * @param  data 	data to write
+ * @param  len 		data length
+ * @return       	status
+ */
+bool ORF24LinkAdapter::write(ORF24 &radio, int peer, unsigned char *data, int len)
+{
+	bool result = radio.write(data, len);
+
+	if (record(peer, radio.getObserveTX(), result))
+	{
+		if (hasPendingSwitch(peer))
+		{
+			unsigned char command[32] = { 0 };
+
+			buildSwitch(peer, command);
+
+			if (radio.write(command, payloadSize))
+			{
+				commitSwitch(peer);
+			}
+			else
+			{
+				cancelSwitch(peer);
+			}
+		}
+
+		apply(radio, peer);
+	}
+
+	return result;
+}
+
+/**
+ * Get current profile of a destination
+ *
+ * @param  peer 	destination identifier
+ * @return      	profile
+ */
+const LinkProfile &ORF24LinkAdapter::getProfile(int peer)
+{
+	return profiles[link(peer).profile];
+}
+
+/**
+ * Get link state of a destination
+ *
+ * @param  peer 	destination identifier
+ * @return      	link state
+ */
+const LinkState &ORF24LinkAdapter::getState(int peer)
+{
+	return link(peer);
+}
+
+/**
+ * Get profile applied on the peer side
+ *
+ * @return  profile index
+ */
+int ORF24LinkAdapter::getLocalProfile(void)
+{
+	return localProfile;
+}
\ No newline at end of file
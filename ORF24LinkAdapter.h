@@ -0,0 +1,337 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_LINK_ADAPTER_H_
+#define _ORF_24_LINK_ADAPTER_H_
+
+#include <map>
+#include <vector>
+#include "ORF24.h"
+
+#define 	LINK_SWITCH_COMMAND		0xF0
+
+/**
+ * Radio settings used on a link
+ */
+struct LinkProfile
+{
+	DataRate rate;					/* Air data rate */
+	RFPower power;					/* Lowest power level to step down to */
+	CRCLength crc;					/* CRC length */
+	int retryCount;					/* Retransmission count */
+};
+
+/**
+ * Link state of one destination
+ */
+struct LinkState
+{
+	int profile = 0;				/* Index of current profile */
+	int power = RF_PA_MAX;			/* Current power level */
+	int previousProfile = -1;		/* Profile before an upward probe */
+	int previousPower = -1;			/* Power level before an upward probe */
+	double previousGoodput = 0;		/* Goodput measured before an upward probe */
+	double goodput = 0;				/* Goodput of last window in bit/s */
+	int hold;						/* Clean windows required before stepping up */
+	int ceiling = -1;				/* Profile of the last failed upward probe */
+	int cleanWindows = 0;			/* Consecutive clean windows */
+	int failStreak = 0;				/* Consecutive MAX_RT */
+	int packets = 0;				/* Packets in current window */
+	int retransmissions = 0;		/* Retransmissions in current window */
+	int lost = 0;					/* MAX_RT in current window */
+	int pendingProfile = -1;		/* Profile waiting for peer confirmation */
+	int pendingPower = -1;			/* Power level waiting for peer confirmation */
+	unsigned long switches = 0;		/* Number of committed switches */
+};
+
+/**
+ * Link adaptation controller
+ *
+ * Watches ARC_CNT and MAX_RT of each destination over a window of packets
+ * and steps through a ladder of profiles, ordered from most robust to
+ * fastest. A degraded window first restores full power, then steps down.
+ * Clean windows step power down to the profile's level, or up to a faster
+ * profile. A probe to a profile that gave less goodput than the one below
+ * it, or broke the link, waits a hold time that doubles on every failure.
+ *
+ * Data rate and CRC must match on both ends, so a change is first sent to
+ * the peer on the current settings and only applied once it is
+ * acknowledged. After repeated MAX_RT the gateway falls back to the first
+ * profile; peers do the same when they hear nothing for a while. Both ends
+ * must use the same ladder.
+ *
+ * Profiles the radio cannot run, such as 250 kbps on a nRF24L01, are
+ * skipped.
+ */
+class ORF24LinkAdapter
+{
+private:
+	const LinkProfile *profiles;	/* Profile ladder */
+	int profileCount;				/* Number of profiles */
+	int payloadSize;				/* Payload size used for air time */
+	int window = 32;				/* Packets per evaluation window */
+	int baseHold = 2;				/* Initial clean windows before stepping up */
+	int maxHold = 64;				/* Longest hold after failed probes */
+	double maxLoss = 0.1;			/* Loss ratio of a degraded window */
+	double maxRetries = 3.0;		/* Mean retransmissions of a degraded window */
+	double cleanRetries = 0.5;		/* Mean retransmissions of a clean window */
+	int fallbackFailures = 3;		/* Consecutive MAX_RT before falling back */
+	std::map<int, LinkState> links;	/* Link state per destination */
+	std::vector<bool> usable;		/* Whether the radio can run each profile */
+	int localProfile = 0;			/* Profile applied on the peer side */
+	unsigned int silenceTimeout = 2000;	/* Peer side silence before falling back in milliseconds */
+	unsigned int lastHeard = 0;		/* Time of last payload on the peer side in milliseconds */
+
+protected:
+
+	/**
+	 * Get link state, creating it on first use
+	 *
+	 * @param  peer 	destination identifier
+	 * @return      	link state
+	 */
+	LinkState &link(int peer);
+
+	/**
+	 * Find the nearest usable profile in a direction
+	 *
+	 * @param  profile 		profile to start from, excluded
+	 * @param  direction 	1 for faster, -1 for more robust
+	 * @return           	profile index, -1 if there is none
+	 */
+	int step(int profile, int direction);
+
+	/**
+	 * Get the most robust usable profile
+	 *
+	 * @return  profile index, -1 if no profile is usable
+	 */
+	int robust(void);
+
+	/**
+	 * Estimate goodput of a window
+	 *
+	 * @param  state 	link state
+	 * @return       	goodput in bit/s
+	 */
+	double estimateGoodput(const LinkState &state);
+
+	/**
+	 * Evaluate a finished window
+	 *
+	 * @param  state 	link state
+	 */
+	void evaluate(LinkState &state);
+
+	/**
+	 * Request a profile and power change
+	 *
+	 * @param  state 	link state
+	 * @param  profile 	new profile index
+	 * @param  power 	new power level
+	 */
+	void request(LinkState &state, int profile, int power);
+
+public:
+
+	/**
+	 * ORF24LinkAdapter Constructor with default profile ladder
+	 *
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24LinkAdapter(int _payloadSize = 32);
+
+	/**
+	 * Set profile ladder
+	 *
+	 * @param _profiles 	profiles from most robust to fastest
+	 * @param count 		number of profiles
+	 */
+	void setProfiles(const LinkProfile *_profiles, int count);
+
+	/**
+	 * Set evaluation window and hysteresis
+	 *
+	 * @param packets 	packets per window
+	 * @param hold 		clean windows before stepping up
+	 * @param _maxHold 	longest hold after failed probes
+	 */
+	void setWindow(int packets, int hold, int _maxHold);
+
+	/**
+	 * Set thresholds of degraded and clean windows
+	 *
+	 * @param loss 			loss ratio of a degraded window
+	 * @param retries 		mean retransmissions of a degraded window
+	 * @param clean 		mean retransmissions of a clean window
+	 */
+	void setThresholds(double loss, double retries, double clean);
+
+	/**
+	 * Skip profiles the radio cannot run
+	 *
+	 * @param radio 	radio
+	 */
+	void skipUnsupported(ORF24 &radio);
+
+	/**
+	 * Set how long a peer waits for a payload before falling back
+	 *
+	 * @param timeout 	silence in milliseconds
+	 */
+	void setSilenceTimeout(unsigned int timeout);
+
+	/**
+	 * Record result of one transmission
+	 *
+	 * @param  peer 		destination identifier
+	 * @param  observeTX 	OBSERVE_TX value after the transmission
+	 * @param  delivered 	whether TX_DS was set
+	 * @return           	true if settings changed or a change is pending
+	 */
+	bool record(int peer, unsigned char observeTX, bool delivered);
+
+	/**
+	 * Check whether a change is waiting for the peer
+	 *
+	 * @param  peer 	destination identifier
+	 * @return      	true if a change is pending
+	 */
+	bool hasPendingSwitch(int peer);
+
+	/**
+	 * Build switch command for the peer
+	 *
+	 * @param  peer 	destination identifier
+	 * @param  buf 		payload buffer of at least 3 bytes
+	 * @return      	command length
+	 */
+	int buildSwitch(int peer, unsigned char *buf);
+
+	/**
+	 * Commit pending change after the peer acknowledged it
+	 *
+	 * @param  peer 	destination identifier
+	 */
+	void commitSwitch(int peer);
+
+	/**
+	 * Drop pending change after the peer missed it
+	 *
+	 * @param  peer 	destination identifier
+	 */
+	void cancelSwitch(int peer);
+
+	/**
+	 * Parse switch command on the peer side
+	 *
+	 * @param  buf 			received payload
+	 * @param  len 			payload length
+	 * @param  profile 		received profile index
+	 * @param  power 		received power level
+	 * @return         		true if payload is a valid switch command
+	 */
+	bool acceptSwitch(const unsigned char *buf, int len, int *profile, int *power);
+
+	/**
+	 * Handle a received payload on the peer side
+	 *
+	 * Any payload restarts the silence timer, a switch command is applied
+	 * to the radio.
+	 *
+	 * @param  radio 	radio
+	 * @param  buf 		received payload
+	 * @param  len 		payload length
+	 * @return     		true if payload was a switch command
+	 */
+	bool receive(ORF24 &radio, const unsigned char *buf, int len);
+
+	/**
+	 * Fall back to the most robust profile after silence on the peer side
+	 *
+	 * @param  radio 	radio
+	 * @return       	true if settings changed
+	 */
+	bool service(ORF24 &radio);
+
+	/**
+	 * Apply settings of a destination to the radio
+	 *
+	 * A profile the radio rejects is skipped from then on and the link
+	 * moves to the most robust usable profile.
+	 *
+	 * @param  radio 	radio
+	 * @param  peer 	destination identifier
+	 * @return       	false if no usable profile was applied
+	 */
+	bool apply(ORF24 &radio, int peer);
+
+	/**
+	 * Apply a profile and power level to the radio
+	 *
+	 * @param  radio 	radio
+	 * @param  profile 	profile index
+	 * @param  power 	power level
+	 * @return       	false if the radio can not run the profile
+	 */
+	bool apply(ORF24 &radio, int profile, int power);
+
+	/**
+	 * Write payload, record the result and run a pending switch
+	 *
+	 * The writing pipe of the peer must be open and its settings applied.
+	 *
+	 * @param  radio 	radio
+	 * @param  peer 	destination identifier
+	 * @param  data 	data to write
+	 * @param  len 		data length
+	 * @return       	status
+	 */
+	bool write(ORF24 &radio, int peer, unsigned char *data, int len);
+
+	/**
+	 * Get current profile of a destination
+	 *
+	 * @param  peer 	destination identifier
+	 * @return      	profile
+	 */
+	const LinkProfile &getProfile(int peer);
+
+	/**
+	 * Get link state of a destination
+	 *
+	 * @param  peer 	destination identifier
+	 * @return      	link state
+	 */
+	const LinkState &getState(int peer);
+
+	/**
+	 * Get profile applied on the peer side
+	 *
+	 * @return  profile index
+	 */
+	int getLocalProfile(void);
+};
+
+#endif
\ No newline at end of file
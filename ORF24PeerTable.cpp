@@ -0,0 +1,222 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24PeerTable.h"
+
+ORF24PeerTable::ORF24PeerTable(ORF24 &_radio)
+	: radio(_radio)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		pipePeer[i] = -1;
+		lastUsed[i] = 0;
+	}
+}
+
+/**
+ * Register a peer
+ *
+ * @param  address 	peer address, 5 bytes
+ * @return         	peer identifier
+ */
+int ORF24PeerTable::addPeer(const char *address)
+{
+	Peer peer;
+
+	std::memcpy(peer.address, address, sizeof(peer.address));
+	peer.pipe = -1;
+
+	peers.push_back(peer);
+
+	return peers.size() - 1;
+}
+
+/**
+ * Check whether a peer shares the address prefix of pipe 1
+ *
+ * openReadingPipe writes the address reversed, so the last character is
+ * the LSB and the first four are the shared prefix.
+ *
+ * @param  peer 	peer identifier
+ * @return      	true if prefix matches
+ */
+bool ORF24PeerTable::samePrefix(int peer)
+{
+	if (pipePeer[1] < 0)
+	{
+		return false;
+	}
+
+	return std::memcmp(peers[peer].address, peers[pipePeer[1]].address, 4) == 0;
+}
+
+/**
+ * Bind a peer to a pipe
+ *
+ * @param  peer 	peer identifier
+ * @param  pipe 	pipe number
+ */
+void ORF24PeerTable::assign(int peer, int pipe)
+{
+	if (pipePeer[pipe] >= 0)
+	{
+		peers[pipePeer[pipe]].pipe = -1;
+	}
+
+	radio.openReadingPipe(pipe, peers[peer].address);
+
+	pipePeer[pipe] = peer;
+	peers[peer].pipe = pipe;
+	lastUsed[pipe] = ++clock;
+}
+
+/**
+ * Unbind a pipe
+ *
+ * @param  pipe 	pipe number
+ */
+void ORF24PeerTable::release(int pipe)
+{
+	if (pipePeer[pipe] >= 0)
+	{
+		peers[pipePeer[pipe]].pipe = -1;
+		pipePeer[pipe] = -1;
+	}
+
+	radio.closeReadingPipe(pipe);
+}
+
+/**
+ * Make sure a peer has a reading pipe
+ *
+ * @param  peer 	peer identifier
+ * @return      	pipe number, -1 if peer is unknown
+ */
+int ORF24PeerTable::bind(int peer)
+{
+	if (peer < 0 || peer >= (int) peers.size())
+	{
+		return -1;
+	}
+
+	if (peers[peer].pipe >= 0)
+	{
+		hits++;
+		lastUsed[peers[peer].pipe] = ++clock;
+
+		return peers[peer].pipe;
+	}
+
+	if (samePrefix(peer))
+	{
+		/* Least recently used of pipe 2 to 5, free pipes first */
+		int victim = 2;
+
+		for (int pipe = 2; pipe < 6; pipe++)
+		{
+			if (pipePeer[pipe] < 0)
+			{
+				victim = pipe;
+				break;
+			}
+
+			if (lastUsed[pipe] < lastUsed[victim])
+			{
+				victim = pipe;
+			}
+		}
+
+		lsbWrites++;
+		assign(peer, victim);
+
+		return victim;
+	}
+
+	/* New prefix, pipe 2 to 5 would now listen on unrelated addresses */
+	for (int pipe = 2; pipe < 6; pipe++)
+	{
+		if (pipePeer[pipe] >= 0)
+		{
+			release(pipe);
+		}
+	}
+
+	fullWrites++;
+	assign(peer, 1);
+
+	return 1;
+}
+
+/**
+ * Get peer bound to a pipe
+ *
+ * @param  pipe 	pipe number
+ * @return      	peer identifier, -1 if none
+ */
+int ORF24PeerTable::lookup(int pipe)
+{
+	return pipe >= 0 && pipe < 6 ? pipePeer[pipe] : -1;
+}
+
+/**
+ * Get peer address
+ *
+ * @param  peer 	peer identifier
+ * @return      	peer address, 5 bytes
+ */
+const char *ORF24PeerTable::getAddress(int peer)
+{
+	return peers[peer].address;
+}
+
+/**
+ * Get binds served without register writes
+ *
+ * @return  hits
+ */
+unsigned long ORF24PeerTable::getHits(void)
+{
+	return hits;
+}
+
+/**
+ * Get binds served with a one byte LSB write
+ *
+ * @return  LSB writes
+ */
+unsigned long ORF24PeerTable::getLSBWrites(void)
+{
+	return lsbWrites;
+}
+
+/**
+ * Get binds that rewrote the full pipe 1 address
+ *
+ * @return  full address writes
+ */
+unsigned long ORF24PeerTable::getFullWrites(void)
+{
+	return fullWrites;
+}
\ No newline at end of file
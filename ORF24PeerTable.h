@@ -0,0 +1,146 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_PEER_TABLE_H_
+#define _ORF_24_PEER_TABLE_H_
+
+#include <vector>
+#include "ORF24.h"
+
+/**
+ * Peer table over the reading pipes
+ *
+ * Maps any number of peers onto pipes 1 to 5, evicting the least recently
+ * used one. Pipes 2 to 5 share the upper four address bytes of pipe 1, so
+ * a peer with the current prefix costs a single LSB byte write on those
+ * pipes. A peer with another prefix takes pipe 1, which unbinds pipes 2
+ * to 5. Pipe 0 is left to openWritingPipe for auto acknowledgment.
+ */
+class ORF24PeerTable
+{
+private:
+	struct Peer
+	{
+		char address[5];			/* Peer address */
+		int pipe;					/* Bound pipe, -1 if none */
+	};
+
+	ORF24 &radio;					/* Radio to bind pipes on */
+	std::vector<Peer> peers;		/* Registered peers */
+	int pipePeer[6];				/* Peer bound to each pipe, -1 if none */
+	unsigned long lastUsed[6];		/* Use stamp of each pipe */
+	unsigned long clock = 0;		/* Use stamp counter */
+	unsigned long hits = 0;			/* Binds served without register writes */
+	unsigned long lsbWrites = 0;	/* Binds served with a one byte write */
+	unsigned long fullWrites = 0;	/* Binds that rewrote pipe 1 */
+
+protected:
+
+	/**
+	 * Check whether a peer shares the address prefix of pipe 1
+	 *
+	 * @param  peer 	peer identifier
+	 * @return      	true if prefix matches
+	 */
+	bool samePrefix(int peer);
+
+	/**
+	 * Bind a peer to a pipe
+	 *
+	 * @param  peer 	peer identifier
+	 * @param  pipe 	pipe number
+	 */
+	void assign(int peer, int pipe);
+
+	/**
+	 * Unbind a pipe
+	 *
+	 * @param  pipe 	pipe number
+	 */
+	void release(int pipe);
+
+public:
+
+	/**
+	 * ORF24PeerTable Constructor
+	 *
+	 * @param _radio 	radio to bind pipes on
+	 */
+	ORF24PeerTable(ORF24 &_radio);
+
+	/**
+	 * Register a peer
+	 *
+	 * @param  address 	peer address, 5 bytes
+	 * @return         	peer identifier
+	 */
+	int addPeer(const char *address);
+
+	/**
+	 * Make sure a peer has a reading pipe
+	 *
+	 * @param  peer 	peer identifier
+	 * @return      	pipe number, -1 if peer is unknown
+	 */
+	int bind(int peer);
+
+	/**
+	 * Get peer bound to a pipe
+	 *
+	 * @param  pipe 	pipe number
+	 * @return      	peer identifier, -1 if none
+	 */
+	int lookup(int pipe);
+
+	/**
+	 * Get peer address
+	 *
+	 * @param  peer 	peer identifier
+	 * @return      	peer address, 5 bytes
+	 */
+	const char *getAddress(int peer);
+
+	/**
+	 * Get binds served without register writes
+	 *
+	 * @return  hits
+	 */
+	unsigned long getHits(void);
+
+	/**
+	 * Get binds served with a one byte LSB write
+	 *
+	 * @return  LSB writes
+	 */
+	unsigned long getLSBWrites(void);
+
+	/**
+	 * Get binds that rewrote the full pipe 1 address
+	 *
+	 * @return  full address writes
+	 */
+	unsigned long getFullWrites(void);
+};
+
+#endif
\ No newline at end of file
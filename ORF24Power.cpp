@@ -0,0 +1,385 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include "ORF24Power.h"
+
+/* Typical nRF24L01+ supply current in microamperes */
+static const double powerDownCurrent = 0.9;
+static const double standbyCurrent = 26;
+static const double txCurrent[] = { 7000, 7500, 9000, 11300 };	/* -18, -12, -6, 0 dBm */
+static const double rxCurrent[] = { 13100, 13500, 12600 };		/* 1 Mbps, 2 Mbps, 250 kbps */
+
+/* Crystal start up from power down, 400 uA for 1.5 ms */
+static const double startupCharge = 400.0 * 1500;
+
+ORF24Power::ORF24Power(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize)
+{
+	nextWake = radio.getTransport()->micros() + interval;
+}
+
+/**
+ * Set wake interval and listen time directly
+ *
+ * @param intervalUs 	time between windows in microseconds
+ * @param listenUs   	listen time per window in microseconds, 0 to only send
+ */
+void ORF24Power::setWakeWindow(unsigned int intervalUs, unsigned int listenUs)
+{
+	nextWake += intervalUs - interval;
+	interval = intervalUs;
+	listenTime = listenUs;
+}
+
+/**
+ * Set interval range of the trade-off knob
+ *
+ * @param minIntervalUs 	interval at trade-off 0
+ * @param maxIntervalUs 	interval at trade-off 1
+ */
+void ORF24Power::setTradeoffRange(unsigned int minIntervalUs, unsigned int maxIntervalUs)
+{
+	minInterval = minIntervalUs;
+	maxInterval = maxIntervalUs;
+}
+
+/**
+ * Set energy and throughput trade-off
+ *
+ * @param energy 	0 for lowest latency, 1 for lowest energy
+ */
+void ORF24Power::setTradeoff(double energy)
+{
+	energy = energy < 0 ? 0 : energy > 1 ? 1 : energy;
+
+	double range = (double) maxInterval / minInterval;
+
+	setWakeWindow(minInterval * std::pow(range, energy), listenTime);
+
+	wakeThreshold = 1 + (int) ((POWER_QUEUE_SIZE - 1) * energy + 0.5);
+}
+
+/**
+ * Queue a packet for the next window
+ *
+ * @param  data 	packet
+ * @param  len  	packet length, at most payload size
+ * @return      	false if packet is too long or queue is full
+ */
+bool ORF24Power::send(const unsigned char *data, int len)
+{
+	if (len < 0 || len > payloadSize || txCount == POWER_QUEUE_SIZE)
+	{
+		return false;
+	}
+
+	int slot = (txHead + txCount) % POWER_QUEUE_SIZE;
+
+	std::memcpy(txQueue[slot], data, len);
+	std::memset(txQueue[slot] + len, 0, payloadSize - len);
+	txLengths[slot] = len;
+	txCount++;
+
+	return true;
+}
+
+/**
+ * Take a packet received in a window
+ *
+ * @param  data 	set to packet, payload size bytes
+ * @return      	false if no packet was received
+ */
+bool ORF24Power::receive(unsigned char *data)
+{
+	if (rxCount == 0)
+	{
+		return false;
+	}
+
+	std::memcpy(data, rxQueue[rxHead], payloadSize);
+	rxHead = (rxHead + 1) % POWER_QUEUE_SIZE;
+	rxCount--;
+
+	return true;
+}
+
+/**
+ * Open a window and start sending queued packets
+ *
+ * @param now 	current time in microseconds
+ */
+void ORF24Power::wake(unsigned int now)
+{
+	wakeups++;
+	awake = true;
+	nextWake = now + interval;
+
+	if (txCount > 0)
+	{
+		radio.startWrite(txQueue[txHead], payloadSize);
+		sending = true;
+	}
+	else
+	{
+		listen();
+	}
+}
+
+/**
+ * Start the listen time of the window, or close it if there is none
+ */
+void ORF24Power::listen(void)
+{
+	if (listenTime == 0)
+	{
+		sleep();
+		return;
+	}
+
+	radio.startListening();
+	listenUntil = radio.getTransport()->micros() + listenTime;
+}
+
+/**
+ * Close the window and power down
+ */
+void ORF24Power::sleep(void)
+{
+	if (radio.getPowerState() == POWER_RX)
+	{
+		radio.stopListening();
+	}
+
+	radio.powerDown();
+	awake = false;
+}
+
+/**
+ * Open and close windows, call frequently
+ */
+void ORF24Power::service(void)
+{
+	unsigned int now = radio.getTransport()->micros();
+
+	if (sending)
+	{
+		bool delivered;
+
+		if (!radio.pollWrite(&delivered))
+		{
+			return;
+		}
+
+		messages++;
+
+		if (!delivered)
+		{
+			failed++;
+		}
+
+		txHead = (txHead + 1) % POWER_QUEUE_SIZE;
+		txCount--;
+
+		/* Back to back, the chip stays in standby between packets */
+		if (txCount > 0)
+		{
+			radio.startWrite(txQueue[txHead], payloadSize);
+			return;
+		}
+
+		sending = false;
+		listen();
+
+		return;
+	}
+
+	if (awake)
+	{
+		/* At most a full RX FIFO per call */
+		for (int i = 0; i < 3 && radio.available(); i++)
+		{
+			if (rxCount == POWER_QUEUE_SIZE)
+			{
+				unsigned char discard[32];
+
+				radio.read(discard, payloadSize);
+				overflows++;
+				continue;
+			}
+
+			radio.read(rxQueue[(rxHead + rxCount) % POWER_QUEUE_SIZE], payloadSize);
+			rxCount++;
+			received++;
+		}
+
+		if ((int) (now - listenUntil) >= 0)
+		{
+			sleep();
+		}
+
+		return;
+	}
+
+	if (txCount > 0 && txCount >= wakeThreshold)
+	{
+		earlyWakeups++;
+		wake(now);
+	}
+	else if ((int) (now - nextWake) >= 0)
+	{
+		if (txCount > 0 || listenTime > 0)
+		{
+			wake(now);
+		}
+		else
+		{
+			nextWake = now + interval;
+		}
+	}
+}
+
+/**
+ * Get estimated charge drawn by the radio since initialization
+ *
+ * @return  charge in mAh
+ */
+double ORF24Power::getCharge(void)
+{
+	double charge = radio.getPowerStateTime(POWER_DOWN) * powerDownCurrent +
+		radio.getPowerStateTime(POWER_STANDBY) * standbyCurrent +
+		radio.getPowerStateTime(POWER_RX) * rxCurrent[radio.getDataRate()] +
+		wakeups * startupCharge;
+
+	for (int level = RF_PA_MIN; level <= RF_PA_MAX; level++)
+	{
+		charge += radio.getTXTime((RFPower) level) * txCurrent[level];
+	}
+
+	/* Microampere microseconds to milliampere hours */
+	return charge / 3.6e12;
+}
+
+/**
+ * Get mean radio current since initialization
+ *
+ * @return  current in mA
+ */
+double ORF24Power::getAverageCurrent(void)
+{
+	double total = 0;
+
+	for (int state = POWER_DOWN; state <= POWER_RX; state++)
+	{
+		total += radio.getPowerStateTime((PowerState) state);
+	}
+
+	return total > 0 ? getCharge() / (total / 3.6e9) : 0;
+}
+
+/**
+ * Project battery life at the mean current so far
+ *
+ * @param  capacity 	battery capacity in mAh
+ * @param  baseCurrent 	current of the rest of the node in mA
+ * @return          	battery life in hours
+ */
+double ORF24Power::projectLifetime(double capacity, double baseCurrent)
+{
+	double current = getAverageCurrent() + baseCurrent;
+
+	return current > 0 ? capacity / current : 0;
+}
+
+/**
+ * Get number of windows opened
+ *
+ * @return  wakeups
+ */
+unsigned long ORF24Power::getWakeups(void)
+{
+	return wakeups;
+}
+
+/**
+ * Get number of windows forced by a full queue
+ *
+ * @return  early wakeups
+ */
+unsigned long ORF24Power::getEarlyWakeups(void)
+{
+	return earlyWakeups;
+}
+
+/**
+ * Get number of packets sent
+ *
+ * @return  packets
+ */
+unsigned long ORF24Power::getMessages(void)
+{
+	return messages;
+}
+
+/**
+ * Get mean number of windows per packet sent
+ *
+ * @return  wakeups per message
+ */
+double ORF24Power::getWakeupsPerMessage(void)
+{
+	return messages ? (double) wakeups / messages : 0;
+}
+
+/**
+ * Get number of packets not acknowledged
+ *
+ * @return  failed packets
+ */
+unsigned long ORF24Power::getFailed(void)
+{
+	return failed;
+}
+
+/**
+ * Get number of packets received
+ *
+ * @return  received packets
+ */
+unsigned long ORF24Power::getReceived(void)
+{
+	return received;
+}
+
+/**
+ * Get number of received packets dropped on a full queue
+ *
+ * @return  dropped packets
+ */
+unsigned long ORF24Power::getOverflows(void)
+{
+	return overflows;
+}
\ No newline at end of file
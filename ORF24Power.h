@@ -0,0 +1,222 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_POWER_H_
+#define _ORF_24_POWER_H_
+
+#include "ORF24.h"
+
+#define		POWER_QUEUE_SIZE	16
+
+/**
+ * Duty cycled operation for battery nodes
+ *
+ * The radio stays in power down between wake windows. A window sends every
+ * queued packet back to back, listens for the listen time, then powers the
+ * radio down until the next window. A window is skipped if there is nothing
+ * to send and no listen time.
+ *
+ * The trade-off knob picks the wake interval between a shortest and longest
+ * interval on a log scale, and how full the transmit queue may get before it
+ * forces an early window. At 0 every message is sent at once, at 1 messages
+ * wait for the longest interval or a full queue.
+ *
+ * Charge is estimated from the time the radio spent in each mode, the
+ * typical nRF24L01+ currents of the datasheet and the crystal start up of
+ * each window.
+ */
+class ORF24Power
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	int payloadSize;				/* Payload size in bytes */
+	unsigned char txQueue[POWER_QUEUE_SIZE][32];	/* Packets waiting for a window */
+	int txLengths[POWER_QUEUE_SIZE];	/* Length of queued packets */
+	int txHead = 0;					/* Oldest queued packet */
+	int txCount = 0;				/* Queued packets */
+	unsigned char rxQueue[POWER_QUEUE_SIZE][32];	/* Packets received in windows */
+	int rxHead = 0;					/* Oldest received packet */
+	int rxCount = 0;				/* Received packets */
+	unsigned int interval = 1000000;	/* Time between windows in microseconds */
+	unsigned int listenTime = 5000;	/* Listen time per window in microseconds */
+	unsigned int minInterval = 10000;	/* Interval at trade-off 0 */
+	unsigned int maxInterval = 60000000;	/* Interval at trade-off 1 */
+	int wakeThreshold = POWER_QUEUE_SIZE;	/* Queued packets forcing a window */
+	unsigned int nextWake;			/* Start of next window */
+	unsigned int listenUntil = 0;	/* End of listen time */
+	bool awake = false;				/* Whether a window is open */
+	bool sending = false;			/* Whether a queued packet is in flight */
+	unsigned long wakeups = 0;		/* Windows opened */
+	unsigned long earlyWakeups = 0;	/* Windows forced by the queue */
+	unsigned long messages = 0;		/* Packets sent */
+	unsigned long failed = 0;		/* Packets not acknowledged */
+	unsigned long received = 0;		/* Packets received */
+	unsigned long overflows = 0;	/* Received packets dropped on a full queue */
+
+	/**
+	 * Open a window and start sending queued packets
+	 *
+	 * @param now 	current time in microseconds
+	 */
+	void wake(unsigned int now);
+
+	/**
+	 * Start the listen time of the window, or close it if there is none
+	 */
+	void listen(void);
+
+	/**
+	 * Close the window and power down
+	 */
+	void sleep(void);
+
+public:
+
+	/**
+	 * ORF24Power Constructor
+	 *
+	 * @param _radio 		radio to send with
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24Power(ORF24 &_radio, int _payloadSize = 32);
+
+	/**
+	 * Set wake interval and listen time directly
+	 *
+	 * @param intervalUs 	time between windows in microseconds
+	 * @param listenUs   	listen time per window in microseconds, 0 to only send
+	 */
+	void setWakeWindow(unsigned int intervalUs, unsigned int listenUs);
+
+	/**
+	 * Set interval range of the trade-off knob
+	 *
+	 * @param minIntervalUs 	interval at trade-off 0
+	 * @param maxIntervalUs 	interval at trade-off 1
+	 */
+	void setTradeoffRange(unsigned int minIntervalUs, unsigned int maxIntervalUs);
+
+	/**
+	 * Set energy and throughput trade-off
+	 *
+	 * @param energy 	0 for lowest latency, 1 for lowest energy
+	 */
+	void setTradeoff(double energy);
+
+	/**
+	 * Queue a packet for the next window
+	 *
+	 * @param  data 	packet
+	 * @param  len  	packet length, at most payload size
+	 * @return      	false if packet is too long or queue is full
+	 */
+	bool send(const unsigned char *data, int len);
+
+	/**
+	 * Take a packet received in a window
+	 *
+	 * @param  data 	set to packet, payload size bytes
+	 * @return      	false if no packet was received
+	 */
+	bool receive(unsigned char *data);
+
+	/**
+	 * Open and close windows, call frequently
+	 */
+	void service(void);
+
+	/**
+	 * Get estimated charge drawn by the radio since initialization
+	 *
+	 * @return  charge in mAh
+	 */
+	double getCharge(void);
+
+	/**
+	 * Get mean radio current since initialization
+	 *
+	 * @return  current in mA
+	 */
+	double getAverageCurrent(void);
+
+	/**
+	 * Project battery life at the mean current so far
+	 *
+	 * @param  capacity 	battery capacity in mAh
+	 * @param  baseCurrent 	current of the rest of the node in mA
+	 * @return          	battery life in hours
+	 */
+	double projectLifetime(double capacity, double baseCurrent = 0);
+
+	/**
+	 * Get number of windows opened
+	 *
+	 * @return  wakeups
+	 */
+	unsigned long getWakeups(void);
+
+	/**
+	 * Get number of windows forced by a full queue
+	 *
+	 * @return  early wakeups
+	 */
+	unsigned long getEarlyWakeups(void);
+
+	/**
+	 * Get number of packets sent
+	 *
+	 * @return  packets
+	 */
+	unsigned long getMessages(void);
+
+	/**
+	 * Get mean number of windows per packet sent
+	 *
+	 * @return  wakeups per message
+	 */
+	double getWakeupsPerMessage(void);
+
+	/**
+	 * Get number of packets not acknowledged
+	 *
+	 * @return  failed packets
+	 */
+	unsigned long getFailed(void);
+
+	/**
+	 * Get number of packets received
+	 *
+	 * @return  received packets
+	 */
+	unsigned long getReceived(void);
+
+	/**
+	 * Get number of received packets dropped on a full queue
+	 *
+	 * @return  dropped packets
+	 */
+	unsigned long getOverflows(void);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,283 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24RPC.h"
+
+ORF24RPC::ORF24RPC(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize)
+{ }
+
+/**
+ * Send request and wait for its response
+ *
+ * @param  request     	request data
+ * @param  len         	request length, at most payload size - 1
+ * @param  response    	response buffer, payload size - 1 bytes
+ * @param  timeoutUs   	time to wait for the response in microseconds
+ * @return             	false if request was not acknowledged or timed out
+ */
+bool ORF24RPC::call(const unsigned char *request, int len, unsigned char *response, unsigned long timeoutUs)
+{
+	if (len < 0 || len > payloadSize - 1)
+	{
+		return false;
+	}
+
+	ORF24Transport *transport = radio.getTransport();
+	unsigned char payload[32];
+
+	payload[0] = ++sequence;
+	std::memcpy(payload + 1, request, len);
+	std::memset(payload + 1 + len, 0, payloadSize - 1 - len);
+
+	unsigned int startedAt = transport->micros();
+
+	if (!radio.writeAndListen(payload, payloadSize))
+	{
+		failures++;
+		return false;
+	}
+
+	while (transport->micros() - startedAt < timeoutUs)
+	{
+		int pipe;
+
+		if (!radio.available(&pipe))
+		{
+			continue;
+		}
+
+		radio.read(payload, payloadSize);
+
+		/* Other traffic, keep it for the application */
+		if (pipe != 0)
+		{
+			hold(payload, pipe);
+			continue;
+		}
+
+		/* Response to an earlier call that timed out */
+		if (payload[0] != sequence)
+		{
+			continue;
+		}
+
+		lastRTT = transport->micros() - startedAt;
+		std::memcpy(response, payload + 1, payloadSize - 1);
+
+		if (calls == 0 || lastRTT < minRTT)
+		{
+			minRTT = lastRTT;
+		}
+
+		if (lastRTT > maxRTT)
+		{
+			maxRTT = lastRTT;
+		}
+
+		totalRTT += lastRTT;
+		calls++;
+
+		return true;
+	}
+
+	timeouts++;
+
+	return false;
+}
+
+/**
+ * Answer a received request
+ *
+ * @param  address 	own address the request was received on
+ * @param  request 	received request payload, ID included
+ * @param  data    	response data
+ * @param  len     	response length, at most payload size - 1
+ * @return         	true if the response was acknowledged
+ */
+bool ORF24RPC::respond(const char *address, const unsigned char *request, const unsigned char *data, int len)
+{
+	if (len < 0 || len > payloadSize - 1)
+	{
+		return false;
+	}
+
+	unsigned char payload[32];
+	bool delivered;
+
+	payload[0] = request[0];
+	std::memcpy(payload + 1, data, len);
+	std::memset(payload + 1 + len, 0, payloadSize - 1 - len);
+
+	radio.stopListening();
+	radio.openWritingPipe(address);
+	radio.startWrite(payload, payloadSize);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	radio.startListening();
+
+	return delivered;
+}
+
+/**
+ * Keep a payload of another pipe for read()
+ *
+ * @param  data 	payload
+ * @param  pipe 	receiving pipe
+ */
+void ORF24RPC::hold(const unsigned char *data, int pipe)
+{
+	if (heldCount == RPC_HOLD_SIZE)
+	{
+		dropped++;
+		return;
+	}
+
+	int slot = (heldHead + heldCount) % RPC_HOLD_SIZE;
+
+	std::memcpy(held[slot], data, payloadSize);
+	heldPipe[slot] = pipe;
+	heldCount++;
+}
+
+/**
+ * Check for a payload, held ones first
+ *
+ * @param  pipe 	set to receiving pipe
+ * @return      	true if a payload is available
+ */
+bool ORF24RPC::available(int *pipe)
+{
+	if (heldCount > 0)
+	{
+		*pipe = heldPipe[heldHead];
+		return true;
+	}
+
+	return radio.available(pipe);
+}
+
+/**
+ * Read the payload reported by available()
+ *
+ * @param  data 	data buffer, payload size bytes
+ */
+void ORF24RPC::read(unsigned char *data)
+{
+	if (heldCount > 0)
+	{
+		std::memcpy(data, held[heldHead], payloadSize);
+
+		heldHead = (heldHead + 1) % RPC_HOLD_SIZE;
+		heldCount--;
+
+		return;
+	}
+
+	radio.read(data, payloadSize);
+}
+
+/**
+ * Get round trip time of last answered call
+ *
+ * @return  round trip time in microseconds
+ */
+unsigned long ORF24RPC::getLastRTT(void)
+{
+	return lastRTT;
+}
+
+/**
+ * Get shortest round trip time
+ *
+ * @return  round trip time in microseconds
+ */
+unsigned long ORF24RPC::getMinRTT(void)
+{
+	return minRTT;
+}
+
+/**
+ * Get longest round trip time
+ *
+ * @return  round trip time in microseconds
+ */
+unsigned long ORF24RPC::getMaxRTT(void)
+{
+	return maxRTT;
+}
+
+/**
+ * Get mean round trip time
+ *
+ * @return  round trip time in microseconds
+ */
+double ORF24RPC::getMeanRTT(void)
+{
+	return calls ? (double) totalRTT / calls : 0;
+}
+
+/**
+ * Get number of calls answered
+ *
+ * @return  calls
+ */
+unsigned long ORF24RPC::getCalls(void)
+{
+	return calls;
+}
+
+/**
+ * Get number of calls without response
+ *
+ * @return  timeouts
+ */
+unsigned long ORF24RPC::getTimeouts(void)
+{
+	return timeouts;
+}
+
+/**
+ * Get number of requests not acknowledged
+ *
+ * @return  failures
+ */
+unsigned long ORF24RPC::getFailures(void)
+{
+	return failures;
+}
+
+/**
+ * Get number of payloads dropped on a full hold queue
+ *
+ * @return  dropped payloads
+ */
+unsigned long ORF24RPC::getDropped(void)
+{
+	return dropped;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_RPC_H_
+#define _ORF_24_RPC_H_
+
+#include "ORF24.h"
+
+#define 	RPC_HOLD_SIZE		8
+
+/**
+ * Request and response transactions
+ *
+ * The caller sends a request to the writing pipe address and listens on
+ * the same address right after the ACK. The responder answers by writing
+ * to its own address. The first payload byte is a transaction ID echoed
+ * by the response, so late replies of earlier calls are dropped:
+ *
+ *     | id | data | padding |
+ *
+ * Responses arrive on pipe 0. Payloads on other pipes received while a
+ * call waits are held and returned by available() and read().
+ */
+class ORF24RPC
+{
+private:
+	ORF24 &radio;					/* Radio to send with */
+	int payloadSize;				/* Payload size in bytes */
+	unsigned char sequence = 0;		/* Last transaction ID */
+	unsigned long calls = 0;		/* Calls answered */
+	unsigned long timeouts = 0;		/* Calls without response */
+	unsigned long failures = 0;		/* Requests not acknowledged */
+	unsigned long lastRTT = 0;		/* Round trip time of last call in microseconds */
+	unsigned long minRTT = 0;		/* Shortest round trip time */
+	unsigned long maxRTT = 0;		/* Longest round trip time */
+	unsigned long long totalRTT = 0;	/* Sum of round trip times */
+	unsigned char held[RPC_HOLD_SIZE][32];	/* Payloads of other pipes received during a call */
+	int heldPipe[RPC_HOLD_SIZE];	/* Receiving pipe per held payload */
+	int heldHead = 0;				/* Oldest held payload */
+	int heldCount = 0;				/* Number of held payloads */
+	unsigned long dropped = 0;		/* Payloads of other pipes dropped on a full hold queue */
+
+protected:
+
+	/**
+	 * Keep a payload of another pipe for read()
+	 *
+	 * @param  data 	payload
+	 * @param  pipe 	receiving pipe
+	 */
+	void hold(const unsigned char *data, int pipe);
+
+public:
+
+	/**
+	 * ORF24RPC Constructor
+	 *
+	 * @param _radio 		radio to send with
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24RPC(ORF24 &_radio, int _payloadSize = 32);
+
+	/**
+	 * Send request and wait for its response
+	 *
+	 * The radio is left listening on the writing pipe address.
+	 *
+	 * @param  request     	request data
+	 * @param  len         	request length, at most payload size - 1
+	 * @param  response    	response buffer, payload size - 1 bytes
+	 * @param  timeoutUs   	time to wait for the response in microseconds
+	 * @return             	false if request was not acknowledged or timed out
+	 */
+	bool call(const unsigned char *request, int len, unsigned char *response, unsigned long timeoutUs);
+
+	/**
+	 * Answer a received request
+	 *
+	 * The radio is left listening afterwards.
+	 *
+	 * @param  address 	own address the request was received on
+	 * @param  request 	received request payload, ID included
+	 * @param  data    	response data
+	 * @param  len     	response length, at most payload size - 1
+	 * @return         	true if the response was acknowledged
+	 */
+	bool respond(const char *address, const unsigned char *request, const unsigned char *data, int len);
+
+	/**
+	 * Check for a payload, held ones first
+	 *
+	 * @param  pipe 	set to receiving pipe
+	 * @return      	true if a payload is available
+	 */
+	bool available(int *pipe);
+
+	/**
+	 * Read the payload reported by available()
+	 *
+	 * @param  data 	data buffer, payload size bytes
+	 */
+	void read(unsigned char *data);
+
+	/**
+	 * Get round trip time of last answered call
+	 *
+	 * @return  round trip time in microseconds
+	 */
+	unsigned long getLastRTT(void);
+
+	/**
+	 * Get shortest round trip time
+	 *
+	 * @return  round trip time in microseconds
+	 */
+	unsigned long getMinRTT(void);
+
+	/**
+	 * Get longest round trip time
+	 *
+	 * @return  round trip time in microseconds
+	 */
+	unsigned long getMaxRTT(void);
+
+	/**
+	 * Get mean round trip time
+	 *
+	 * @return  round trip time in microseconds
+	 */
+	double getMeanRTT(void);
+
+	/**
+	 * Get number of calls answered
+	 *
+	 * @return  calls
+	 */
+	unsigned long getCalls(void);
+
+	/**
+	 * Get number of calls without response
+	 *
+	 * @return  timeouts
+	 */
+	unsigned long getTimeouts(void);
+
+	/**
+	 * Get number of requests not acknowledged
+	 *
+	 * @return  failures
+	 */
+	unsigned long getFailures(void);
+
+	/**
+	 * Get number of payloads dropped on a full hold queue
+	 *
+	 * @return  dropped payloads
+	 */
+	unsigned long getDropped(void);
+};
+
+#endif
\ No newline at end of file
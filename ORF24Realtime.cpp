@@ -0,0 +1,301 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <alloca.h>
+#include <algorithm>
+#include <vector>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "ORF24Realtime.h"
+
+/**
+ * Read CLOCK_MONOTONIC
+ *
+ * @return  time in nanoseconds
+ */
+static inline unsigned long long monotonicNanos(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+ORF24Realtime::ORF24Realtime()
+	: running(false),
+	  entered(0),
+	  service(NULL),
+	  serviceArg(NULL),
+	  cpu(0),
+	  priority(0)
+{ }
+
+ORF24Realtime::~ORF24Realtime()
+{
+	stop();
+}
+
+/**
+ * Pin calling thread to a core
+ *
+ * @param  cpu 	core number
+ * @return     	true on success
+ */
+bool ORF24Realtime::pinCPU(int cpu)
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * Run calling thread with SCHED_FIFO
+ *
+ * @param  priority 	priority, 1 to 99
+ * @return          	true on success
+ */
+bool ORF24Realtime::setPriority(int priority)
+{
+	struct sched_param param;
+
+	param.sched_priority = priority;
+
+	return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+/**
+ * Lock current and future memory of the process
+ *
+ * @return  true on success
+ */
+bool ORF24Realtime::lockMemory(void)
+{
+	return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+/**
+ * Touch every page of a buffer so it is resident
+ *
+ * @param buf 	buffer
+ * @param len 	buffer length
+ */
+void ORF24Realtime::prefault(void *buf, size_t len)
+{
+	volatile unsigned char *p = (volatile unsigned char *) buf;
+	long page = sysconf(_SC_PAGESIZE);
+
+	for (size_t i = 0; i < len; i += page)
+	{
+		p[i] = p[i];
+	}
+
+	if (len > 0)
+	{
+		p[len - 1] = p[len - 1];
+	}
+}
+
+/**
+ * Touch stack pages of the calling thread
+ *
+ * @param len 	stack size to prefault
+ */
+void ORF24Realtime::prefaultStack(size_t len)
+{
+	unsigned char *stack = (unsigned char *) alloca(len);
+
+	prefault(stack, len);
+}
+
+/**
+ * Pin, raise priority, lock memory and prefault stack of calling thread
+ *
+ * @param  cpu 			core number
+ * @param  priority 	SCHED_FIFO priority
+ * @return          	true if every step succeeded
+ */
+bool ORF24Realtime::enter(int cpu, int priority)
+{
+	const size_t stackSize = 64 * 1024;
+
+	bool result = pinCPU(cpu);
+	result = lockMemory() && result;
+	result = setPriority(priority) && result;
+
+	prefaultStack(stackSize);
+
+	return result;
+}
+
+/**
+ * Service thread entry
+ *
+ * @param  self 	ORF24Realtime instance
+ * @return      	NULL
+ */
+void *ORF24Realtime::run(void *self)
+{
+	ORF24Realtime *rt = (ORF24Realtime *) self;
+
+	bool result = enter(rt->cpu, rt->priority);
+
+	rt->entered = result ? 1 : -1;
+
+	if (!result)
+	{
+		return NULL;
+	}
+
+	while (rt->running)
+	{
+		rt->service(rt->serviceArg);
+	}
+
+	return NULL;
+}
+
+/**
+ * Start service thread
+ *
+ * @param  _service 	service loop body
+ * @param  arg 			argument passed to service
+ * @param  _cpu 		core number
+ * @param  _priority 	SCHED_FIFO priority
+ * @return           	true if thread started in real time mode
+ */
+bool ORF24Realtime::start(void (*_service)(void *), void *arg, int _cpu, int _priority)
+{
+	if (running)
+	{
+		return false;
+	}
+
+	service = _service;
+	serviceArg = arg;
+	cpu = _cpu;
+	priority = _priority;
+	entered = 0;
+	running = true;
+
+	if (pthread_create(&thread, NULL, run, this) != 0)
+	{
+		running = false;
+		return false;
+	}
+
+	/* Wait for the thread to report whether it got real time mode */
+	while (entered == 0)
+	{
+		sched_yield();
+	}
+
+	if (entered < 0)
+	{
+		running = false;
+		pthread_join(thread, NULL);
+
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Stop service thread
+ */
+void ORF24Realtime::stop(void)
+{
+	if (running)
+	{
+		running = false;
+		pthread_join(thread, NULL);
+	}
+}
+
+/**
+ * Measure TX start to TX_DS latency
+ *
+ * @param  radio 	radio
+ * @param  payload 	payload to send
+ * @param  len 		payload length
+ * @param  samples 	number of transmissions
+ * @return         	latency percentiles
+ */
+JitterReport ORF24Realtime::selfTest(ORF24 &radio, unsigned char *payload, int len, int samples)
+{
+	JitterReport report;
+	std::vector<unsigned int> latency;
+
+	/* Allocate and touch sample storage before timing starts */
+	latency.resize(samples);
+	prefault(latency.data(), samples * sizeof(unsigned int));
+	latency.clear();
+
+	for (int i = 0; i < samples; i++)
+	{
+		bool delivered;
+
+		/* Payload upload and CE pulse jitter count too */
+		unsigned long long start = monotonicNanos();
+
+		radio.startWrite(payload, len);
+
+		while (!radio.pollWrite(&delivered))
+			;
+
+		unsigned long long end = monotonicNanos();
+
+		if (delivered)
+			latency.push_back(end - start);
+		else
+			report.failed++;
+	}
+
+	radio.powerDown();
+
+	report.samples = latency.size();
+
+	if (latency.empty())
+	{
+		return report;
+	}
+
+	std::sort(latency.begin(), latency.end());
+
+	int last = latency.size() - 1;
+
+	report.min = latency[0];
+	report.p50 = latency[last * 50 / 100];
+	report.p90 = latency[last * 90 / 100];
+	report.p99 = latency[last * 99 / 100];
+	report.p999 = latency[last * 999 / 1000];
+	report.max = latency[last];
+
+	return report;
+}
\ No newline at end of file
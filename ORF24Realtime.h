@@ -0,0 +1,165 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_REALTIME_H_
+#define _ORF_24_REALTIME_H_
+
+#include <atomic>
+#include <cstddef>
+#include <pthread.h>
+#include "ORF24.h"
+
+/**
+ * TX start to TX_DS latency percentiles
+ */
+struct JitterReport
+{
+	int samples = 0;				/* Transmissions measured */
+	int failed = 0;					/* Transmissions without TX_DS */
+	unsigned int min = 0;			/* Shortest latency in nanoseconds */
+	unsigned int p50 = 0;			/* Median latency in nanoseconds */
+	unsigned int p90 = 0;			/* 90th percentile in nanoseconds */
+	unsigned int p99 = 0;			/* 99th percentile in nanoseconds */
+	unsigned int p999 = 0;			/* 99.9th percentile in nanoseconds */
+	unsigned int max = 0;			/* Longest latency in nanoseconds */
+};
+
+/**
+ * Real time execution mode
+ *
+ * Runs the radio service loop on a pinned core at SCHED_FIFO priority with
+ * memory locked and the stack prefaulted, so CE pulses and timeouts do not
+ * jitter when the other cores are busy. Needs CAP_SYS_NICE and
+ * CAP_IPC_LOCK, or root.
+ */
+class ORF24Realtime
+{
+private:
+	pthread_t thread;				/* Service thread */
+	std::atomic<bool> running;		/* Whether service thread should keep running */
+	std::atomic<int> entered;		/* Real time mode of service thread, 1 entered, -1 failed, 0 pending */
+	void (*service)(void *);		/* Service loop body */
+	void *serviceArg;				/* Service loop argument */
+	int cpu;						/* Core to pin to */
+	int priority;					/* SCHED_FIFO priority */
+
+	/**
+	 * Service thread entry
+	 *
+	 * @param  self 	ORF24Realtime instance
+	 * @return      	NULL
+	 */
+	static void *run(void *self);
+
+public:
+
+	ORF24Realtime();
+
+	~ORF24Realtime();
+
+	/**
+	 * Pin calling thread to a core
+	 *
+	 * @param  cpu 	core number
+	 * @return     	true on success
+	 */
+	static bool pinCPU(int cpu);
+
+	/**
+	 * Run calling thread with SCHED_FIFO
+	 *
+	 * @param  priority 	priority, 1 to 99
+	 * @return          	true on success
+	 */
+	static bool setPriority(int priority);
+
+	/**
+	 * Lock current and future memory of the process
+	 *
+	 * @return  true on success
+	 */
+	static bool lockMemory(void);
+
+	/**
+	 * Touch every page of a buffer so it is resident
+	 *
+	 * @param buf 	buffer
+	 * @param len 	buffer length
+	 */
+	static void prefault(void *buf, size_t len);
+
+	/**
+	 * Touch stack pages of the calling thread
+	 *
+	 * @param len 	stack size to prefault
+	 */
+	static void prefaultStack(size_t len);
+
+	/**
+	 * Pin, raise priority, lock memory and prefault stack of calling thread
+	 *
+	 * @param  cpu 			core number
+	 * @param  priority 	SCHED_FIFO priority
+	 * @return          	true if every step succeeded
+	 */
+	static bool enter(int cpu, int priority);
+
+	/**
+	 * Start service thread
+	 *
+	 * The thread enters real time mode and calls the service function until
+	 * stop() is called. If real time mode can not be entered the thread
+	 * exits without calling the service function.
+	 *
+	 * @param  _service 	service loop body, e.g. scheduler service
+	 * @param  arg 			argument passed to service
+	 * @param  _cpu 		core number
+	 * @param  _priority 	SCHED_FIFO priority
+	 * @return           	true if thread started in real time mode
+	 */
+	bool start(void (*_service)(void *), void *arg, int _cpu, int _priority);
+
+	/**
+	 * Stop service thread
+	 */
+	void stop(void);
+
+	/**
+	 * Measure TX start to TX_DS latency
+	 *
+	 * Sends payloads to the open writing pipe, which must be acknowledged
+	 * by a receiver, and times each from the call to startWrite, payload
+	 * upload and CE pulse included, to the poll that sees TX_DS. Run from
+	 * the real time thread to check its tail latency.
+	 *
+	 * @param  radio 	radio
+	 * @param  payload 	payload to send
+	 * @param  len 		payload length
+	 * @param  samples 	number of transmissions
+	 * @return         	latency percentiles
+	 */
+	static JitterReport selfTest(ORF24 &radio, unsigned char *payload, int len, int samples);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,270 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24Scheduler.h"
+
+ORF24Scheduler::ORF24Scheduler(ORF24 &_radio)
+	: radio(_radio)
+{
+	/* Default limits, stale telemetry is worthless after a second */
+	const int defaultLimit[TC_COUNT] = { 8, 16, 32, 64 };
+	const unsigned int defaultDeadline[TC_COUNT] = { 0, 0, 1000000, 0 };
+
+	for (int i = 0; i < TC_COUNT; i++)
+	{
+		limit[i] = defaultLimit[i];
+		deadline[i] = defaultDeadline[i];
+		next[i] = 0;
+		credit[i] = 0;
+	}
+}
+
+/**
+ * Register a destination
+ *
+ * @param  address 	pipe address, 5 bytes
+ * @param  weight 	frames sent per round robin turn
+ * @return         	destination identifier
+ */
+int ORF24Scheduler::addDestination(const char *address, int weight)
+{
+	Destination destination;
+
+	std::memcpy(destination.address, address, sizeof(destination.address));
+	destination.weight = weight > 0 ? weight : 1;
+
+	destinations.push_back(destination);
+
+	return destinations.size() - 1;
+}
+
+/**
+ * Set queue limit and default deadline of a class
+ *
+ * @param trafficClass 	traffic class
+ * @param maxDepth 		queue limit
+ * @param maxAge 		deadline in microseconds, 0 for none
+ */
+void ORF24Scheduler::setClass(TrafficClass trafficClass, int maxDepth, unsigned int maxAge)
+{
+	limit[trafficClass] = maxDepth;
+	deadline[trafficClass] = maxAge;
+}
+
+/**
+ * Queue a frame with the class deadline
+ *
+ * @param  destination 	destination identifier
+ * @param  trafficClass traffic class
+ * @param  data 		payload
+ * @param  len 			payload length
+ * @return             	false if the class queue is full
+ */
+bool ORF24Scheduler::enqueue(int destination, TrafficClass trafficClass, const unsigned char *data, int len)
+{
+	return enqueue(destination, trafficClass, data, len, deadline[trafficClass]);
+}
+
+/**
+ * Queue a frame
+ *
+ * @param  destination 	destination identifier
+ * @param  trafficClass traffic class
+ * @param  data 		payload
+ * @param  len 			payload length
+ * @param  maxAge 		deadline in microseconds, 0 for none
+ * @return             	false if the class queue is full
+ */
+bool ORF24Scheduler::enqueue(int destination, TrafficClass trafficClass, const unsigned char *data, int len, unsigned int maxAge)
+{
+	ClassMetrics &m = metrics[trafficClass];
+
+	if (destination < 0 || destination >= (int) destinations.size() || len <= 0 || len > 32)
+	{
+		return false;
+	}
+
+	if (m.depth >= limit[trafficClass])
+	{
+		m.overflow++;
+		return false;
+	}
+
+	ScheduledFrame frame;
+
+	std::memcpy(frame.data, data, len);
+	frame.len = len;
+	frame.enqueuedAt = radio.getTransport()->micros();
+	frame.deadline = maxAge;
+
+	destinations[destination].queue[trafficClass].push_back(frame);
+
+	m.depth++;
+	m.enqueued++;
+
+	return true;
+}
+
+/**
+ * Pick next frame to send, dropping expired frames
+ *
+ * @param  destination 	set to destination of picked frame
+ * @param  trafficClass set to class of picked frame
+ * @return             	false if all queues are empty
+ */
+bool ORF24Scheduler::pick(int *destination, int *trafficClass)
+{
+	int count = destinations.size();
+	unsigned int now = radio.getTransport()->micros();
+
+	for (int c = 0; c < TC_COUNT; c++)
+	{
+		ClassMetrics &m = metrics[c];
+
+		for (int visited = 0; visited < count && m.depth > 0; )
+		{
+			int d = next[c];
+			std::deque<ScheduledFrame> &queue = destinations[d].queue[c];
+
+			while (!queue.empty() && queue.front().deadline && now - queue.front().enqueuedAt > queue.front().deadline)
+			{
+				queue.pop_front();
+				m.depth--;
+				m.expired++;
+			}
+
+			if (queue.empty())
+			{
+				credit[c] = 0;
+				next[c] = (d + 1) % count;
+				visited++;
+				continue;
+			}
+
+			if (credit[c] == 0)
+			{
+				credit[c] = destinations[d].weight;
+			}
+
+			/* Move on once this destination used its turn */
+			if (--credit[c] == 0)
+			{
+				next[c] = (d + 1) % count;
+			}
+
+			*destination = d;
+			*trafficClass = c;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Finish the frame in flight and start the next one
+ *
+ * @return  true if a frame is in flight
+ */
+bool ORF24Scheduler::service(void)
+{
+	if (inFlight)
+	{
+		bool delivered;
+
+		if (!radio.pollWrite(&delivered))
+		{
+			return true;
+		}
+
+		ClassMetrics &m = metrics[flightClass];
+		unsigned int latency = radio.getTransport()->micros() - flight.enqueuedAt;
+
+		if (delivered)
+		{
+			m.sent++;
+		}
+		else
+		{
+			m.failed++;
+		}
+
+		m.latencyTotal += latency;
+		m.latencyMax = latency > m.latencyMax ? latency : m.latencyMax;
+
+		inFlight = false;
+	}
+
+	int destination, trafficClass;
+
+	if (!pick(&destination, &trafficClass))
+	{
+		return false;
+	}
+
+	std::deque<ScheduledFrame> &queue = destinations[destination].queue[trafficClass];
+
+	flight = queue.front();
+	flightClass = trafficClass;
+	queue.pop_front();
+	metrics[trafficClass].depth--;
+
+	if (destination != current)
+	{
+		radio.openWritingPipe(destinations[destination].address);
+		current = destination;
+	}
+
+	radio.startWrite(flight.data, flight.len);
+	inFlight = true;
+
+	return true;
+}
+
+/**
+ * Get metrics of a class
+ *
+ * @param  trafficClass traffic class
+ * @return             	metrics
+ */
+const ClassMetrics &ORF24Scheduler::getMetrics(TrafficClass trafficClass)
+{
+	return metrics[trafficClass];
+}
+
+/**
+ * Get mean enqueue to completion time of a class
+ *
+ * @param  trafficClass traffic class
+ * @return             	latency in microseconds
+ */
+double ORF24Scheduler::getMeanLatency(TrafficClass trafficClass)
+{
+	const ClassMetrics &m = metrics[trafficClass];
+	unsigned long done = m.sent + m.failed;
+
+	return done ? (double) m.latencyTotal / done : 0;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_SCHEDULER_H_
+#define _ORF_24_SCHEDULER_H_
+
+#include <deque>
+#include <vector>
+#include "ORF24.h"
+
+/* Traffic classes, highest priority first */
+enum TrafficClass {TC_CONTROL = 0, TC_ALARM, TC_TELEMETRY, TC_BULK, TC_COUNT};
+
+/**
+ * Frame waiting for transmission
+ */
+struct ScheduledFrame
+{
+	unsigned char data[32];			/* Payload */
+	int len;						/* Payload length */
+	unsigned int enqueuedAt;		/* Enqueue time in microseconds */
+	unsigned int deadline;			/* Longest wait in microseconds, 0 for none */
+};
+
+/**
+ * Metrics of one traffic class
+ */
+struct ClassMetrics
+{
+	int depth = 0;					/* Frames waiting */
+	unsigned long enqueued = 0;		/* Frames accepted */
+	unsigned long overflow = 0;		/* Frames refused at queue limit */
+	unsigned long expired = 0;		/* Frames dropped after deadline */
+	unsigned long sent = 0;			/* Frames acknowledged */
+	unsigned long failed = 0;		/* Frames not acknowledged */
+	unsigned long long latencyTotal = 0;	/* Sum of enqueue to completion time in microseconds */
+	unsigned int latencyMax = 0;	/* Longest enqueue to completion time in microseconds */
+};
+
+/**
+ * Transmit scheduler with priority classes
+ *
+ * The highest non empty class is served first. Within a class destinations
+ * are served by weighted round robin. Only one frame is handed to the chip
+ * at a time, because every frame in the TX FIFO goes to the same TX_ADDR,
+ * so a new high priority frame is sent as soon as the current one finishes.
+ * Frames older than their deadline are dropped instead of sent.
+ */
+class ORF24Scheduler
+{
+private:
+	struct Destination
+	{
+		char address[5];			/* Pipe address */
+		int weight;					/* Frames per round */
+		std::deque<ScheduledFrame> queue[TC_COUNT];	/* Frames per class */
+	};
+
+	ORF24 &radio;					/* Radio to send with */
+	std::vector<Destination> destinations;	/* Registered destinations */
+	int limit[TC_COUNT];			/* Queue limit per class */
+	unsigned int deadline[TC_COUNT];	/* Default deadline per class in microseconds */
+	int next[TC_COUNT];				/* Round robin position per class */
+	int credit[TC_COUNT];			/* Frames left for destination at round robin position */
+	ClassMetrics metrics[TC_COUNT];	/* Metrics per class */
+	int current = -1;				/* Destination of open writing pipe */
+	bool inFlight = false;			/* Whether a frame is being sent */
+	ScheduledFrame flight;			/* Frame being sent */
+	int flightClass;				/* Class of frame being sent */
+
+protected:
+
+	/**
+	 * Pick next frame to send, dropping expired frames
+	 *
+	 * @param  destination 	set to destination of picked frame
+	 * @param  trafficClass set to class of picked frame
+	 * @return             	false if all queues are empty
+	 */
+	bool pick(int *destination, int *trafficClass);
+
+public:
+
+	/**
+	 * ORF24Scheduler Constructor
+	 *
+	 * @param _radio 	radio to send with
+	 */
+	ORF24Scheduler(ORF24 &_radio);
+
+	/**
+	 * Register a destination
+	 *
+	 * @param  address 	pipe address, 5 bytes
+	 * @param  weight 	frames sent per round robin turn
+	 * @return         	destination identifier
+	 */
+	int addDestination(const char *address, int weight);
+
+	/**
+	 * Set queue limit and default deadline of a class
+	 *
+	 * @param trafficClass 	traffic class
+	 * @param maxDepth 		queue limit
+	 * @param maxAge 		deadline in microseconds, 0 for none
+	 */
+	void setClass(TrafficClass trafficClass, int maxDepth, unsigned int maxAge);
+
+	/**
+	 * Queue a frame with the class deadline
+	 *
+	 * @param  destination 	destination identifier
+	 * @param  trafficClass traffic class
+	 * @param  data 		payload
+	 * @param  len 			payload length
+	 * @return             	false if the class queue is full
+	 */
+	bool enqueue(int destination, TrafficClass trafficClass, const unsigned char *data, int len);
+
+	/**
+	 * Queue a frame
+	 *
+	 * @param  destination 	destination identifier
+	 * @param  trafficClass traffic class
+	 * @param  data 		payload
+	 * @param  len 			payload length
+	 * @param  maxAge 		deadline in microseconds, 0 for none
+	 * @return             	false if the class queue is full
+	 */
+	bool enqueue(int destination, TrafficClass trafficClass, const unsigned char *data, int len, unsigned int maxAge);
+
+	/**
+	 * Finish the frame in flight and start the next one
+	 *
+	 * Call from the main loop.
+	 *
+	 * @return  true if a frame is in flight
+	 */
+	bool service(void);
+
+	/**
+	 * Get metrics of a class
+	 *
+	 * @param  trafficClass traffic class
+	 * @return             	metrics
+	 */
+	const ClassMetrics &getMetrics(TrafficClass trafficClass);
+
+	/**
+	 * Get mean enqueue to completion time of a class
+	 *
+	 * @param  trafficClass traffic class
+	 * @return             	latency in microseconds
+	 */
+	double getMeanLatency(TrafficClass trafficClass);
+};
+
+#endif
\ No newline at end of file
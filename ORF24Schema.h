@@ -0,0 +1,571 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_SCHEMA_H_
+#define _ORF_24_SCHEMA_H_
+
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include "ORF24.h"
+
+/**
+ * Compile time message schemas
+ *
+ * A message is a type listing its ID and fields. Byte 0 of the payload holds
+ * the ID, fields sit at fixed offsets after it, so layout, overlap and size
+ * are checked by the compiler. Views read fields straight out of a payload
+ * buffer and builders write them into one, with no intermediate struct.
+ * Multi byte fields are little endian on air unless declared big endian.
+ *
+ *     typedef Schema::Scalar<int16_t, 1> Temperature;
+ *     typedef Schema::Scalar<uint32_t, 3> Uptime;
+ *     typedef Schema::Message<0x10, Temperature, Uptime> Reading;
+ *
+ *     struct Gateway
+ *     {
+ *         void handle(Schema::View<Reading> reading)
+ *         {
+ *             int16_t t = reading.get<Temperature>();
+ *         }
+ *     };
+ *
+ *     Gateway gateway;
+ *     Schema::Dispatcher<32, Gateway, Reading> dispatcher(gateway);
+ *     dispatcher.receive(radio);
+ */
+namespace Schema
+{
+	/* Byte order of the host */
+	static constexpr bool hostBigEndian = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+	/**
+	 * Unsigned word of a size, with byte swap
+	 *
+	 * @tparam Size 	size in bytes
+	 */
+	template <int Size>
+	struct Word;
+
+	template <>
+	struct Word<1>
+	{
+		typedef uint8_t type;
+
+		static type swap(type value) { return value; }
+	};
+
+	template <>
+	struct Word<2>
+	{
+		typedef uint16_t type;
+
+		static type swap(type value) { return __builtin_bswap16(value); }
+	};
+
+	template <>
+	struct Word<4>
+	{
+		typedef uint32_t type;
+
+		static type swap(type value) { return __builtin_bswap32(value); }
+	};
+
+	template <>
+	struct Word<8>
+	{
+		typedef uint64_t type;
+
+		static type swap(type value) { return __builtin_bswap64(value); }
+	};
+
+	/**
+	 * Load a value from payload bytes
+	 *
+	 * @tparam T 			value type
+	 * @tparam BigEndian 	byte order on air
+	 * @param  p 			first byte
+	 * @return   			value
+	 */
+	template <class T, bool BigEndian>
+	inline T load(const unsigned char *p)
+	{
+		typedef Word<sizeof(T)> W;
+
+		typename W::type bits;
+		std::memcpy(&bits, p, sizeof(T));
+
+		if (BigEndian != hostBigEndian)
+		{
+			bits = W::swap(bits);
+		}
+
+		T value;
+		std::memcpy(&value, &bits, sizeof(T));
+
+		return value;
+	}
+
+	/**
+	 * Store a value into payload bytes
+	 *
+	 * @tparam T 			value type
+	 * @tparam BigEndian 	byte order on air
+	 * @param  p 			first byte
+	 * @param  value 		value
+	 */
+	template <class T, bool BigEndian>
+	inline void store(unsigned char *p, T value)
+	{
+		typedef Word<sizeof(T)> W;
+
+		typename W::type bits;
+		std::memcpy(&bits, &value, sizeof(T));
+
+		if (BigEndian != hostBigEndian)
+		{
+			bits = W::swap(bits);
+		}
+
+		std::memcpy(p, &bits, sizeof(T));
+	}
+
+	/**
+	 * Integer or floating point field
+	 *
+	 * @tparam T 			value type
+	 * @tparam Offset 		position in payload, after the ID byte
+	 * @tparam BigEndian 	byte order on air
+	 */
+	template <class T, int Offset, bool BigEndian = false>
+	struct Scalar
+	{
+		static_assert(std::is_arithmetic<T>::value, "Scalar field must be an integer or floating point type");
+		static_assert(Offset >= 1, "Byte 0 holds the message ID");
+
+		typedef T type;
+
+		static constexpr int offset = Offset;
+		static constexpr int size = sizeof(T);
+
+		/**
+		 * Read field
+		 *
+		 * @param  payload 	payload buffer
+		 * @return         	field value
+		 */
+		static T get(const unsigned char *payload)
+		{
+			return load<T, BigEndian>(payload + Offset);
+		}
+
+		/**
+		 * Write field
+		 *
+		 * @param payload 	payload buffer
+		 * @param value   	field value
+		 */
+		static void set(unsigned char *payload, T value)
+		{
+			store<T, BigEndian>(payload + Offset, value);
+		}
+	};
+
+	/**
+	 * Fixed length byte array field
+	 *
+	 * @tparam Offset 	position in payload, after the ID byte
+	 * @tparam Length 	length in bytes
+	 */
+	template <int Offset, int Length>
+	struct Bytes
+	{
+		static_assert(Offset >= 1, "Byte 0 holds the message ID");
+		static_assert(Length > 0, "Byte array must not be empty");
+
+		typedef const unsigned char *type;
+
+		static constexpr int offset = Offset;
+		static constexpr int size = Length;
+
+		/**
+		 * Point at field inside the payload
+		 *
+		 * @param  payload 	payload buffer
+		 * @return         	first byte of the field
+		 */
+		static const unsigned char *get(const unsigned char *payload)
+		{
+			return payload + Offset;
+		}
+
+		/**
+		 * Write field
+		 *
+		 * @param payload 	payload buffer
+		 * @param value   	Length bytes to copy
+		 */
+		static void set(unsigned char *payload, const unsigned char *value)
+		{
+			std::memcpy(payload + Offset, value, Length);
+		}
+	};
+
+	/**
+	 * Layout checks over a field list
+	 */
+	template <class... Fields>
+	struct Layout;
+
+	template <>
+	struct Layout<>
+	{
+		static constexpr int end = 1;			/* ID byte */
+		static constexpr bool disjoint = true;
+
+		static constexpr bool overlaps(int offset, int size)
+		{
+			return false;
+		}
+
+		template <class G>
+		static constexpr bool contains()
+		{
+			return false;
+		}
+	};
+
+	template <class F, class... Fields>
+	struct Layout<F, Fields...>
+	{
+		typedef Layout<Fields...> rest;
+
+		static constexpr int end = F::offset + F::size > rest::end ? F::offset + F::size : rest::end;
+		static constexpr bool disjoint = !rest::overlaps(F::offset, F::size) && rest::disjoint;
+
+		static constexpr bool overlaps(int offset, int size)
+		{
+			return (offset < F::offset + F::size && F::offset < offset + size) || rest::overlaps(offset, size);
+		}
+
+		template <class G>
+		static constexpr bool contains()
+		{
+			return std::is_same<F, G>::value || rest::template contains<G>();
+		}
+	};
+
+	/**
+	 * Message type
+	 *
+	 * @tparam Id 		message ID, byte 0 of the payload
+	 * @tparam Fields 	fields in any order
+	 */
+	template <unsigned char Id, class... Fields>
+	struct Message
+	{
+		static_assert(Layout<Fields...>::disjoint, "Message fields overlap");
+		static_assert(Layout<Fields...>::end <= 32, "Message does not fit in a payload");
+
+		typedef Layout<Fields...> layout;
+
+		static constexpr unsigned char id = Id;
+		static constexpr int size = layout::end;
+	};
+
+	/**
+	 * Read only view of a received message
+	 *
+	 * Holds the payload pointer only, fields are read on access.
+	 *
+	 * @tparam Msg 	message type
+	 */
+	template <class Msg>
+	class View
+	{
+	private:
+		const unsigned char *payload;	/* Payload buffer */
+
+	public:
+
+		explicit View(const unsigned char *_payload)
+			: payload(_payload)
+		{ }
+
+		/**
+		 * Read field
+		 *
+		 * @tparam F 	field of Msg
+		 * @return   	field value
+		 */
+		template <class F>
+		typename F::type get(void) const
+		{
+			static_assert(Msg::layout::template contains<F>(), "Field is not part of the message");
+
+			return F::get(payload);
+		}
+
+		/**
+		 * Get payload the view points at
+		 *
+		 * @return  payload buffer
+		 */
+		const unsigned char *data(void) const
+		{
+			return payload;
+		}
+	};
+
+	/**
+	 * Writer of a message into a payload buffer
+	 *
+	 * @tparam Msg 	message type
+	 */
+	template <class Msg>
+	class Builder
+	{
+	private:
+		unsigned char *payload;			/* Payload buffer */
+
+	public:
+
+		/**
+		 * Start a message, writes the ID byte
+		 *
+		 * @param _payload 	payload buffer of at least Msg::size bytes
+		 */
+		explicit Builder(unsigned char *_payload)
+			: payload(_payload)
+		{
+			payload[0] = Msg::id;
+		}
+
+		/**
+		 * Write field
+		 *
+		 * @tparam F 		field of Msg
+		 * @param  value 	field value
+		 * @return       	this builder
+		 */
+		template <class F>
+		Builder &set(typename F::type value)
+		{
+			static_assert(Msg::layout::template contains<F>(), "Field is not part of the message");
+
+			F::set(payload, value);
+
+			return *this;
+		}
+	};
+
+	/**
+	 * Handler call for one message type
+	 *
+	 * @param handler 	handler with handle(View<Msg>)
+	 * @param payload 	payload buffer
+	 */
+	template <class Handler, class Msg>
+	void deliver(Handler &handler, const unsigned char *payload)
+	{
+		handler.handle(View<Msg>(payload));
+	}
+
+	/**
+	 * ID checks and handler lookup over a message list
+	 */
+	template <class Handler, class... Msgs>
+	struct Route;
+
+	template <class Handler>
+	struct Route<Handler>
+	{
+		typedef void (*Entry)(Handler &, const unsigned char *);
+
+		static constexpr bool distinct = true;
+		static constexpr int size = 1;
+
+		static constexpr bool has(int id)
+		{
+			return false;
+		}
+
+		static constexpr Entry entry(int id)
+		{
+			return nullptr;
+		}
+	};
+
+	template <class Handler, class Msg, class... Msgs>
+	struct Route<Handler, Msg, Msgs...>
+	{
+		typedef Route<Handler, Msgs...> rest;
+		typedef void (*Entry)(Handler &, const unsigned char *);
+
+		static constexpr bool distinct = !rest::has(Msg::id) && rest::distinct;
+		static constexpr int size = Msg::size > rest::size ? Msg::size : rest::size;
+
+		static constexpr bool has(int id)
+		{
+			return id == Msg::id || rest::has(id);
+		}
+
+		static constexpr Entry entry(int id)
+		{
+			return id == Msg::id ? &deliver<Handler, Msg> : rest::entry(id);
+		}
+	};
+
+	/**
+	 * Compile time integer list
+	 */
+	template <int... Is>
+	struct Indices { };
+
+	template <int N, int... Is>
+	struct MakeIndices : MakeIndices<N - 1, N - 1, Is...> { };
+
+	template <int... Is>
+	struct MakeIndices<0, Is...>
+	{
+		typedef Indices<Is...> type;
+	};
+
+	/**
+	 * Handler per message ID, built at compile time
+	 */
+	template <class Handler, class Ids, class... Msgs>
+	struct JumpTable;
+
+	template <class Handler, int... Is, class... Msgs>
+	struct JumpTable<Handler, Indices<Is...>, Msgs...>
+	{
+		typedef void (*Entry)(Handler &, const unsigned char *);
+
+		static constexpr Entry entries[sizeof...(Is)] = { Route<Handler, Msgs...>::entry(Is)... };
+	};
+
+	template <class Handler, int... Is, class... Msgs>
+	constexpr typename JumpTable<Handler, Indices<Is...>, Msgs...>::Entry
+		JumpTable<Handler, Indices<Is...>, Msgs...>::entries[sizeof...(Is)];
+
+	/**
+	 * Dispatch received payloads by message ID
+	 *
+	 * The handler needs a handle(View<Msg>) overload per message. Lookup is a
+	 * single load from a 256 entry table, and every message is known to fit
+	 * the payload, so nothing is checked or copied per message.
+	 *
+	 * @tparam PayloadSize 	payload size of the radio
+	 * @tparam Handler 		handler type
+	 * @tparam Msgs 		message types
+	 */
+	template <int PayloadSize, class Handler, class... Msgs>
+	class Dispatcher
+	{
+		typedef Route<Handler, Msgs...> route;
+		typedef JumpTable<Handler, typename MakeIndices<256>::type, Msgs...> table;
+
+		static_assert(PayloadSize > 0 && PayloadSize <= 32, "Payload size must be between 1 and 32");
+		static_assert(route::distinct, "Message IDs must be unique");
+		static_assert(route::size <= PayloadSize, "Message does not fit in payload size");
+
+	private:
+		Handler &handler;				/* Message handler */
+		unsigned char buffer[PayloadSize];	/* Receive buffer */
+		unsigned long dispatched = 0;	/* Payloads passed to the handler */
+		unsigned long unknown = 0;		/* Payloads with no message for their ID */
+
+	public:
+
+		explicit Dispatcher(Handler &_handler)
+			: handler(_handler)
+		{ }
+
+		/**
+		 * Pass a payload to the handler of its message
+		 *
+		 * @param  payload 	payload buffer of PayloadSize bytes
+		 * @return         	false if no message has the ID
+		 */
+		bool dispatch(const unsigned char *payload)
+		{
+			typename table::Entry entry = table::entries[payload[0]];
+
+			if (!entry)
+			{
+				unknown++;
+				return false;
+			}
+
+			entry(handler, payload);
+			dispatched++;
+
+			return true;
+		}
+
+		/**
+		 * Read and dispatch the payloads waiting in the RX FIFO
+		 *
+		 * @param  radio 	radio with payload size PayloadSize
+		 * @return       	number of payloads read
+		 */
+		int receive(ORF24 &radio)
+		{
+			int count = 0;
+
+			/* RX FIFO holds at most three payloads */
+			while (count < 3 && radio.available())
+			{
+				radio.read(buffer, PayloadSize);
+				dispatch(buffer);
+				count++;
+			}
+
+			return count;
+		}
+
+		/**
+		 * Get number of payloads passed to the handler
+		 *
+		 * @return  dispatched payloads
+		 */
+		unsigned long getDispatched(void)
+		{
+			return dispatched;
+		}
+
+		/**
+		 * Get number of payloads with an unknown message ID
+		 *
+		 * @return  unknown payloads
+		 */
+		unsigned long getUnknown(void)
+		{
+			return unknown;
+		}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_SHARED_RING_H_
+#define _ORF_24_SHARED_RING_H_
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define 	ORF24_RING_SIZE			64
+#define 	ORF24_MAX_CLIENTS		8
+#define 	ORF24_SHARED_MAGIC		0x4F524634
+
+/**
+ * Packet slot in shared memory
+ */
+struct SharedPacket
+{
+	unsigned char address[5];		/* Destination address of TX packets */
+	unsigned char pipe;				/* Receiving pipe of RX packets */
+	unsigned char len;				/* Payload length */
+	unsigned char data[32];			/* Payload */
+};
+
+/**
+ * Wait on a shared memory word
+ *
+ * The futex is not private, so it works between processes mapping the
+ * same memory.
+ *
+ * @param word 			futex word
+ * @param expected 		value to sleep on
+ * @param timeoutMs 	timeout in milliseconds
+ */
+inline void futexWait(std::atomic<unsigned int> *word, unsigned int expected, int timeoutMs)
+{
+	struct timespec ts;
+
+	ts.tv_sec = timeoutMs / 1000;
+	ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+
+	syscall(SYS_futex, (unsigned int *) word, FUTEX_WAIT, expected, &ts, NULL, 0);
+}
+
+/**
+ * Wake all waiters on a shared memory word
+ *
+ * @param word 	futex word
+ */
+inline void futexWake(std::atomic<unsigned int> *word)
+{
+	syscall(SYS_futex, (unsigned int *) word, FUTEX_WAKE, 0x7FFFFFFF, NULL, NULL, 0);
+}
+
+/**
+ * Single producer, single consumer packet ring in shared memory
+ *
+ * Slots are filled and drained in place through reserve/commit and
+ * peek/release, so packets are not copied through a socket.
+ */
+struct SharedRing
+{
+	std::atomic<unsigned int> head;	/* Next slot to write, producer owned */
+	std::atomic<unsigned int> tail;	/* Next slot to read, consumer owned */
+	std::atomic<unsigned int> signal;	/* Futex word bumped on commit */
+	SharedPacket slots[ORF24_RING_SIZE];	/* Packet slots */
+
+	/**
+	 * Reset ring, only while neither side uses it
+	 */
+	void reset(void)
+	{
+		head.store(0);
+		tail.store(0);
+		signal.store(0);
+	}
+
+	/**
+	 * Get free slot to fill
+	 *
+	 * @return  slot, NULL if ring is full
+	 */
+	SharedPacket *reserve(void)
+	{
+		unsigned int h = head.load(std::memory_order_relaxed);
+
+		if (h - tail.load(std::memory_order_acquire) >= ORF24_RING_SIZE)
+		{
+			return NULL;
+		}
+
+		return &slots[h % ORF24_RING_SIZE];
+	}
+
+	/**
+	 * Publish slot returned by reserve and wake the consumer
+	 */
+	void commit(void)
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		signal.fetch_add(1, std::memory_order_release);
+		futexWake(&signal);
+	}
+
+	/**
+	 * Get oldest filled slot
+	 *
+	 * @return  slot, NULL if ring is empty
+	 */
+	const SharedPacket *peek(void)
+	{
+		unsigned int t = tail.load(std::memory_order_relaxed);
+
+		if (t == head.load(std::memory_order_acquire))
+		{
+			return NULL;
+		}
+
+		return &slots[t % ORF24_RING_SIZE];
+	}
+
+	/**
+	 * Free slot returned by peek
+	 */
+	void release(void)
+	{
+		tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/**
+	 * Wait until a slot is filled
+	 *
+	 * @param  timeoutMs 	timeout in milliseconds
+	 * @return           	slot, NULL on timeout
+	 */
+	const SharedPacket *wait(int timeoutMs)
+	{
+		const SharedPacket *packet = peek();
+
+		if (!packet)
+		{
+			unsigned int seen = signal.load(std::memory_order_acquire);
+
+			packet = peek();
+
+			if (!packet)
+			{
+				futexWait(&signal, seen, timeoutMs);
+				packet = peek();
+			}
+		}
+
+		return packet;
+	}
+};
+
+/**
+ * Client slot in shared memory
+ */
+struct SharedClient
+{
+	std::atomic<unsigned int> state;	/* 0 free, 1 attaching, 2 attached */
+	std::atomic<int> pid;			/* Client process */
+	std::atomic<unsigned int> pipeMask;	/* Pipes routed to this client */
+	std::atomic<unsigned long> sent;	/* TX packets acknowledged */
+	std::atomic<unsigned long> failed;	/* TX packets not acknowledged */
+	std::atomic<unsigned long> dropped;	/* RX packets dropped on full ring */
+	SharedRing tx;					/* Client to daemon */
+	SharedRing rx;					/* Daemon to client */
+};
+
+/**
+ * Shared memory layout of the radio daemon
+ */
+struct SharedRadio
+{
+	unsigned int magic;				/* ORF24_SHARED_MAGIC once initialized */
+	std::atomic<unsigned int> doorbell;	/* Futex word bumped by clients on send */
+	SharedClient clients[ORF24_MAX_CLIENTS];	/* Client slots */
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1200 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "ORF24Simulator.h"
+#include "nRF24L01Register.h"
+
+using namespace nRF24L01;
+
+/* Medium event types */
+enum SimulatorEvent {SIM_TX_END = 0, SIM_ACK_END, SIM_RETRY};
+
+/* Transmissions older than this are dropped from the overlap check */
+static const unsigned long long historyNs = 5000000ULL;
+
+/* Longest packet, 32 bytes at 250 kbps, with margin for start order skew */
+static const unsigned long long longestNs = 2000000ULL;
+
+/* PLL settling from standby to TX or RX */
+static const unsigned long long settleNs = 130000ULL;
+
+/**
+ * Payload checksum for duplicate detection
+ *
+ * @param  data 	payload
+ * @param  len  	payload length
+ * @return      	checksum
+ */
+static unsigned int checksum(const unsigned char *data, int len)
+{
+	unsigned int hash = 2166136261u;
+
+	for (int i = 0; i < len; i++)
+	{
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+SimulatedChip::SimulatedChip(ORF24Simulator *_simulator, int _id, double _x, double _y)
+	: simulator(_simulator),
+	  id(_id),
+	  x(_x),
+	  y(_y)
+{
+	std::memset(registers, 0, sizeof(registers));
+
+	/* Power on reset values */
+	registers[CONFIG][0] = 0x08;
+	registers[EN_AA][0] = 0x3F;
+	registers[EN_RXADDR][0] = 0x03;
+	registers[SETUP_AW][0] = 0x03;
+	registers[SETUP_RETR][0] = 0x03;
+	registers[RF_CH][0] = 0x02;
+	registers[RF_SETUP][0] = 0x0F;
+	std::memset(registers[RX_ADDR_P0], 0xE7, 5);
+	std::memset(registers[RX_ADDR_P1], 0xC2, 5);
+	registers[RX_ADDR_P2][0] = 0xC3;
+	registers[RX_ADDR_P3][0] = 0xC4;
+	registers[RX_ADDR_P4][0] = 0xC5;
+	registers[RX_ADDR_P5][0] = 0xC6;
+	std::memset(registers[TX_ADDR], 0xE7, 5);
+
+	for (int i = 0; i < 6; i++)
+	{
+		lastPID[i] = -1;
+		lastCRC[i] = 0;
+	}
+}
+
+bool SimulatedChip::setup(int ce, int spiChannel, int _spiSpeed)
+{
+	spiSpeed = _spiSpeed;
+
+	return true;
+}
+
+bool SimulatedChip::setSpeed(int spiChannel, int _spiSpeed)
+{
+	spiSpeed = _spiSpeed;
+
+	return true;
+}
+
+/**
+ * Execute an SPI command
+ *
+ * STATUS is clocked out with the command byte, before the command runs.
+ */
+void SimulatedChip::transfer(int spiChannel, unsigned char *buf, int len)
+{
+	simulator->advance(*this);
+
+	now += (unsigned long long) len * 8 * 1000000000ULL / spiSpeed + simulator->spiOverhead * 1000ULL;
+
+	unsigned char command = buf[0];
+	unsigned char s = status();
+
+	if (command < W_REGISTER)
+	{
+		readRegister(command & RW_MASK, buf + 1, len - 1);
+	}
+	else if (command < ACTIVATE)
+	{
+		writeRegister(command & RW_MASK, buf + 1, len - 1);
+	}
+	else if (command == R_RX_PL_WID && len > 1)
+	{
+		buf[1] = arrived() ? rxLength[0] : 0;
+	}
+	else if (command == R_RX_PAYLOAD)
+	{
+		std::memset(buf + 1, 0, len - 1);
+
+		if (arrived())
+		{
+			std::memcpy(buf + 1, rxFifo[0], len - 1 < rxLength[0] ? len - 1 : rxLength[0]);
+			pop();
+		}
+	}
+	else if ((command == W_TX_PAYLOAD || command == W_TX_PAYLOAD_NO_ACK) && len > 1 && txCount < 3)
+	{
+		int size = len - 1 > 32 ? 32 : len - 1;
+
+		std::memcpy(txFifo[txCount], buf + 1, size);
+		txLength[txCount] = size;
+		txNoAck[txCount] = command == W_TX_PAYLOAD_NO_ACK;
+		txCount++;
+
+		/* CE held high in TX sends as soon as the FIFO fills */
+		if (ce && enabled() && !PrimaryRX::decode(registers[CONFIG][0]) && !txActive)
+		{
+			simulator->startPayload(*this, now + settleNs);
+		}
+	}
+	else if (command == FLUSH_TX)
+	{
+		txCount = 0;
+
+		if (txActive)
+		{
+			txActive = false;
+			generation++;
+		}
+	}
+	else if (command == FLUSH_RX)
+	{
+		rxCount = 0;
+	}
+
+	buf[0] = s;
+}
+
+void SimulatedChip::writeCE(int pin, int value)
+{
+	simulator->advance(*this);
+
+	bool rising = value && !ce;
+
+	ce = value;
+
+	if (!ce)
+	{
+		/* A started transmission completes after CE goes low */
+		rxSince = SIM_NEVER;
+		return;
+	}
+
+	if (rising && enabled())
+	{
+		if (PrimaryRX::decode(registers[CONFIG][0]))
+		{
+			rxSince = now + settleNs;
+		}
+		else if (!txActive && txCount)
+		{
+			simulator->startPayload(*this, now + settleNs);
+		}
+	}
+}
+
+void SimulatedChip::delayMicroseconds(unsigned int us)
+{
+	now += us * 1000ULL;
+}
+
+unsigned int SimulatedChip::millis(void)
+{
+	return nanos() / 1000000ULL;
+}
+
+unsigned int SimulatedChip::micros(void)
+{
+	return nanos() / 1000ULL;
+}
+
+unsigned long long SimulatedChip::nanos(void)
+{
+	return now + clockOffset + (long long) (now * clockDrift * 1e-6);
+}
+
+/**
+ * Give the host clock of the node an offset and drift
+ *
+ * @param offset 	offset in nanoseconds
+ * @param ppm    	drift in parts per million
+ */
+void SimulatedChip::setClock(long long offset, double ppm)
+{
+	clockOffset = offset;
+	clockDrift = ppm;
+}
+
+/**
+ * Get chip clock
+ *
+ * @return  time in nanoseconds
+ */
+unsigned long long SimulatedChip::getTime(void)
+{
+	return now;
+}
+
+/**
+ * Build STATUS register
+ *
+ * @return  STATUS value
+ */
+unsigned char SimulatedChip::status(void)
+{
+	if (rxFlagAt <= now)
+	{
+		flags |= 1 << RX_DR;
+		rxFlagAt = SIM_NEVER;
+	}
+
+	return flags | (arrived() ? rxPipe[0] : 7) << RX_P_NO | (txCount == 3 ? 1 << STX_FULL : 0);
+}
+
+/**
+ * Read register
+ *
+ * @param reg 	register address
+ * @param buf 	read buffer
+ * @param len 	data length
+ */
+void SimulatedChip::readRegister(unsigned char reg, unsigned char *buf, int len)
+{
+	unsigned char value[5];
+
+	std::memcpy(value, registers[reg], 5);
+
+	if (reg == STATUS)
+	{
+		value[0] = status();
+	}
+	else if (reg == FIFO_STATUS)
+	{
+		value[0] = (txCount == 3) << TX_FULL | (txCount == 0) << TX_EMPTY |
+			(arrived() == 3) << RX_FULL | (arrived() == 0) << RX_EMPTY;
+	}
+	else if (reg == CD)
+	{
+		value[0] = receiving() && simulator->carrier(*this);
+	}
+
+	for (int i = 0; i < len; i++)
+	{
+		buf[i] = value[i < 5 ? i : 4];
+	}
+}
+
+/**
+ * Write register
+ *
+ * @param reg 	register address
+ * @param buf 	data to write
+ * @param len 	data length
+ */
+void SimulatedChip::writeRegister(unsigned char reg, const unsigned char *buf, int len)
+{
+	if (len < 1)
+	{
+		return;
+	}
+
+	if (reg == STATUS)
+	{
+		flags &= ~(buf[0] & IRQFlags::mask);
+		return;
+	}
+
+	if (reg == OBSERVE_TX || reg == CD || reg == FIFO_STATUS)
+	{
+		return;
+	}
+
+	bool wasReceiving = receiving();
+
+	std::memcpy(registers[reg], buf, len < 5 ? len : 5);
+
+	if (reg == CONFIG)
+	{
+		if (!enabled())
+		{
+			rxSince = SIM_NEVER;
+
+			if (txActive)
+			{
+				txActive = false;
+				generation++;
+			}
+		}
+		else if (ce && PrimaryRX::decode(registers[CONFIG][0]))
+		{
+			if (!wasReceiving)
+			{
+				rxSince = now + settleNs;
+			}
+		}
+		else if (ce)
+		{
+			rxSince = SIM_NEVER;
+
+			if (!txActive && txCount)
+			{
+				simulator->startPayload(*this, now + settleNs);
+			}
+		}
+	}
+	else if (reg == RF_CH && wasReceiving)
+	{
+		rxSince = now + settleNs;
+	}
+}
+
+/**
+ * Store received payload in RX FIFO
+ *
+ * @param payload 	payload
+ * @param len     	payload length
+ * @param pipe    	receiving pipe
+ * @param at      	arrival time in nanoseconds
+ */
+void SimulatedChip::push(const unsigned char *payload, int len, int pipe, unsigned long long at)
+{
+	std::memcpy(rxFifo[rxCount], payload, len);
+	rxLength[rxCount] = len;
+	rxPipe[rxCount] = pipe;
+	rxAt[rxCount] = at;
+	rxCount++;
+
+	if (at < rxFlagAt)
+	{
+		rxFlagAt = at;
+	}
+}
+
+/**
+ * Count RX FIFO entries that arrived by the chip clock, at most three
+ *
+ * A node running ahead may put packets on air that end after the clock
+ * of a node running behind, those stay hidden until it catches up. The
+ * receiver may have drained its FIFO by then, so they are held beyond the
+ * three entries of the chip.
+ *
+ * @return  arrived entries
+ */
+int SimulatedChip::arrived(void)
+{
+	int count = 0;
+
+	while (count < rxCount && count < 3 && rxAt[count] <= now)
+	{
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * Remove head of RX FIFO
+ */
+void SimulatedChip::pop(void)
+{
+	for (int i = 1; i < rxCount; i++)
+	{
+		std::memcpy(rxFifo[i - 1], rxFifo[i], 32);
+		rxLength[i - 1] = rxLength[i];
+		rxPipe[i - 1] = rxPipe[i];
+		rxAt[i - 1] = rxAt[i];
+	}
+
+	rxCount--;
+}
+
+/**
+ * Check whether chip is powered up
+ *
+ * @return  true if PWR_UP is set
+ */
+bool SimulatedChip::enabled(void)
+{
+	return PowerUp::decode(registers[CONFIG][0]);
+}
+
+/**
+ * Check whether chip is in RX mode
+ *
+ * @return  true if powered up with PRIM_RX and CE set
+ */
+bool SimulatedChip::receiving(void)
+{
+	return enabled() && ce && PrimaryRX::decode(registers[CONFIG][0]) && rxSince != SIM_NEVER;
+}
+
+/**
+ * Get address width
+ *
+ * @return  address width in bytes
+ */
+int SimulatedChip::addressSize(void)
+{
+	int aw = AddressWidth::decode(registers[SETUP_AW][0]);
+
+	return aw ? aw + 2 : 5;
+}
+
+/**
+ * Get CRC length
+ *
+ * @return  CRC length
+ */
+CRCLength SimulatedChip::crcLength(void)
+{
+	unsigned char encoding = CRCEncoding::decode(registers[CONFIG][0]);
+
+	return encoding == 0b11 ? CRC_2_BYTE : encoding == 0b10 ? CRC_1_BYTE : CRC_DISABLED;
+}
+
+/**
+ * Get air data rate
+ *
+ * @return  data rate
+ */
+DataRate SimulatedChip::dataRate(void)
+{
+	unsigned char setup = registers[RF_SETUP][0];
+
+	return AirDataRateLow::decode(setup) ? RF_DR_250KBPS : AirDataRate::decode(setup) ? RF_DR_2MBPS : RF_DR_1MBPS;
+}
+
+/**
+ * Get output power
+ *
+ * @return  output power in dBm
+ */
+double SimulatedChip::power(void)
+{
+	return -18 + 6 * PowerLevel::decode(registers[RF_SETUP][0]);
+}
+
+ORF24Simulator::ORF24Simulator(unsigned int seed)
+	: random(seed)
+{ }
+
+ORF24Simulator::~ORF24Simulator()
+{
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		delete nodes[i].radio;
+		delete nodes[i].chip;
+	}
+}
+
+/**
+ * Add node
+ *
+ * @param  application 	node application
+ * @param  x           	position in meters
+ * @param  y           	position in meters
+ * @return             	node index
+ */
+int ORF24Simulator::addNode(SimulatedNode *application, double x, double y)
+{
+	Node node;
+	int id = nodes.size();
+
+	node.application = application;
+	node.chip = new SimulatedChip(this, id, x, y);
+	node.radio = new ORF24(id, 0, 8000000, node.chip);
+	nodes.push_back(node);
+
+	node.chip->now = time;
+	application->setup(*node.radio);
+
+	Event event = {node.chip->now, sequence++, 0, id, 0, 0};
+	nodeEvents.push(event);
+
+	return id;
+}
+
+/**
+ * Set log-distance path loss model
+ *
+ * @param _referenceLoss 	loss at 1 m in dB
+ * @param _exponent      	path loss exponent, 2 in free space
+ */
+void ORF24Simulator::setPathLoss(double _referenceLoss, double _exponent)
+{
+	referenceLoss = _referenceLoss;
+	exponent = _exponent;
+}
+
+/**
+ * Set bit error rate of packets above sensitivity
+ *
+ * @param ber 	bit error rate
+ */
+void ORF24Simulator::setBitErrorRate(double ber)
+{
+	bitErrorRate = ber;
+}
+
+/**
+ * Set how much stronger a packet must be than interference to survive
+ *
+ * @param db 	capture threshold in dB
+ */
+void ORF24Simulator::setCaptureThreshold(double db)
+{
+	capture = db;
+}
+
+/**
+ * Set time spent per SPI transfer on top of the clocked bits
+ *
+ * @param us 	overhead in microseconds
+ */
+void ORF24Simulator::setSPIOverhead(unsigned int us)
+{
+	spiOverhead = us;
+}
+
+/**
+ * Schedule a medium event
+ *
+ * @param at         	event time in nanoseconds
+ * @param type       	event type
+ * @param chip       	chip the event belongs to
+ * @param generation 	chip generation
+ * @param tx         	transmission ID
+ */
+void ORF24Simulator::schedule(unsigned long long at, int type, int chip, int generation, unsigned long tx)
+{
+	Event event = {at, sequence++, type, chip, generation, tx};
+
+	radioEvents.push(event);
+}
+
+/**
+ * Process medium events up to the chip clock
+ *
+ * @param chip 	chip about to access its registers
+ */
+void ORF24Simulator::advance(SimulatedChip &chip)
+{
+	while (!radioEvents.empty() && radioEvents.top().time <= chip.now)
+	{
+		Event event = radioEvents.top();
+
+		radioEvents.pop();
+		process(event);
+	}
+}
+
+/**
+ * Process one medium event
+ *
+ * @param event 	event
+ */
+void ORF24Simulator::process(const Event &event)
+{
+	if (event.time > time)
+	{
+		time = event.time;
+	}
+
+	while (!transmissions.empty() && transmissions.front().end + historyNs < time)
+	{
+		transmissions.pop_front();
+		firstTransmission++;
+	}
+
+	SimulatedChip &chip = *nodes[event.chip].chip;
+	bool current = event.generation == chip.generation && chip.txActive;
+
+	if (event.type == SIM_TX_END)
+	{
+		endTransmission(event.tx, current);
+	}
+	else if (event.type == SIM_ACK_END && current)
+	{
+		endAck(chip, event.tx);
+	}
+	else if (event.type == SIM_RETRY && current)
+	{
+		retry(chip, event.time);
+	}
+}
+
+/**
+ * Get transmission by ID
+ *
+ * @param  id 	transmission ID
+ * @return    	transmission, NULL if already dropped
+ */
+SimulatedTransmission *ORF24Simulator::transmission(unsigned long id)
+{
+	if (id < firstTransmission || id - firstTransmission >= transmissions.size())
+	{
+		return NULL;
+	}
+
+	return &transmissions[id - firstTransmission];
+}
+
+/**
+ * Put head of TX FIFO or an ACK on air
+ *
+ * @param  chip  	transmitting chip
+ * @param  start 	start time in nanoseconds
+ * @param  ack   	whether to send an ACK for data
+ * @param  data  	packet being acknowledged
+ * @return       	transmission ID
+ */
+unsigned long ORF24Simulator::transmit(SimulatedChip &chip, unsigned long long start, bool ack, const SimulatedTransmission *data)
+{
+	SimulatedTransmission tx;
+
+	tx.sender = chip.id;
+	tx.start = start;
+	tx.channel = Channel::decode(chip.registers[RF_CH][0]);
+	tx.power = chip.power();
+	tx.ack = ack;
+
+	if (ack)
+	{
+		tx.rate = data->rate;
+		tx.crc = data->crc;
+		tx.noAck = true;
+		tx.pid = data->pid;
+		tx.addressSize = data->addressSize;
+		std::memcpy(tx.address, data->address, 5);
+		tx.len = 0;
+
+		statistics.acks++;
+	}
+	else
+	{
+		tx.rate = chip.dataRate();
+		tx.crc = chip.crcLength();
+		tx.noAck = chip.txNoAck[0];
+		tx.pid = chip.pid;
+		tx.addressSize = chip.addressSize();
+		std::memcpy(tx.address, chip.registers[TX_ADDR], 5);
+		tx.len = chip.txLength[0];
+		std::memcpy(tx.payload, chip.txFifo[0], tx.len);
+
+		statistics.transmissions++;
+	}
+
+	tx.end = start + packetAirTime(tx.rate, tx.len, tx.crc, tx.addressSize) * 1000ULL;
+
+	transmissions.push_back(tx);
+
+	return firstTransmission + transmissions.size() - 1;
+}
+
+/**
+ * Start sending head of TX FIFO
+ *
+ * @param chip  	transmitting chip
+ * @param start 	start time in nanoseconds
+ */
+void ORF24Simulator::startPayload(SimulatedChip &chip, unsigned long long start)
+{
+	chip.txActive = true;
+	chip.attempt = 0;
+	chip.pid++;
+	chip.registers[OBSERVE_TX][0] = RetransmitCounter::update(chip.registers[OBSERVE_TX][0], 0);
+
+	unsigned long id = transmit(chip, start, false, NULL);
+
+	schedule(transmission(id)->end, SIM_TX_END, chip.id, chip.generation, id);
+}
+
+/**
+ * Deliver a packet that finished and start the ACK or retry
+ *
+ * @param id      	transmission ID
+ * @param current 	whether the sender is still sending this payload
+ */
+void ORF24Simulator::endTransmission(unsigned long id, bool current)
+{
+	SimulatedTransmission tx = *transmission(id);
+	SimulatedChip &sender = *nodes[tx.sender].chip;
+	int ackFrom = -1;
+
+	for (size_t r = 0; r < nodes.size(); r++)
+	{
+		SimulatedChip &chip = *nodes[r].chip;
+
+		if ((int) r == tx.sender || !chip.receiving() || chip.rxSince > tx.start)
+		{
+			continue;
+		}
+
+		if (Channel::decode(chip.registers[RF_CH][0]) != tx.channel || chip.dataRate() != tx.rate ||
+			chip.crcLength() != tx.crc || chip.addressSize() != tx.addressSize)
+		{
+			continue;
+		}
+
+		int pipe = -1;
+
+		for (int p = 0; p < 6 && pipe < 0; p++)
+		{
+			if (!(chip.registers[EN_RXADDR][0] & (1 << p)))
+			{
+				continue;
+			}
+
+			unsigned char address[5];
+
+			std::memcpy(address, chip.registers[p == 0 ? RX_ADDR_P0 : RX_ADDR_P1], 5);
+
+			if (p > 1)
+			{
+				address[0] = chip.registers[RX_ADDR_P0 + p][0];
+			}
+
+			if (std::memcmp(address, tx.address, tx.addressSize) == 0)
+			{
+				pipe = p;
+			}
+		}
+
+		if (pipe < 0)
+		{
+			continue;
+		}
+
+		bool dynamic = (chip.registers[FEATURE][0] & (1 << EN_DPL)) && (chip.registers[DYNPD][0] & (1 << pipe));
+
+		/* Static payload width must match, otherwise the CRC fails */
+		if (!dynamic && chip.registers[RX_PW_P0 + pipe][0] != tx.len)
+		{
+			statistics.crcErrors++;
+			continue;
+		}
+
+		int result = heard(tx, r, id);
+
+		if (result == 1)
+		{
+			statistics.weakSignal++;
+			continue;
+		}
+		else if (result == 2)
+		{
+			statistics.collisions++;
+			continue;
+		}
+		else if (result == 3)
+		{
+			statistics.crcErrors++;
+			continue;
+		}
+
+		bool autoAck = (chip.registers[EN_AA][0] & (1 << pipe)) && !tx.noAck;
+		unsigned int crc = checksum(tx.payload, tx.len);
+
+		if (autoAck && chip.lastPID[pipe] == tx.pid && chip.lastCRC[pipe] == crc)
+		{
+			statistics.duplicates++;
+		}
+		else if (chip.rxCount == SIM_RX_SLOTS || (chip.arrived() == 3 && chip.rxAt[2] <= tx.end))
+		{
+			/* No ACK either, the sender retries */
+			statistics.overflows++;
+			continue;
+		}
+		else
+		{
+			chip.push(tx.payload, tx.len, pipe, tx.end);
+			chip.lastPID[pipe] = tx.pid;
+			chip.lastCRC[pipe] = crc;
+
+			statistics.delivered++;
+		}
+
+		if (autoAck && ackFrom < 0)
+		{
+			ackFrom = r;
+		}
+	}
+
+	if (!current)
+	{
+		return;
+	}
+
+	bool expectAck = (sender.registers[EN_AA][0] & 1) && !tx.noAck;
+
+	if (!expectAck)
+	{
+		complete(sender, tx.end);
+	}
+	else if (ackFrom >= 0)
+	{
+		unsigned long ack = transmit(*nodes[ackFrom].chip, tx.end + settleNs, true, &tx);
+
+		schedule(transmission(ack)->end, SIM_ACK_END, sender.id, sender.generation, ack);
+	}
+	else
+	{
+		schedule(tx.end + (RetransmitDelay::decode(sender.registers[SETUP_RETR][0]) + 1) * 250000ULL,
+			SIM_RETRY, sender.id, sender.generation, 0);
+	}
+}
+
+/**
+ * Check whether the sender got the ACK
+ *
+ * @param sender 	chip waiting for the ACK
+ * @param id     	ACK transmission ID
+ */
+void ORF24Simulator::endAck(SimulatedChip &sender, unsigned long id)
+{
+	SimulatedTransmission ack = *transmission(id);
+	unsigned long long dataEnd = ack.start - settleNs;
+	unsigned long long ard = (RetransmitDelay::decode(sender.registers[SETUP_RETR][0]) + 1) * 250000ULL;
+
+	/* The ACK comes back on TX_ADDR, the sender hears it on pipe 0 only */
+	if (!(sender.registers[EN_RXADDR][0] & 1) ||
+		std::memcmp(sender.registers[RX_ADDR_P0], ack.address, ack.addressSize) != 0)
+	{
+		statistics.lostAcks++;
+		statistics.misaddressedAcks++;
+		schedule(dataEnd + ard, SIM_RETRY, sender.id, sender.generation, 0);
+		return;
+	}
+
+	/* ARD shorter than the ACK, the sender stopped listening before it ended */
+	if (ack.end - dataEnd > ard || heard(ack, sender.id, id) != 0)
+	{
+		statistics.lostAcks++;
+		schedule(dataEnd + ard, SIM_RETRY, sender.id, sender.generation, 0);
+		return;
+	}
+
+	complete(sender, ack.end);
+}
+
+/**
+ * Retransmit or give up with MAX_RT
+ *
+ * @param chip 	sending chip
+ * @param at   	retransmission time in nanoseconds
+ */
+void ORF24Simulator::retry(SimulatedChip &chip, unsigned long long at)
+{
+	unsigned char &observe = chip.registers[OBSERVE_TX][0];
+
+	if (chip.attempt >= RetransmitCount::decode(chip.registers[SETUP_RETR][0]))
+	{
+		int lost = LostPackets::decode(observe);
+
+		observe = LostPackets::update(observe, lost < 15 ? lost + 1 : 15);
+		chip.flags |= 1 << MAX_RT;
+		chip.txActive = false;
+
+		statistics.failed++;
+		return;
+	}
+
+	chip.attempt++;
+	observe = RetransmitCounter::update(observe, chip.attempt);
+
+	/* Global time may be ahead, set by a node running ahead */
+	unsigned long id = transmit(chip, at, false, NULL);
+
+	schedule(transmission(id)->end, SIM_TX_END, chip.id, chip.generation, id);
+}
+
+/**
+ * Finish payload with TX_DS
+ *
+ * @param chip 	sending chip
+ * @param at   	completion time in nanoseconds
+ */
+void ORF24Simulator::complete(SimulatedChip &chip, unsigned long long at)
+{
+	chip.flags |= 1 << TX_DS;
+	chip.txActive = false;
+
+	for (int i = 1; i < chip.txCount; i++)
+	{
+		std::memcpy(chip.txFifo[i - 1], chip.txFifo[i], 32);
+		chip.txLength[i - 1] = chip.txLength[i];
+		chip.txNoAck[i - 1] = chip.txNoAck[i];
+	}
+
+	chip.txCount--;
+
+	statistics.sent++;
+
+	if (chip.ce && chip.enabled() && !PrimaryRX::decode(chip.registers[CONFIG][0]) && chip.txCount)
+	{
+		startPayload(chip, at + settleNs);
+	}
+}
+
+/**
+ * Check whether a receiver decodes a transmission
+ *
+ * @param  tx       	transmission
+ * @param  receiver 	receiving chip
+ * @param  id       	transmission ID
+ * @return          	0 if received, 1 below sensitivity, 2 collision, 3 bit error
+ */
+int ORF24Simulator::heard(const SimulatedTransmission &tx, int receiver, unsigned long id)
+{
+	double signal = tx.power - pathLoss(tx.sender, receiver);
+
+	if (signal < sensitivity(tx.rate))
+	{
+		return 1;
+	}
+
+	/* Newest first, transmissions are stored roughly in start order */
+	for (size_t i = transmissions.size(); i-- > 0; )
+	{
+		const SimulatedTransmission &other = transmissions[i];
+
+		if (other.start + longestNs < tx.start)
+		{
+			break;
+		}
+
+		if (firstTransmission + i == id || other.sender == receiver || other.channel != tx.channel ||
+			other.start >= tx.end || other.end <= tx.start)
+		{
+			continue;
+		}
+
+		if (other.power - pathLoss(other.sender, receiver) > signal - capture)
+		{
+			return 2;
+		}
+	}
+
+	int bits = (1 + tx.addressSize + tx.len) * 8 + 9 + (tx.crc == CRC_2_BYTE ? 16 : tx.crc == CRC_1_BYTE ? 8 : 0);
+
+	if (bitErrorRate > 0)
+	{
+		std::uniform_real_distribution<double> uniform(0, 1);
+
+		if (uniform(random) < 1 - std::pow(1 - bitErrorRate, bits))
+		{
+			return 3;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Log-distance path loss between two chips
+ *
+ * @param  from 	transmitting chip
+ * @param  to   	receiving chip
+ * @return      	loss in dB
+ */
+double ORF24Simulator::pathLoss(int from, int to)
+{
+	SimulatedChip &a = *nodes[from].chip;
+	SimulatedChip &b = *nodes[to].chip;
+	double distance = std::hypot(a.x - b.x, a.y - b.y);
+
+	return referenceLoss + 10 * exponent * std::log10(distance < 1 ? 1 : distance);
+}
+
+/**
+ * Receiver sensitivity
+ *
+ * @param  rate 	air data rate
+ * @return      	sensitivity in dBm
+ */
+double ORF24Simulator::sensitivity(DataRate rate)
+{
+	return rate == RF_DR_250KBPS ? -94 : rate == RF_DR_2MBPS ? -82 : -85;
+}
+
+/**
+ * Check for a carrier above the CD threshold
+ *
+ * @param  chip 	listening chip
+ * @return      	true if a transmission above -64 dBm is on air
+ */
+bool ORF24Simulator::carrier(SimulatedChip &chip)
+{
+	int channel = Channel::decode(chip.registers[RF_CH][0]);
+
+	for (size_t i = transmissions.size(); i-- > 0; )
+	{
+		const SimulatedTransmission &tx = transmissions[i];
+
+		if (tx.start + longestNs < chip.now)
+		{
+			break;
+		}
+
+		if (tx.channel == channel && tx.sender != chip.id && tx.start <= chip.now && tx.end > chip.now &&
+			tx.power - pathLoss(tx.sender, chip.id) >= -64)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Run until simulated time
+ *
+ * @param untilUs 	end time in microseconds
+ */
+void ORF24Simulator::run(unsigned long long untilUs)
+{
+	unsigned long long until = untilUs * 1000ULL;
+
+	while (true)
+	{
+		bool radioReady = !radioEvents.empty() && radioEvents.top().time <= until;
+		bool nodeReady = !nodeEvents.empty() && nodeEvents.top().time <= until;
+
+		if (radioReady && (!nodeReady || radioEvents.top().time <= nodeEvents.top().time))
+		{
+			Event event = radioEvents.top();
+
+			radioEvents.pop();
+			process(event);
+		}
+		else if (nodeReady)
+		{
+			Event event = nodeEvents.top();
+			Node &node = nodes[event.chip];
+
+			nodeEvents.pop();
+
+			if (event.time > time)
+			{
+				time = event.time;
+			}
+
+			if (node.chip->now < event.time)
+			{
+				node.chip->now = event.time;
+			}
+
+			long next = node.application->step(*node.radio);
+
+			if (next >= 0)
+			{
+				event.time = node.chip->now + next * 1000ULL;
+				event.sequence = sequence++;
+				nodeEvents.push(event);
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (until > time)
+	{
+		time = until;
+	}
+}
+
+/**
+ * Get node radio
+ *
+ * @param  node 	node index
+ * @return      	radio
+ */
+ORF24 &ORF24Simulator::getRadio(int node)
+{
+	return *nodes[node].radio;
+}
+
+/**
+ * Get node chip
+ *
+ * @param  node 	node index
+ * @return      	chip
+ */
+SimulatedChip &ORF24Simulator::getChip(int node)
+{
+	return *nodes[node].chip;
+}
+
+/**
+ * Get simulated time
+ *
+ * @return  time in microseconds
+ */
+unsigned long long ORF24Simulator::getTime(void)
+{
+	return time / 1000ULL;
+}
+
+/**
+ * Get medium counters
+ *
+ * @return  counters
+ */
+const SimulatorStatistics &ORF24Simulator::getStatistics(void)
+{
+	return statistics;
+}
+
+/**
+ * Run independent simulators on several threads
+ *
+ * @param simulators 	simulators to run
+ * @param untilUs    	end time in microseconds
+ * @param threads    	number of threads, 0 for one per core
+ */
+void ORF24Simulator::runParallel(std::vector<ORF24Simulator *> &simulators, unsigned long long untilUs, int threads)
+{
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+
+	if (threads <= 0)
+	{
+		threads = std::thread::hardware_concurrency();
+	}
+
+	if (threads <= 0)
+	{
+		threads = 1;
+	}
+
+	for (int i = 0; i < threads; i++)
+	{
+		workers.push_back(std::thread([&]()
+		{
+			size_t index;
+
+			while ((index = next++) < simulators.size())
+			{
+				simulators[index]->run(untilUs);
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,560 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_SIMULATOR_H_
+#define _ORF_24_SIMULATOR_H_
+
+#include <deque>
+#include <queue>
+#include <random>
+#include <vector>
+#include "ORF24.h"
+
+#define		SIM_NEVER		0xFFFFFFFFFFFFFFFFULL
+#define		SIM_RX_SLOTS	32
+
+class ORF24Simulator;
+
+/**
+ * Application running on a simulated node
+ *
+ * step() should return quickly, e.g. by using startWrite and pollWrite
+ * instead of write. The medium is only updated up to the node clock while
+ * a step runs, transmissions other nodes start during a long step are not
+ * seen by packets that already ended.
+ */
+class SimulatedNode
+{
+public:
+
+	virtual ~SimulatedNode() { }
+
+	/**
+	 * Initialize the radio, called once at time zero
+	 *
+	 * @param radio 	node radio
+	 */
+	virtual void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+	}
+
+	/**
+	 * Run the node for a while
+	 *
+	 * @param  radio 	node radio
+	 * @return       	microseconds until next step, negative to stop the node
+	 */
+	virtual long step(ORF24 &radio) = 0;
+};
+
+/**
+ * Packet or ACK on air
+ */
+struct SimulatedTransmission
+{
+	int sender;						/* Transmitting chip */
+	unsigned long long start;		/* Start of preamble in nanoseconds */
+	unsigned long long end;			/* End of CRC in nanoseconds */
+	int channel;					/* RF channel */
+	DataRate rate;					/* Air data rate */
+	CRCLength crc;					/* CRC length */
+	double power;					/* Output power in dBm */
+	bool ack;						/* Whether this is an ACK */
+	bool noAck;						/* Whether no ACK is requested */
+	int pid;						/* Packet identity for duplicate detection */
+	int addressSize;				/* Address width in bytes */
+	unsigned char address[5];		/* Destination address */
+	int len;						/* Payload length */
+	unsigned char payload[32];		/* Payload */
+};
+
+/**
+ * Medium counters
+ */
+struct SimulatorStatistics
+{
+	unsigned long transmissions = 0;	/* Packets put on air, retransmissions included */
+	unsigned long acks = 0;			/* ACKs put on air */
+	unsigned long delivered = 0;	/* Packets stored in an RX FIFO */
+	unsigned long duplicates = 0;	/* Retransmissions dropped by the receiver */
+	unsigned long collisions = 0;	/* Packets lost to interference */
+	unsigned long weakSignal = 0;	/* Packets below receiver sensitivity */
+	unsigned long crcErrors = 0;	/* Packets lost to bit errors */
+	unsigned long overflows = 0;	/* Packets dropped on a full RX FIFO */
+	unsigned long lostAcks = 0;		/* ACKs not received by the sender */
+	unsigned long misaddressedAcks = 0;	/* Lost ACKs, sender pipe 0 not on TX_ADDR */
+	unsigned long sent = 0;			/* Payloads that raised TX_DS */
+	unsigned long failed = 0;		/* Payloads that raised MAX_RT */
+};
+
+/**
+ * nRF24L01+ model behind the transport interface
+ *
+ * Decodes the SPI commands the driver sends and keeps registers and FIFOs.
+ * Every transfer and delay advances the chip clock, SPI at the configured
+ * clock plus a fixed per transfer overhead.
+ */
+class SimulatedChip : public ORF24Transport
+{
+	friend class ORF24Simulator;
+
+private:
+	ORF24Simulator *simulator;		/* Medium the chip is on */
+	int id;							/* Chip index */
+	double x;						/* Position in meters */
+	double y;
+	unsigned long long now = 0;		/* Chip clock in nanoseconds */
+	long long clockOffset = 0;		/* Host clock offset in nanoseconds */
+	double clockDrift = 0;			/* Host clock drift in ppm */
+	int spiSpeed = 8000000;			/* SPI clock in Hz */
+	bool ce = false;				/* CE pin level */
+	unsigned char registers[0x20][5];	/* Register file */
+	unsigned char flags = 0;		/* STATUS interrupt flags */
+	unsigned char txFifo[3][32];	/* TX FIFO */
+	int txLength[3];
+	bool txNoAck[3];
+	int txCount = 0;
+	unsigned char rxFifo[SIM_RX_SLOTS][32];	/* RX FIFO, with room for packets not arrived yet */
+	int rxLength[SIM_RX_SLOTS];
+	int rxPipe[SIM_RX_SLOTS];
+	unsigned long long rxAt[SIM_RX_SLOTS];	/* Arrival time per RX FIFO entry */
+	int rxCount = 0;
+	unsigned long long rxFlagAt = SIM_NEVER;	/* Time RX_DR is raised */
+	bool txActive = false;			/* Whether head of TX FIFO is being sent */
+	int attempt = 0;				/* Retransmissions of current payload */
+	int generation = 0;				/* Invalidates events of aborted payloads */
+	int pid = 0;					/* Packet identity of current payload */
+	int lastPID[6];					/* Last packet identity per pipe */
+	unsigned int lastCRC[6];		/* Last payload checksum per pipe */
+	unsigned long long rxSince = SIM_NEVER;	/* Time RX settled */
+
+	/**
+	 * Build STATUS register
+	 *
+	 * @return  STATUS value
+	 */
+	unsigned char status(void);
+
+	/**
+	 * Read register
+	 *
+	 * @param reg 	register address
+	 * @param buf 	read buffer
+	 * @param len 	data length
+	 */
+	void readRegister(unsigned char reg, unsigned char *buf, int len);
+
+	/**
+	 * Write register
+	 *
+	 * @param reg 	register address
+	 * @param buf 	data to write
+	 * @param len 	data length
+	 */
+	void writeRegister(unsigned char reg, const unsigned char *buf, int len);
+
+	/**
+	 * Store received payload in RX FIFO
+	 *
+	 * @param payload 	payload
+	 * @param len     	payload length
+	 * @param pipe    	receiving pipe
+	 * @param at      	arrival time in nanoseconds
+	 */
+	void push(const unsigned char *payload, int len, int pipe, unsigned long long at);
+
+	/**
+	 * Count RX FIFO entries that arrived by the chip clock, at most three
+	 *
+	 * @return  arrived entries
+	 */
+	int arrived(void);
+
+	/**
+	 * Remove head of RX FIFO
+	 */
+	void pop(void);
+
+	/**
+	 * Check whether chip is powered up
+	 *
+	 * @return  true if PWR_UP is set
+	 */
+	bool enabled(void);
+
+	/**
+	 * Check whether chip is in RX mode
+	 *
+	 * @return  true if powered up with PRIM_RX and CE set
+	 */
+	bool receiving(void);
+
+	/**
+	 * Get address width
+	 *
+	 * @return  address width in bytes
+	 */
+	int addressSize(void);
+
+	/**
+	 * Get CRC length
+	 *
+	 * @return  CRC length
+	 */
+	CRCLength crcLength(void);
+
+	/**
+	 * Get air data rate
+	 *
+	 * @return  data rate
+	 */
+	DataRate dataRate(void);
+
+	/**
+	 * Get output power
+	 *
+	 * @return  output power in dBm
+	 */
+	double power(void);
+
+public:
+
+	/**
+	 * SimulatedChip Constructor
+	 *
+	 * @param _simulator 	medium
+	 * @param _id 			chip index
+	 * @param _x 			position in meters
+	 * @param _y 			position in meters
+	 */
+	SimulatedChip(ORF24Simulator *_simulator, int _id, double _x, double _y);
+
+	bool setup(int ce, int spiChannel, int spiSpeed);
+	bool setSpeed(int spiChannel, int spiSpeed);
+	void transfer(int spiChannel, unsigned char *buf, int len);
+	void writeCE(int ce, int value);
+	void delayMicroseconds(unsigned int us);
+	unsigned int millis(void);
+	unsigned int micros(void);
+	unsigned long long nanos(void);
+
+	/**
+	 * Give the host clock of the node an offset and drift
+	 *
+	 * Only millis, micros and nanos are affected, delays and the medium
+	 * run on simulated time.
+	 *
+	 * @param offset 	offset in nanoseconds
+	 * @param ppm    	drift in parts per million
+	 */
+	void setClock(long long offset, double ppm);
+
+	/**
+	 * Get chip clock
+	 *
+	 * @return  time in nanoseconds
+	 */
+	unsigned long long getTime(void);
+};
+
+/**
+ * Discrete event simulator of nRF24L01+ networks
+ *
+ * Runs unmodified ORF24 drivers against simulated chips on a shared
+ * medium. Packets take their Enhanced ShockBurst air time for the data
+ * rate and CRC length and are received when the address, channel, rate
+ * and payload width match, the signal is above sensitivity after
+ * log-distance path loss, no overlapping transmission on the channel is
+ * within the capture threshold and no bit error hits the packet. ACKs,
+ * ARD and ARC follow SETUP_RETR, and retransmissions are filtered by
+ * packet identity. The sender only hears an ACK with pipe 0 enabled on
+ * its TX_ADDR. Adjacent channel interference is not modelled.
+ *
+ * One simulator runs on one thread. Independent simulations, such as the
+ * points of a parameter sweep, run on all cores with runParallel().
+ */
+class ORF24Simulator
+{
+	friend class SimulatedChip;
+
+private:
+	struct Node
+	{
+		SimulatedNode *application;
+		SimulatedChip *chip;
+		ORF24 *radio;
+	};
+
+	struct Event
+	{
+		unsigned long long time;	/* Event time in nanoseconds */
+		unsigned long sequence;		/* Keeps events at the same time in order */
+		int type;					/* Event type */
+		int chip;					/* Chip the event belongs to */
+		int generation;				/* Chip generation when scheduled */
+		unsigned long tx;			/* Transmission the event refers to */
+
+		bool operator>(const Event &other) const
+		{
+			return time != other.time ? time > other.time : sequence > other.sequence;
+		}
+	};
+
+	typedef std::priority_queue<Event, std::vector<Event>, std::greater<Event> > EventQueue;
+
+	std::vector<Node> nodes;		/* Simulated nodes */
+	EventQueue radioEvents;			/* Medium events */
+	EventQueue nodeEvents;			/* Application steps */
+	std::deque<SimulatedTransmission> transmissions;	/* Recent transmissions */
+	unsigned long firstTransmission = 0;	/* ID of transmissions.front() */
+	unsigned long sequence = 0;		/* Event sequence counter */
+	unsigned long long time = 0;	/* Time of last processed event */
+	std::mt19937 random;			/* Bit error generator */
+	double referenceLoss = 40;		/* Path loss at 1 m in dB */
+	double exponent = 3;			/* Path loss exponent */
+	double bitErrorRate = 1e-6;		/* Bit error rate above sensitivity */
+	double capture = 10;			/* Capture threshold in dB */
+	unsigned int spiOverhead = 5;	/* Per transfer SPI overhead in microseconds */
+	SimulatorStatistics statistics;
+
+	/**
+	 * Schedule a medium event
+	 *
+	 * @param at         	event time in nanoseconds
+	 * @param type       	event type
+	 * @param chip       	chip the event belongs to
+	 * @param generation 	chip generation
+	 * @param tx         	transmission ID
+	 */
+	void schedule(unsigned long long at, int type, int chip, int generation, unsigned long tx);
+
+	/**
+	 * Process medium events up to the chip clock
+	 *
+	 * @param chip 	chip about to access its registers
+	 */
+	void advance(SimulatedChip &chip);
+
+	/**
+	 * Process one medium event
+	 *
+	 * @param event 	event
+	 */
+	void process(const Event &event);
+
+	/**
+	 * Get transmission by ID
+	 *
+	 * @param  id 	transmission ID
+	 * @return    	transmission, NULL if already dropped
+	 */
+	SimulatedTransmission *transmission(unsigned long id);
+
+	/**
+	 * Put head of TX FIFO or an ACK on air
+	 *
+	 * @param  chip  	transmitting chip
+	 * @param  start 	start time in nanoseconds
+	 * @param  ack   	whether to send an ACK for data
+	 * @param  data  	packet being acknowledged
+	 * @return       	transmission ID
+	 */
+	unsigned long transmit(SimulatedChip &chip, unsigned long long start, bool ack, const SimulatedTransmission *data);
+
+	/**
+	 * Start sending head of TX FIFO
+	 *
+	 * @param chip  	transmitting chip
+	 * @param start 	start time in nanoseconds
+	 */
+	void startPayload(SimulatedChip &chip, unsigned long long start);
+
+	/**
+	 * Deliver a packet that finished and start the ACK or retry
+	 *
+	 * @param id      	transmission ID
+	 * @param current 	whether the sender is still sending this payload
+	 */
+	void endTransmission(unsigned long id, bool current);
+
+	/**
+	 * Check whether the sender got the ACK
+	 *
+	 * @param sender 	chip waiting for the ACK
+	 * @param id     	ACK transmission ID
+	 */
+	void endAck(SimulatedChip &sender, unsigned long id);
+
+	/**
+	 * Retransmit or give up with MAX_RT
+	 *
+	 * @param chip 	sending chip
+	 * @param at   	retransmission time in nanoseconds
+	 */
+	void retry(SimulatedChip &chip, unsigned long long at);
+
+	/**
+	 * Finish payload with TX_DS
+	 *
+	 * @param chip 	sending chip
+	 * @param at   	completion time in nanoseconds
+	 */
+	void complete(SimulatedChip &chip, unsigned long long at);
+
+	/**
+	 * Check whether a receiver decodes a transmission
+	 *
+	 * @param  tx       	transmission
+	 * @param  receiver 	receiving chip
+	 * @param  id       	transmission ID
+	 * @return          	0 if received, 1 below sensitivity, 2 collision, 3 bit error
+	 */
+	int heard(const SimulatedTransmission &tx, int receiver, unsigned long id);
+
+	/**
+	 * Log-distance path loss between two chips
+	 *
+	 * @param  from 	transmitting chip
+	 * @param  to   	receiving chip
+	 * @return      	loss in dB
+	 */
+	double pathLoss(int from, int to);
+
+	/**
+	 * Receiver sensitivity
+	 *
+	 * @param  rate 	air data rate
+	 * @return      	sensitivity in dBm
+	 */
+	double sensitivity(DataRate rate);
+
+	/**
+	 * Check for a carrier above the CD threshold
+	 *
+	 * @param  chip 	listening chip
+	 * @return      	true if a transmission above -64 dBm is on air
+	 */
+	bool carrier(SimulatedChip &chip);
+
+public:
+
+	/**
+	 * ORF24Simulator Constructor
+	 *
+	 * @param seed 	random seed
+	 */
+	ORF24Simulator(unsigned int seed = 1);
+
+	~ORF24Simulator();
+
+	/**
+	 * Add node
+	 *
+	 * The simulator does not take ownership of the application.
+	 *
+	 * @param  application 	node application
+	 * @param  x           	position in meters
+	 * @param  y           	position in meters
+	 * @return             	node index
+	 */
+	int addNode(SimulatedNode *application, double x, double y);
+
+	/**
+	 * Set log-distance path loss model
+	 *
+	 * @param _referenceLoss 	loss at 1 m in dB
+	 * @param _exponent      	path loss exponent, 2 in free space
+	 */
+	void setPathLoss(double _referenceLoss, double _exponent);
+
+	/**
+	 * Set bit error rate of packets above sensitivity
+	 *
+	 * @param ber 	bit error rate
+	 */
+	void setBitErrorRate(double ber);
+
+	/**
+	 * Set how much stronger a packet must be than interference to survive
+	 *
+	 * @param db 	capture threshold in dB
+	 */
+	void setCaptureThreshold(double db);
+
+	/**
+	 * Set time spent per SPI transfer on top of the clocked bits
+	 *
+	 * @param us 	overhead in microseconds
+	 */
+	void setSPIOverhead(unsigned int us);
+
+	/**
+	 * Run until simulated time
+	 *
+	 * @param untilUs 	end time in microseconds
+	 */
+	void run(unsigned long long untilUs);
+
+	/**
+	 * Get node radio
+	 *
+	 * @param  node 	node index
+	 * @return      	radio
+	 */
+	ORF24 &getRadio(int node);
+
+	/**
+	 * Get node chip
+	 *
+	 * @param  node 	node index
+	 * @return      	chip
+	 */
+	SimulatedChip &getChip(int node);
+
+	/**
+	 * Get simulated time
+	 *
+	 * @return  time in microseconds
+	 */
+	unsigned long long getTime(void);
+
+	/**
+	 * Get medium counters
+	 *
+	 * @return  counters
+	 */
+	const SimulatorStatistics &getStatistics(void);
+
+	/**
+	 * Run independent simulators on several threads
+	 *
+	 * @param simulators 	simulators to run
+	 * @param untilUs    	end time in microseconds
+	 * @param threads    	number of threads, 0 for one per core
+	 */
+	static void runParallel(std::vector<ORF24Simulator *> &simulators, unsigned long long untilUs, int threads);
+};
+
+#endif
\ No newline at end of file
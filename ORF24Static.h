@@ -0,0 +1,387 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_STATIC_H_
+#define _ORF_24_STATIC_H_
+
+#include "nRF24L01.h"
+#include "nRF24L01Register.h"
+#include "nRF24L01Driver.h"
+#include "ORF24Transport.h"
+
+/**
+ * nRF24L01 driver for fixed hardware
+ *
+ * Pins, SPI channel, payload size and transport are template parameters, so
+ * payload copies have a constant length and transport calls are bound at
+ * compile time. Register sequences, encoding and SPI frames are shared with
+ * ORF24 through nRF24L01::Driver.
+ *
+ * @tparam CE 			CE pin number
+ * @tparam SPIChannel 	Odroid SPI channel
+ * @tparam PayloadSize 	nRF24L01 payload size
+ * @tparam Transport 	SPI and GPIO access
+ */
+template <int CE, int SPIChannel, int PayloadSize, class Transport = WiringPiTransport>
+class ORF24Static
+{
+	friend struct nRF24L01::Driver<ORF24Static>;
+
+	typedef nRF24L01::Driver<ORF24Static> Driver;
+
+	static_assert(PayloadSize > 0 && PayloadSize <= 32, "Payload size must be between 1 and 32");
+	static_assert(SPIChannel == 0 || SPIChannel == 1, "Odroid has SPI channel 0 and 1");
+
+private:
+	static constexpr int addressSize = 5;
+	static constexpr int bufferSize = (PayloadSize > addressSize ? PayloadSize : addressSize) + 1;
+
+	Transport transport;			/* SPI and GPIO access */
+	int spiSpeed;					/* SPI clock frequency in Hz */
+	unsigned char buffer[bufferSize];	/* RX and TX buffer */
+	unsigned char setupRetr = 0;	/* SETUP_RETR last written */
+
+protected:
+
+	/**
+	 * Read one byte from nRF24L01 register
+	 *
+	 * @param  	reg 	register address
+	 * @return     		read register value
+	 */
+	unsigned char readRegister(unsigned char reg)
+	{
+		nRF24L01::readRegisterFrame(buffer, reg, 1);
+		transport.transfer(SPIChannel, buffer, 2);
+
+		return buffer[1];
+	}
+
+	/**
+	 * Read multibyte from nRF24L01 register
+	 *
+	 * @param  	reg 	register address
+	 * @param 	buf 	read buffer
+	 * @param 	len 	data length to read, at most the address width
+	 * @return     		nRF24L01 status
+	 */
+	unsigned char readRegister(unsigned char reg, unsigned char *buf, int len)
+	{
+		nRF24L01::readRegisterFrame(buffer, reg, len);
+		transport.transfer(SPIChannel, buffer, len + 1);
+		std::memcpy(buf, buffer + 1, len);
+
+		return buffer[0];
+	}
+
+	/**
+	 * Write one byte to nRF24L01 register
+	 *
+	 * @param  reg   	register address
+	 * @param  value 	value to write
+	 * @return       	nRF24L01 status
+	 */
+	unsigned char writeRegister(unsigned char reg, unsigned char value)
+	{
+		nRF24L01::writeRegisterFrame(buffer, reg, &value, 1);
+		transport.transfer(SPIChannel, buffer, 2);
+
+		return buffer[0];
+	}
+
+	/**
+	 * Write multibyte to nRF24L01 register
+	 *
+	 * @param  reg   	register address
+	 * @param  buf 		write buffer
+	 * @param  len 		data length to write, at most the address width
+	 * @return       	nRF24L01 status
+	 */
+	unsigned char writeRegister(unsigned char reg, const unsigned char *buf, int len)
+	{
+		nRF24L01::writeRegisterFrame(buffer, reg, buf, len);
+		transport.transfer(SPIChannel, buffer, len + 1);
+
+		return buffer[0];
+	}
+
+	/**
+	 * Write payload to send
+	 *
+	 * @param  data 	data to send, PayloadSize bytes
+	 * @return      	nRF24L01 status
+	 */
+	unsigned char writePayload(const unsigned char *data)
+	{
+		nRF24L01::commandFrame(buffer, W_TX_PAYLOAD, data, PayloadSize);
+		transport.transfer(SPIChannel, buffer, PayloadSize + 1);
+
+		return buffer[0];
+	}
+
+	/**
+	 * Send a single byte command
+	 *
+	 * @param  command 	SPI command
+	 * @return         	nRF24L01 status
+	 */
+	unsigned char command(unsigned char command)
+	{
+		buffer[0] = command;
+		transport.transfer(SPIChannel, buffer, 1);
+
+		return buffer[0];
+	}
+
+public:
+
+	/**
+	 * ORF24Static Constructor
+	 *
+	 * @param _spiSpeed 	SPI clock frequency in Hz
+	 */
+	ORF24Static(int _spiSpeed = 4000000)
+		: spiSpeed(_spiSpeed)
+	{ }
+
+	/**
+	 * ORF24Static Constructor with transport instance
+	 *
+	 * @param _transport 	SPI and GPIO access
+	 * @param _spiSpeed 	SPI clock frequency in Hz
+	 */
+	ORF24Static(const Transport &_transport, int _spiSpeed = 4000000)
+		: transport(_transport),
+		  spiSpeed(_spiSpeed)
+	{ }
+
+	/**
+	 * nRF24L01 Initialization
+	 *
+	 * Waits for the chip to respond and writes the default configuration.
+	 *
+	 * @return  true if chip is present
+	 */
+	bool begin(void)
+	{
+		transport.setup(CE, SPIChannel, spiSpeed);
+
+		/* Power on reset takes up to 100 ms, a warm chip answers immediately */
+		const unsigned long timeout = 150;
+
+		if (!Driver::waitForChip(*this, transport, timeout))
+		{
+			return false;
+		}
+
+		unsigned char frames[nRF24L01::DefaultConfig::count][2];
+
+		for (int i = 0; i < nRF24L01::DefaultConfig::count; i++)
+		{
+			nRF24L01::writeRegisterFrame(frames[i], nRF24L01::DefaultConfig::regs[i][0],
+				&nRF24L01::DefaultConfig::regs[i][1], 1);
+		}
+
+		transport.transferBatch(SPIChannel, frames, nRF24L01::DefaultConfig::count);
+
+		setupRetr = readRegister(SETUP_RETR);
+
+		command(FLUSH_RX);
+		command(FLUSH_TX);
+
+		return true;
+	}
+
+	/**
+	 * Check whether nRF24L01 is connected and responding
+	 *
+	 * @return  true if chip is present
+	 */
+	bool isChipConnected(void)
+	{
+		return Driver::isChipConnected(*this);
+	}
+
+	/**
+	 * Write payload to open writing pipe
+	 *
+	 * @param  data 	data to write, PayloadSize bytes
+	 * @return      	status
+	 */
+	bool write(const unsigned char *data)
+	{
+		startWrite(data);
+
+		unsigned char observeTX;
+
+		Driver::waitForWrite(*this, transport, nRF24L01::writeTimeout(setupRetr), &observeTX);
+
+		return Driver::finishWrite(*this) & (1 << TX_DS);
+	}
+
+	/**
+	 * Start writing payload
+	 *
+	 * @param data 	data to write, PayloadSize bytes
+	 */
+	void startWrite(const unsigned char *data)
+	{
+		Driver::enterTX(*this, transport);
+
+		writePayload(data);
+
+		transport.pulseCE(CE, 15);
+	}
+
+	/**
+	 * Set delay and number of retry for retransmission
+	 *
+	 * @param delay 	retransmission delay
+	 * @param count 	retransmission count
+	 */
+	void setRetries(int delay, int count)
+	{
+		setupRetr = Driver::setRetries(*this, delay, count);
+	}
+
+	/**
+	 * Set RF channel
+	 *
+	 * @param channel 	channel number
+	 */
+	void setChannel(int channel)
+	{
+		Driver::setChannel(*this, channel);
+	}
+
+	/**
+	 * Set power level
+	 *
+	 * @param level 	power level
+	 */
+	void setPowerLevel(RFPower level)
+	{
+		Driver::setPowerLevel(*this, level);
+	}
+
+	/**
+	 * Set air data rate
+	 *
+	 * @param rate 		data rate
+	 */
+	void setDataRate(DataRate rate)
+	{
+		Driver::setDataRate(*this, rate);
+	}
+
+	/**
+	 * Set CRC length
+	 *
+	 * @param length 	CRC length
+	 */
+	void setCRCLength(CRCLength length)
+	{
+		Driver::setCRCLength(*this, length);
+	}
+
+	/**
+	 * Set auto acknowledgment
+	 *
+	 * @param enable 	enable or disable auto acknowledgment
+	 */
+	void setAutoACK(bool enable)
+	{
+		Driver::setAutoACK(*this, enable);
+	}
+
+	/**
+	 * Set nRF24L01 to standby mode
+	 */
+	void powerUp(void)
+	{
+		Driver::setPowerUp(*this, true);
+	}
+
+	/**
+	 * Set nRF24L01 to power down mode
+	 */
+	void powerDown(void)
+	{
+		Driver::setPowerUp(*this, false);
+	}
+
+	/**
+	 * Flush TX FIFO
+	 *
+	 * @return  nRF24L01 status
+	 */
+	unsigned char flushTX(void)
+	{
+		return command(FLUSH_TX);
+	}
+
+	/**
+	 * Open writing pipe
+	 *
+	 * @param address 	pipe address, 5 bytes
+	 */
+	void openWritingPipe(const char *address)
+	{
+		Driver::writeTXAddress(*this, (const unsigned char *) address, addressSize);
+		writeRegister(RX_PW_P0, PayloadSize);
+	}
+
+	/**
+	 * Open reading pipe
+	 *
+	 * Pipe 0 and 1 take a full address, pipe 2 to 5 only the LSB byte.
+	 *
+	 * @tparam Pipe 		pipe number
+	 * @param  address 		pipe address
+	 */
+	template <int Pipe>
+	void openReadingPipe(const char *address)
+	{
+		static_assert(Pipe >= 0 && Pipe < 6, "nRF24L01 has 6 pipes");
+
+		unsigned char reversed[addressSize];
+
+		Driver::writeRXAddress(*this, Pipe, (const unsigned char *) address, addressSize, reversed);
+
+		writeRegister(nRF24L01::pipePayloadRegister(Pipe), PayloadSize);
+		writeRegister(EN_RXADDR, readRegister(EN_RXADDR) | (1 << Pipe));
+	}
+
+	/**
+	 * Get transport instance
+	 *
+	 * @return  transport
+	 */
+	Transport &getTransport(void)
+	{
+		return transport;
+	}
+};
+
+#endif
\ No newline at end of file
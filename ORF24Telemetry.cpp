@@ -0,0 +1,456 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "ORF24Telemetry.h"
+
+/**
+ * Map signed value to unsigned so small magnitudes stay small
+ *
+ * @param  value 	signed value
+ * @return       	zigzag encoded value
+ */
+static inline uint32_t zigzag(int32_t value)
+{
+	return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+/**
+ * Reverse zigzag encoding
+ *
+ * @param  value 	zigzag encoded value
+ * @return       	signed value
+ */
+static inline int32_t unzigzag(uint32_t value)
+{
+	return (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+}
+
+/**
+ * Write varint
+ *
+ * @param  out   	output buffer
+ * @param  value 	value
+ * @return       	bytes written
+ */
+static int putVarint(unsigned char *out, uint32_t value)
+{
+	int len = 0;
+
+	while (value >= 0x80)
+	{
+		out[len++] = value | 0x80;
+		value >>= 7;
+	}
+
+	out[len++] = value;
+
+	return len;
+}
+
+/**
+ * Varint length
+ *
+ * @param  value 	value
+ * @return       	bytes needed
+ */
+static int varintLength(uint32_t value)
+{
+	int len = 1;
+
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		len++;
+	}
+
+	return len;
+}
+
+ORF24TelemetryEncoder::ORF24TelemetryEncoder(int _channels, int _keyframeInterval, int _payloadSize)
+	: channels(_channels > TELEMETRY_MAX_CHANNELS ? TELEMETRY_MAX_CHANNELS : _channels),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize),
+	  keyframeInterval(_keyframeInterval)
+{
+	std::memset(previous, 0, sizeof(previous));
+}
+
+/**
+ * Encode a frame
+ *
+ * @param  values 	one value per channel
+ * @param  out    	output buffer of payload size bytes
+ * @return        	encoded length, -1 if the frame does not fit
+ */
+int ORF24TelemetryEncoder::encode(const int32_t *values, unsigned char *out)
+{
+	uint32_t fields[TELEMETRY_MAX_CHANNELS];
+	bool key = keyframe || sinceKeyframe >= keyframeInterval;
+	int varintSize = 1;
+	uint32_t any = 0;
+
+	for (int i = 0; i < channels; i++)
+	{
+		int32_t value = key ? values[i] : (int32_t) ((uint32_t) values[i] - (uint32_t) previous[i]);
+
+		fields[i] = zigzag(value);
+		varintSize += varintLength(fields[i]);
+		any |= fields[i];
+	}
+
+	/* Width of the largest field */
+	int width = any ? 32 - __builtin_clz(any) : 0;
+	int packedSize = 2 + (channels * width + 7) / 8;
+	int type = key ? TELEMETRY_KEYFRAME : packedSize < varintSize ? TELEMETRY_PACKED : TELEMETRY_VARINT;
+	int len = type == TELEMETRY_PACKED ? packedSize : varintSize;
+
+	if (len > payloadSize)
+	{
+		oversized++;
+		return -1;
+	}
+
+	out[0] = type << 6 | (sequence & 0x3F);
+
+	if (type == TELEMETRY_PACKED)
+	{
+		uint64_t window = 0;
+		int bits = 0;
+		int pos = 2;
+
+		out[1] = width;
+
+		for (int i = 0; i < channels; i++)
+		{
+			window |= (uint64_t) fields[i] << bits;
+			bits += width;
+
+			while (bits >= 8)
+			{
+				out[pos++] = window;
+				window >>= 8;
+				bits -= 8;
+			}
+		}
+
+		if (bits > 0)
+		{
+			out[pos++] = window;
+		}
+	}
+	else
+	{
+		int pos = 1;
+
+		for (int i = 0; i < channels; i++)
+		{
+			pos += putVarint(out + pos, fields[i]);
+		}
+	}
+
+	std::memcpy(previous, values, channels * sizeof(int32_t));
+	sequence++;
+	frames++;
+
+	if (key)
+	{
+		keyframes++;
+		keyframe = false;
+		sinceKeyframe = 0;
+	}
+	else
+	{
+		sinceKeyframe++;
+	}
+
+	rawBytes += channels * sizeof(int32_t);
+	encodedBytes += len;
+
+	return len;
+}
+
+/**
+ * Encode a frame and write it
+ *
+ * @param  radio  	radio to send with
+ * @param  values 	one value per channel
+ * @return        	false if frame does not fit or was not acknowledged
+ */
+bool ORF24TelemetryEncoder::send(ORF24 &radio, const int32_t *values)
+{
+	unsigned char payload[32];
+
+	std::memset(payload, 0, sizeof(payload));
+
+	if (encode(values, payload) < 0)
+	{
+		return false;
+	}
+
+	bool result = radio.write(payload, payloadSize);
+
+	/* Receiver lost the delta chain */
+	if (!result)
+	{
+		forceKeyframe();
+	}
+
+	return result;
+}
+
+/**
+ * Make the next frame a keyframe
+ */
+void ORF24TelemetryEncoder::forceKeyframe(void)
+{
+	keyframe = true;
+}
+
+/**
+ * Get ratio of raw to encoded size, raw values counted as 32 bits
+ *
+ * @return  compression ratio
+ */
+double ORF24TelemetryEncoder::getCompressionRatio(void)
+{
+	return encodedBytes ? (double) rawBytes / encodedBytes : 0;
+}
+
+/**
+ * Get number of frames encoded
+ *
+ * @return  frames
+ */
+unsigned long ORF24TelemetryEncoder::getFrames(void)
+{
+	return frames;
+}
+
+/**
+ * Get number of keyframes encoded
+ *
+ * @return  keyframes
+ */
+unsigned long ORF24TelemetryEncoder::getKeyframes(void)
+{
+	return keyframes;
+}
+
+/**
+ * Get number of frames too large for the payload
+ *
+ * @return  oversized frames
+ */
+unsigned long ORF24TelemetryEncoder::getOversized(void)
+{
+	return oversized;
+}
+
+ORF24TelemetryDecoder::ORF24TelemetryDecoder(int _channels, int _payloadSize)
+	: channels(_channels > TELEMETRY_MAX_CHANNELS ? TELEMETRY_MAX_CHANNELS : _channels),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize < 1 ? 1 : _payloadSize)
+{
+	std::memset(previous, 0, sizeof(previous));
+}
+
+/**
+ * Unpack fixed width fields
+ *
+ * @param in    	packed fields, LSB first
+ * @param width 	field width in bits, at most 32
+ * @param count 	number of fields
+ * @param out   	unpacked fields
+ */
+void ORF24TelemetryDecoder::unpack(const unsigned char *in, int width, int count, uint32_t *out)
+{
+	const uint64_t mask = width == 32 ? 0xFFFFFFFFULL : (1ULL << width) - 1;
+
+	for (int i = 0; i < count; i++)
+	{
+		int bit = i * width;
+		uint64_t window;
+
+		/* Little endian load, at most 7 + 32 bits are used */
+		std::memcpy(&window, in + (bit >> 3), sizeof(window));
+
+		out[i] = (window >> (bit & 7)) & mask;
+	}
+}
+
+/**
+ * Decode a frame
+ *
+ * @param  in     	encoded frame
+ * @param  len    	encoded frame length, padding allowed
+ * @param  values 	set to one value per channel
+ * @return        	false if frame is malformed or follows a lost frame
+ */
+bool ORF24TelemetryDecoder::decode(const unsigned char *in, int len, int32_t *values)
+{
+	/* Room for the 64 bit window reads of unpack */
+	unsigned char frame[32 + 8];
+	uint32_t fields[TELEMETRY_MAX_CHANNELS];
+
+	if (len < 1 || len > 32)
+	{
+		return false;
+	}
+
+	std::memset(frame, 0, sizeof(frame));
+	std::memcpy(frame, in, len);
+
+	int type = frame[0] >> 6;
+	unsigned char sequence = frame[0] & 0x3F;
+
+	if (synchronized && sequence != expected)
+	{
+		lost += (sequence - expected) & 0x3F;
+
+		/* Deltas are relative to a frame that never arrived */
+		synchronized = false;
+	}
+
+	expected = (sequence + 1) & 0x3F;
+
+	if (type != TELEMETRY_KEYFRAME && !synchronized)
+	{
+		dropped++;
+		return false;
+	}
+
+	if (type == TELEMETRY_PACKED)
+	{
+		int width = frame[1];
+
+		if (width > 32 || 2 + (channels * width + 7) / 8 > len)
+		{
+			return false;
+		}
+
+		unpack(frame + 2, width, channels, fields);
+	}
+	else if (type == TELEMETRY_KEYFRAME || type == TELEMETRY_VARINT)
+	{
+		int pos = 1;
+
+		for (int i = 0; i < channels; i++)
+		{
+			uint32_t value = 0;
+			int shift = 0;
+
+			do
+			{
+				if (pos >= len || shift > 28)
+				{
+					return false;
+				}
+
+				value |= (uint32_t) (frame[pos] & 0x7F) << shift;
+				shift += 7;
+			} while (frame[pos++] & 0x80);
+
+			fields[i] = value;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	/* Independent per channel, the compiler vectorizes both loops */
+	if (type == TELEMETRY_KEYFRAME)
+	{
+		for (int i = 0; i < channels; i++)
+		{
+			previous[i] = unzigzag(fields[i]);
+		}
+	}
+	else
+	{
+		for (int i = 0; i < channels; i++)
+		{
+			previous[i] = (int32_t) ((uint32_t) previous[i] + (uint32_t) unzigzag(fields[i]));
+		}
+	}
+
+	std::memcpy(values, previous, channels * sizeof(int32_t));
+
+	synchronized = true;
+	frames++;
+
+	return true;
+}
+
+/**
+ * Read and decode a frame
+ *
+ * @param  radio  	radio to receive with
+ * @param  values 	set to one value per channel
+ * @return        	false if nothing was received or frame was not decodable
+ */
+bool ORF24TelemetryDecoder::receive(ORF24 &radio, int32_t *values)
+{
+	unsigned char payload[32];
+
+	if (!radio.available())
+	{
+		return false;
+	}
+
+	/* Only payload size bytes come from the radio */
+	std::memset(payload, 0, sizeof(payload));
+	radio.read(payload, payloadSize);
+
+	return decode(payload, payloadSize, values);
+}
+
+/**
+ * Get number of frames decoded
+ *
+ * @return  frames
+ */
+unsigned long ORF24TelemetryDecoder::getFrames(void)
+{
+	return frames;
+}
+
+/**
+ * Get number of frames missing from the sequence
+ *
+ * @return  lost frames
+ */
+unsigned long ORF24TelemetryDecoder::getLost(void)
+{
+	return lost;
+}
+
+/**
+ * Get number of frames dropped while waiting for a keyframe
+ *
+ * @return  dropped frames
+ */
+unsigned long ORF24TelemetryDecoder::getDropped(void)
+{
+	return dropped;
+}
\ No newline at end of file
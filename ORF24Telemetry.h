@@ -0,0 +1,213 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_TELEMETRY_H_
+#define _ORF_24_TELEMETRY_H_
+
+#include <stdint.h>
+#include "ORF24.h"
+
+#define		TELEMETRY_MAX_CHANNELS	16
+#define		TELEMETRY_KEYFRAME		0
+#define		TELEMETRY_VARINT		1
+#define		TELEMETRY_PACKED		2
+
+/**
+ * Compact encoding of multi-channel integer samples
+ *
+ * A frame holds one sample per channel. Keyframes carry zigzag varints of
+ * the values, other frames carry the change since the previous frame as
+ * zigzag varints or bit-packed at the width of the largest change,
+ * whichever is shorter. The first byte holds the frame type and a 6 bit
+ * sequence number:
+ *
+ *     KEYFRAME | 0b00 seq | varint ... |
+ *     VARINT   | 0b01 seq | varint ... |
+ *     PACKED   | 0b10 seq | width | fields, LSB first ... |
+ *
+ * A lost frame breaks the delta chain, the decoder drops frames until the
+ * next keyframe. The encoder sends a keyframe every keyframe interval and
+ * after a failed send.
+ */
+class ORF24TelemetryEncoder
+{
+private:
+	int channels;					/* Values per frame */
+	int payloadSize;				/* Largest encoded frame */
+	int keyframeInterval;			/* Frames between keyframes */
+	int32_t previous[TELEMETRY_MAX_CHANNELS];	/* Values of last frame */
+	int sinceKeyframe = 0;			/* Frames since last keyframe */
+	bool keyframe = true;			/* Whether next frame is a keyframe */
+	unsigned char sequence = 0;		/* Frame sequence number */
+	unsigned long frames = 0;		/* Frames encoded */
+	unsigned long keyframes = 0;	/* Keyframes encoded */
+	unsigned long oversized = 0;	/* Frames that did not fit */
+	unsigned long rawBytes = 0;		/* Input size of encoded frames */
+	unsigned long encodedBytes = 0;	/* Output size of encoded frames */
+
+public:
+
+	/**
+	 * ORF24TelemetryEncoder Constructor
+	 *
+	 * @param _channels 			values per frame, at most 16
+	 * @param _keyframeInterval 	frames between keyframes
+	 * @param _payloadSize 			largest encoded frame in bytes
+	 */
+	ORF24TelemetryEncoder(int _channels, int _keyframeInterval = 16, int _payloadSize = 32);
+
+	/**
+	 * Encode a frame
+	 *
+	 * @param  values 	one value per channel
+	 * @param  out    	output buffer of payload size bytes
+	 * @return        	encoded length, -1 if the frame does not fit
+	 */
+	int encode(const int32_t *values, unsigned char *out);
+
+	/**
+	 * Encode a frame and write it
+	 *
+	 * The payload is zero padded to the radio payload size.
+	 *
+	 * @param  radio  	radio to send with
+	 * @param  values 	one value per channel
+	 * @return        	false if frame does not fit or was not acknowledged
+	 */
+	bool send(ORF24 &radio, const int32_t *values);
+
+	/**
+	 * Make the next frame a keyframe
+	 */
+	void forceKeyframe(void);
+
+	/**
+	 * Get ratio of raw to encoded size, raw values counted as 32 bits
+	 *
+	 * @return  compression ratio
+	 */
+	double getCompressionRatio(void);
+
+	/**
+	 * Get number of frames encoded
+	 *
+	 * @return  frames
+	 */
+	unsigned long getFrames(void);
+
+	/**
+	 * Get number of keyframes encoded
+	 *
+	 * @return  keyframes
+	 */
+	unsigned long getKeyframes(void);
+
+	/**
+	 * Get number of frames too large for the payload
+	 *
+	 * @return  oversized frames
+	 */
+	unsigned long getOversized(void);
+};
+
+/**
+ * Decoder for ORF24TelemetryEncoder frames
+ */
+class ORF24TelemetryDecoder
+{
+private:
+	int channels;					/* Values per frame */
+	int payloadSize;				/* Radio payload size */
+	int32_t previous[TELEMETRY_MAX_CHANNELS];	/* Values of last frame */
+	bool synchronized = false;		/* Whether previous is valid */
+	unsigned char expected = 0;		/* Next sequence number */
+	unsigned long frames = 0;		/* Frames decoded */
+	unsigned long lost = 0;			/* Frames missing from the sequence */
+	unsigned long dropped = 0;		/* Frames not decodable after a loss */
+
+public:
+
+	/**
+	 * ORF24TelemetryDecoder Constructor
+	 *
+	 * @param _channels 		values per frame, at most 16
+	 * @param _payloadSize 	radio payload size in bytes
+	 */
+	ORF24TelemetryDecoder(int _channels, int _payloadSize = 32);
+
+	/**
+	 * Decode a frame
+	 *
+	 * @param  in     	encoded frame
+	 * @param  len    	encoded frame length, padding allowed
+	 * @param  values 	set to one value per channel
+	 * @return        	false if frame is malformed or follows a lost frame
+	 */
+	bool decode(const unsigned char *in, int len, int32_t *values);
+
+	/**
+	 * Read and decode a frame
+	 *
+	 * @param  radio  	radio to receive with
+	 * @param  values 	set to one value per channel
+	 * @return        	false if nothing was received or frame was not decodable
+	 */
+	bool receive(ORF24 &radio, int32_t *values);
+
+	/**
+	 * Unpack fixed width fields
+	 *
+	 * Reads a 64 bit window per field instead of looping over bits. Input
+	 * must be readable 8 bytes past the last field.
+	 *
+	 * @param in    	packed fields, LSB first
+	 * @param width 	field width in bits, at most 32
+	 * @param count 	number of fields
+	 * @param out   	unpacked fields
+	 */
+	static void unpack(const unsigned char *in, int width, int count, uint32_t *out);
+
+	/**
+	 * Get number of frames decoded
+	 *
+	 * @return  frames
+	 */
+	unsigned long getFrames(void);
+
+	/**
+	 * Get number of frames missing from the sequence
+	 *
+	 * @return  lost frames
+	 */
+	unsigned long getLost(void);
+
+	/**
+	 * Get number of frames dropped while waiting for a keyframe
+	 *
+	 * @return  dropped frames
+	 */
+	unsigned long getDropped(void);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,493 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include "ORF24TimeSync.h"
+
+ORF24Timestamper *ORF24Timestamper::irqOwner = NULL;
+
+ORF24Timestamper::ORF24Timestamper(ORF24 &_radio)
+	: radio(_radio),
+	  transport(_radio.getTransport()),
+	  irqAt(0),
+	  irqCount(0)
+{ }
+
+/**
+ * IRQ edge handler
+ */
+void ORF24Timestamper::irqHandler(void)
+{
+	ORF24Timestamper *owner = irqOwner;
+
+	if (owner)
+	{
+		owner->irqAt = owner->transport->nanos();
+		owner->irqCount++;
+	}
+}
+
+/**
+ * Take falling edges of the IRQ pin
+ *
+ * @param  pin     	wiringPi pin number of IRQ
+ * @param  latency 	mean edge to handler latency in nanoseconds
+ * @param  spread  	largest deviation from the mean latency in nanoseconds
+ * @return         	true on success
+ */
+bool ORF24Timestamper::attachIRQ(int pin, unsigned int latency, unsigned int spread)
+{
+	irqOwner = this;
+	irqLatency = latency;
+	irqError = spread;
+	irqSeen = irqCount;
+
+	irqAttached = wiringPiISR(pin, INT_EDGE_FALLING, irqHandler) >= 0;
+
+	return irqAttached;
+}
+
+/**
+ * Narrow a poll bracket with the last IRQ edge
+ *
+ * @param  low  	time before the event
+ * @param  high 	time after the event
+ * @return      	event time
+ */
+PacketTime ORF24Timestamper::bracket(unsigned long long low, unsigned long long high)
+{
+	PacketTime time;
+
+	if (irqAttached && irqCount != irqSeen)
+	{
+		irqSeen = irqCount;
+
+		unsigned long long edge = irqAt - irqLatency;
+		unsigned long long edgeLow = edge > irqError ? edge - irqError : 0;
+		unsigned long long edgeHigh = edge + irqError;
+
+		/* An edge outside the bracket belongs to another event */
+		if (edgeLow <= high && edgeHigh >= low)
+		{
+			low = edgeLow > low ? edgeLow : low;
+			high = edgeHigh < high ? edgeHigh : high;
+		}
+	}
+
+	unsigned long long half = (high - low + 1) / 2;
+
+	time.at = low + (high - low) / 2;
+	time.error = half < UINT_MAX ? half : UINT_MAX;
+
+	return time;
+}
+
+/**
+ * Check whether a payload was received and stamp its arrival
+ *
+ * @param  time 	set to arrival time of head of RX FIFO
+ * @return      	true if RX FIFO is not empty
+ */
+bool ORF24Timestamper::available(PacketTime *time)
+{
+	unsigned long long before = transport->nanos();
+	bool ready = radio.available();
+	unsigned long long after = transport->nanos();
+
+	if (!ready)
+	{
+		lastEmpty = before;
+		stamped = false;
+
+		return false;
+	}
+
+	/* Packets behind the head arrived after lastEmpty as well */
+	if (!stamped)
+	{
+		rxTime = bracket(lastEmpty, after);
+		stamped = true;
+	}
+
+	*time = rxTime;
+
+	return true;
+}
+
+/**
+ * Read head of RX FIFO
+ *
+ * @param data 	data buffer to read into
+ * @param len  	data length
+ */
+void ORF24Timestamper::read(unsigned char *data, int len)
+{
+	radio.read(data, len);
+	stamped = false;
+}
+
+/**
+ * Write payload and stamp TX_DS
+ *
+ * @param  data 	data to write
+ * @param  len  	data length
+ * @param  time 	set to TX_DS time
+ * @return      	true if sent
+ */
+bool ORF24Timestamper::write(unsigned char *data, int len, PacketTime *time)
+{
+	const unsigned long timeout = 500;
+
+	unsigned long long low = transport->nanos();
+	unsigned long long high;
+	unsigned int startedAt = transport->millis();
+	bool delivered;
+
+	radio.startWrite(data, len);
+
+	/* One byte STATUS reads keep the bracket tight */
+	while (true)
+	{
+		unsigned long long before = transport->nanos();
+		bool done = radio.isWriteDone();
+
+		high = transport->nanos();
+
+		if (done || transport->millis() - startedAt >= timeout)
+		{
+			break;
+		}
+
+		low = before;
+	}
+
+	*time = bracket(low, high);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	return delivered;
+}
+
+/**
+ * Get clock the timestamps are on
+ *
+ * @return  time in nanoseconds
+ */
+unsigned long long ORF24Timestamper::now(void)
+{
+	return transport->nanos();
+}
+
+ORF24TimeSync::ORF24TimeSync(ORF24 &_radio, int _payloadSize)
+	: radio(_radio),
+	  stamper(_radio),
+	  payloadSize(_payloadSize > 32 ? 32 : _payloadSize)
+{ }
+
+/**
+ * Get event timestamps
+ *
+ * @return  timestamper
+ */
+ORF24Timestamper &ORF24TimeSync::getTimestamper(void)
+{
+	return stamper;
+}
+
+/**
+ * Set largest accepted error of a pair
+ *
+ * @param ns 	error in nanoseconds
+ */
+void ORF24TimeSync::setMaxError(unsigned int ns)
+{
+	maxError = ns;
+}
+
+/**
+ * Send a beacon, on the master
+ *
+ * @return  true if sent
+ */
+bool ORF24TimeSync::sendBeacon(void)
+{
+	unsigned char payload[32];
+	unsigned long long master = sent ? lastSent.at : 0;
+	unsigned int error = sent ? lastSent.error : UINT_MAX;
+	PacketTime time;
+
+	std::memset(payload, 0, sizeof(payload));
+
+	payload[0] = SYNC_BEACON;
+	payload[1] = sequence++;
+
+	for (int i = 0; i < 8; i++)
+	{
+		payload[2 + i] = master >> (8 * i);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		payload[10 + i] = error >> (8 * i);
+	}
+
+	sent = stamper.write(payload, payloadSize, &time);
+	lastSent = time;
+
+	return sent;
+}
+
+/**
+ * Feed a received payload, on receivers
+ *
+ * @param  payload 	received payload
+ * @param  time    	arrival time
+ * @return         	true if payload is a beacon
+ */
+bool ORF24TimeSync::handle(const unsigned char *payload, const PacketTime &time)
+{
+	if (payload[0] != SYNC_BEACON)
+	{
+		return false;
+	}
+
+	unsigned char seq = payload[1];
+	unsigned long long master = 0;
+	unsigned int error = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		master |= (unsigned long long) payload[2 + i] << (8 * i);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		error |= (unsigned int) payload[10 + i] << (8 * i);
+	}
+
+	/* The beacon describes the previous one, which must have arrived */
+	if (received && seq == (unsigned char) (lastSequence + 1) && error != UINT_MAX)
+	{
+		if ((unsigned long long) error + lastReceived.error > maxError)
+		{
+			rejected++;
+		}
+		else
+		{
+			addSample(lastReceived.at, master);
+		}
+	}
+
+	lastSequence = seq;
+	lastReceived = time;
+	received = true;
+
+	return true;
+}
+
+/**
+ * Read and handle every received payload, for nodes only listening
+ * for beacons
+ *
+ * @return  true if a beacon was handled
+ */
+bool ORF24TimeSync::service(void)
+{
+	unsigned char payload[32];
+	PacketTime time;
+	bool handled = false;
+
+	/* At most a full RX FIFO per call */
+	for (int i = 0; i < 3 && stamper.available(&time); i++)
+	{
+		stamper.read(payload, payloadSize);
+		handled |= handle(payload, time);
+	}
+
+	return handled;
+}
+
+/**
+ * Add a pair and refit offset and drift
+ *
+ * @param local  	local arrival time
+ * @param master 	master send time
+ */
+void ORF24TimeSync::addSample(unsigned long long local, unsigned long long master)
+{
+	const double jump = 1000000;
+
+	long long offset = (long long) (master - local);
+
+	/* Master restarted or the clock stepped, start over */
+	if (sampleCount > 0 && std::fabs((double) (long long) (toMaster(local) - master)) > jump)
+	{
+		sampleCount = 0;
+	}
+
+	int slot = (sampleHead + sampleCount) % SYNC_SAMPLES;
+
+	sampleLocal[slot] = local;
+	sampleOffset[slot] = offset;
+
+	if (sampleCount < SYNC_SAMPLES)
+	{
+		sampleCount++;
+	}
+	else
+	{
+		sampleHead = (sampleHead + 1) % SYNC_SAMPLES;
+	}
+
+	samples++;
+
+	/* Fit relative to the newest pair to keep double precision */
+	double x[SYNC_SAMPLES], y[SYNC_SAMPLES];
+	double meanX = 0, meanY = 0;
+
+	for (int i = 0; i < sampleCount; i++)
+	{
+		int j = (sampleHead + i) % SYNC_SAMPLES;
+
+		x[i] = (double) (long long) (sampleLocal[j] - local);
+		y[i] = (double) (sampleOffset[j] - offset);
+		meanX += x[i];
+		meanY += y[i];
+	}
+
+	meanX /= sampleCount;
+	meanY /= sampleCount;
+
+	double sxx = 0, sxy = 0;
+
+	for (int i = 0; i < sampleCount; i++)
+	{
+		sxx += (x[i] - meanX) * (x[i] - meanX);
+		sxy += (x[i] - meanX) * (y[i] - meanY);
+	}
+
+	drift = sxx > 0 ? sxy / sxx : 0;
+
+	double intercept = meanY - drift * meanX;
+	double squares = 0;
+
+	for (int i = 0; i < sampleCount; i++)
+	{
+		double e = y[i] - (intercept + drift * x[i]);
+		squares += e * e;
+	}
+
+	residual = std::sqrt(squares / sampleCount);
+	localRef = local;
+	offsetRef = offset + intercept;
+}
+
+/**
+ * Convert local time to master time
+ *
+ * @param  local 	local time in nanoseconds
+ * @return       	master time in nanoseconds
+ */
+unsigned long long ORF24TimeSync::toMaster(unsigned long long local)
+{
+	double elapsed = (double) (long long) (local - localRef);
+
+	return local + (long long) std::llround(offsetRef + drift * elapsed);
+}
+
+/**
+ * Convert master time to local time
+ *
+ * @param  master 	master time in nanoseconds
+ * @return        	local time in nanoseconds
+ */
+unsigned long long ORF24TimeSync::toLocal(unsigned long long master)
+{
+	double elapsed = ((double) (long long) (master - localRef) - offsetRef) / (1 + drift);
+
+	return localRef + (long long) std::llround(elapsed);
+}
+
+/**
+ * Get current master time
+ *
+ * @return  time in nanoseconds
+ */
+unsigned long long ORF24TimeSync::now(void)
+{
+	return toMaster(stamper.now());
+}
+
+/**
+ * Check whether offset and drift are estimated
+ *
+ * @return  true after two pairs
+ */
+bool ORF24TimeSync::isSynchronized(void)
+{
+	return sampleCount >= 2;
+}
+
+/**
+ * Get master clock drift relative to local clock
+ *
+ * @return  drift in ppm
+ */
+double ORF24TimeSync::getDrift(void)
+{
+	return drift * 1e6;
+}
+
+/**
+ * Get RMS distance of the pairs from the fit
+ *
+ * @return  residual in nanoseconds
+ */
+double ORF24TimeSync::getResidual(void)
+{
+	return residual;
+}
+
+/**
+ * Get number of pairs accepted
+ *
+ * @return  pairs
+ */
+unsigned long ORF24TimeSync::getSamples(void)
+{
+	return samples;
+}
+
+/**
+ * Get number of pairs rejected for their error
+ *
+ * @return  pairs
+ */
+unsigned long ORF24TimeSync::getRejected(void)
+{
+	return rejected;
+}
\ No newline at end of file
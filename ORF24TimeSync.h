@@ -0,0 +1,298 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_TIME_SYNC_H_
+#define _ORF_24_TIME_SYNC_H_
+
+#include <atomic>
+#include "ORF24.h"
+
+#define		SYNC_BEACON			0xA7
+#define		SYNC_BEACON_SIZE	14
+#define		SYNC_SAMPLES		8
+
+/**
+ * Time of a radio event
+ */
+struct PacketTime
+{
+	unsigned long long at = 0;		/* Event time in nanoseconds */
+	unsigned int error = 0;			/* Largest distance of the true time from at */
+};
+
+/**
+ * RX_DR and TX_DS timestamps on the transport clock, CLOCK_MONOTONIC on
+ * the Odroid
+ *
+ * Polling brackets an event between the last poll that did not see it and
+ * the first one that did, the timestamp is the middle and the error half
+ * the gap. With the IRQ pin attached, the edge time less the interrupt
+ * latency narrows the bracket.
+ */
+class ORF24Timestamper
+{
+private:
+	ORF24 &radio;					/* Radio to stamp events of */
+	ORF24Transport *transport;		/* Clock source */
+	unsigned long long lastEmpty = 0;	/* Start of last poll finding RX FIFO empty */
+	bool stamped = false;			/* Whether head of RX FIFO has a timestamp */
+	PacketTime rxTime;				/* Timestamp of head of RX FIFO */
+	std::atomic<unsigned long long> irqAt;	/* Time of last IRQ edge */
+	std::atomic<unsigned long> irqCount;	/* IRQ edges seen */
+	unsigned long irqSeen = 0;		/* IRQ edges consumed */
+	bool irqAttached = false;		/* Whether IRQ pin is attached */
+	unsigned int irqLatency = 0;	/* Mean edge to handler latency in nanoseconds */
+	unsigned int irqError = 0;		/* Spread of edge to handler latency in nanoseconds */
+
+	static ORF24Timestamper *irqOwner;	/* Instance receiving IRQ edges */
+
+	/**
+	 * IRQ edge handler
+	 */
+	static void irqHandler(void);
+
+	/**
+	 * Narrow a poll bracket with the last IRQ edge
+	 *
+	 * @param  low  	time before the event
+	 * @param  high 	time after the event
+	 * @return      	event time
+	 */
+	PacketTime bracket(unsigned long long low, unsigned long long high);
+
+public:
+
+	/**
+	 * ORF24Timestamper Constructor
+	 *
+	 * @param _radio 	radio to stamp events of
+	 */
+	ORF24Timestamper(ORF24 &_radio);
+
+	/**
+	 * Take falling edges of the IRQ pin
+	 *
+	 * Only one instance per process can have the IRQ pin.
+	 *
+	 * @param  pin     	wiringPi pin number of IRQ
+	 * @param  latency 	mean edge to handler latency in nanoseconds
+	 * @param  spread  	largest deviation from the mean latency in nanoseconds
+	 * @return         	true on success
+	 */
+	bool attachIRQ(int pin, unsigned int latency, unsigned int spread);
+
+	/**
+	 * Check whether a payload was received and stamp its arrival
+	 *
+	 * Poll frequently while waiting, the gap between polls is the error.
+	 *
+	 * @param  time 	set to arrival time of head of RX FIFO
+	 * @return      	true if RX FIFO is not empty
+	 */
+	bool available(PacketTime *time);
+
+	/**
+	 * Read head of RX FIFO
+	 *
+	 * @param data 	data buffer to read into
+	 * @param len  	data length
+	 */
+	void read(unsigned char *data, int len);
+
+	/**
+	 * Write payload and stamp TX_DS
+	 *
+	 * TX_DS is the end of the packet with ACK disabled, and the end of the
+	 * ACK otherwise.
+	 *
+	 * @param  data 	data to write
+	 * @param  len  	data length
+	 * @param  time 	set to TX_DS time
+	 * @return      	true if sent
+	 */
+	bool write(unsigned char *data, int len, PacketTime *time);
+
+	/**
+	 * Get clock the timestamps are on
+	 *
+	 * @return  time in nanoseconds
+	 */
+	unsigned long long now(void);
+};
+
+/**
+ * Beacon based network time
+ *
+ * The master broadcasts beacons without ACK. TX_DS at the master and RX_DR
+ * at the receivers both mark the end of the packet, so each beacon carries
+ * the master time of the previous one:
+ *
+ *     | SYNC_BEACON | seq | master time of seq - 1 (8) | error (4) |
+ *
+ * Receivers pair it with their own arrival time of seq - 1 and fit offset
+ * and drift over the last SYNC_SAMPLES pairs by least squares. Pairs whose
+ * error bounds add up to more than the limit are rejected.
+ */
+class ORF24TimeSync
+{
+private:
+	ORF24 &radio;					/* Radio to send and receive with */
+	ORF24Timestamper stamper;		/* Event timestamps */
+	int payloadSize;				/* Payload size in bytes */
+	unsigned char sequence = 0;		/* Sequence number of next beacon */
+	PacketTime lastSent;			/* TX_DS time of last beacon */
+	bool sent = false;				/* Whether a beacon was sent */
+	unsigned char lastSequence = 0;	/* Sequence number of last beacon received */
+	PacketTime lastReceived;		/* RX_DR time of last beacon received */
+	bool received = false;			/* Whether a beacon was received */
+	unsigned int maxError = 100000;	/* Largest accepted pair error in nanoseconds */
+	unsigned long long sampleLocal[SYNC_SAMPLES];	/* Local times of pairs */
+	long long sampleOffset[SYNC_SAMPLES];	/* Master minus local time of pairs */
+	int sampleHead = 0;				/* Oldest pair */
+	int sampleCount = 0;			/* Pairs kept */
+	unsigned long long localRef = 0;	/* Local time of the fit origin */
+	double offsetRef = 0;			/* Offset at the fit origin in nanoseconds */
+	double drift = 0;				/* Master clock rate relative to local, minus one */
+	double residual = 0;			/* RMS distance of pairs from the fit */
+	unsigned long samples = 0;		/* Pairs accepted */
+	unsigned long rejected = 0;		/* Pairs rejected */
+
+	/**
+	 * Add a pair and refit offset and drift
+	 *
+	 * @param local  	local arrival time
+	 * @param master 	master send time
+	 */
+	void addSample(unsigned long long local, unsigned long long master);
+
+public:
+
+	/**
+	 * ORF24TimeSync Constructor
+	 *
+	 * @param _radio 		radio to send and receive with
+	 * @param _payloadSize 	payload size in bytes
+	 */
+	ORF24TimeSync(ORF24 &_radio, int _payloadSize = 32);
+
+	/**
+	 * Get event timestamps
+	 *
+	 * @return  timestamper
+	 */
+	ORF24Timestamper &getTimestamper(void);
+
+	/**
+	 * Set largest accepted error of a pair
+	 *
+	 * @param ns 	error in nanoseconds
+	 */
+	void setMaxError(unsigned int ns);
+
+	/**
+	 * Send a beacon, on the master
+	 *
+	 * Disable auto ACK on pipe 0 so TX_DS marks the end of the packet.
+	 *
+	 * @return  true if sent
+	 */
+	bool sendBeacon(void);
+
+	/**
+	 * Feed a received payload, on receivers
+	 *
+	 * @param  payload 	received payload
+	 * @param  time    	arrival time
+	 * @return         	true if payload is a beacon
+	 */
+	bool handle(const unsigned char *payload, const PacketTime &time);
+
+	/**
+	 * Read and handle every received payload, for nodes only listening
+	 * for beacons
+	 *
+	 * @return  true if a beacon was handled
+	 */
+	bool service(void);
+
+	/**
+	 * Convert local time to master time
+	 *
+	 * @param  local 	local time in nanoseconds
+	 * @return       	master time in nanoseconds
+	 */
+	unsigned long long toMaster(unsigned long long local);
+
+	/**
+	 * Convert master time to local time
+	 *
+	 * @param  master 	master time in nanoseconds
+	 * @return        	local time in nanoseconds
+	 */
+	unsigned long long toLocal(unsigned long long master);
+
+	/**
+	 * Get current master time
+	 *
+	 * @return  time in nanoseconds
+	 */
+	unsigned long long now(void);
+
+	/**
+	 * Check whether offset and drift are estimated
+	 *
+	 * @return  true after two pairs
+	 */
+	bool isSynchronized(void);
+
+	/**
+	 * Get master clock drift relative to local clock
+	 *
+	 * @return  drift in ppm
+	 */
+	double getDrift(void);
+
+	/**
+	 * Get RMS distance of the pairs from the fit
+	 *
+	 * @return  residual in nanoseconds
+	 */
+	double getResidual(void);
+
+	/**
+	 * Get number of pairs accepted
+	 *
+	 * @return  pairs
+	 */
+	unsigned long getSamples(void);
+
+	/**
+	 * Get number of pairs rejected for their error
+	 *
+	 * @return  pairs
+	 */
+	unsigned long getRejected(void);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,286 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _ORF_24_TRANSPORT_H_
+#define _ORF_24_TRANSPORT_H_
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include <wiringPi.h>
+#include <wiringPiSPI.h>
+#include "nRF24L01.h"
+
+#define 	MOSI_PIN		12
+#define 	SLCK_PIN		14
+
+/**
+ * Hardware access used by the radio driver
+ *
+ * The dynamic ORF24 class calls it through a pointer, ORF24Static holds a
+ * concrete transport by value so the calls are bound and inlined at compile
+ * time.
+ */
+class ORF24Transport
+{
+public:
+
+	virtual ~ORF24Transport() { }
+
+	/**
+	 * Set up CE pin and SPI channel
+	 *
+	 * @param  ce 			CE pin number
+	 * @param  spiChannel 	SPI channel
+	 * @param  spiSpeed 	SPI clock frequency in Hz
+	 * @return            	true on success
+	 */
+	virtual bool setup(int ce, int spiChannel, int spiSpeed) = 0;
+
+	/**
+	 * Change SPI clock of a channel that is already set up
+	 *
+	 * @param  spiChannel 	SPI channel
+	 * @param  spiSpeed 	SPI clock frequency in Hz
+	 * @return            	false if not supported
+	 */
+	virtual bool setSpeed(int spiChannel, int spiSpeed)
+	{
+		return false;
+	}
+
+	/**
+	 * Full duplex SPI transfer
+	 *
+	 * @param spiChannel 	SPI channel
+	 * @param buf 			data to send, overwritten with received data
+	 * @param len 			data length
+	 */
+	virtual void transfer(int spiChannel, unsigned char *buf, int len) = 0;
+
+	/**
+	 * Run several two byte transfers, releasing CSN between them
+	 *
+	 * @param spiChannel 	SPI channel
+	 * @param frames 		frames to send, overwritten with received data
+	 * @param count 		number of frames
+	 */
+	virtual void transferBatch(int spiChannel, unsigned char (*frames)[2], int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			transfer(spiChannel, frames[i], 2);
+		}
+	}
+
+	/**
+	 * Drive CE pin
+	 *
+	 * @param ce 		CE pin number
+	 * @param value 	HIGH or LOW
+	 */
+	virtual void writeCE(int ce, int value) = 0;
+
+	/**
+	 * Pulse CE pin high
+	 *
+	 * @param ce 		CE pin number
+	 * @param us 		minimum pulse width in microseconds
+	 */
+	virtual void pulseCE(int ce, unsigned int us)
+	{
+		writeCE(ce, HIGH);
+		delayMicroseconds(us);
+		writeCE(ce, LOW);
+	}
+
+	/**
+	 * Busy wait
+	 *
+	 * @param us 	delay in microseconds
+	 */
+	virtual void delayMicroseconds(unsigned int us) = 0;
+
+	/**
+	 * Get milliseconds clock
+	 *
+	 * @return  time in milliseconds
+	 */
+	virtual unsigned int millis(void) = 0;
+
+	/**
+	 * Get microseconds clock
+	 *
+	 * @return  time in microseconds
+	 */
+	virtual unsigned int micros(void) = 0;
+
+	/**
+	 * Get CLOCK_MONOTONIC
+	 *
+	 * @return  time in nanoseconds
+	 */
+	virtual unsigned long long nanos(void)
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	}
+};
+
+/**
+ * wiringPi transport
+ */
+class WiringPiTransport : public ORF24Transport
+{
+public:
+
+	bool setup(int ce, int spiChannel, int spiSpeed)
+	{
+		::pinMode(ce, OUTPUT);
+		::digitalWrite(ce, LOW);
+
+		if (wiringPiSPISetup(spiChannel, spiSpeed) < 0)
+		{
+			return false;
+		}
+
+		/* Pulldown MOSI and SCK pin */
+		::pullUpDnControl(MOSI_PIN, PUD_DOWN);
+		::pullUpDnControl(SLCK_PIN, PUD_DOWN);
+
+		return true;
+	}
+
+	bool setSpeed(int spiChannel, int spiSpeed)
+	{
+		/* wiringPi keeps the speed per channel, reopen instead of leaking the old fd */
+		int fd = wiringPiSPIGetFd(spiChannel);
+
+		if (fd >= 0)
+		{
+			::close(fd);
+		}
+
+		return wiringPiSPISetup(spiChannel, spiSpeed) >= 0;
+	}
+
+	void transfer(int spiChannel, unsigned char *buf, int len)
+	{
+		wiringPiSPIDataRW(spiChannel, buf, len);
+	}
+
+	void transferBatch(int spiChannel, unsigned char (*frames)[2], int count)
+	{
+		const int maxBatch = 16;
+		struct spi_ioc_transfer xfer[maxBatch] = {};
+
+		int fd = wiringPiSPIGetFd(spiChannel);
+
+		while (count > 0)
+		{
+			int n = count < maxBatch ? count : maxBatch;
+
+			for (int i = 0; i < n; i++)
+			{
+				xfer[i].tx_buf = (unsigned long) frames[i];
+				xfer[i].rx_buf = (unsigned long) frames[i];
+				xfer[i].len = 2;
+				xfer[i].bits_per_word = 8;
+				xfer[i].cs_change = i < n - 1;	/* Release CSN between commands, not after the last */
+			}
+
+			/* Fall back to one transfer per frame if batching is unsupported */
+			if (fd < 0 || ioctl(fd, SPI_IOC_MESSAGE(n), xfer) < 0)
+			{
+				ORF24Transport::transferBatch(spiChannel, frames, n);
+			}
+
+			frames += n;
+			count -= n;
+		}
+	}
+
+	void writeCE(int ce, int value)
+	{
+		::digitalWrite(ce, value);
+	}
+
+	void delayMicroseconds(unsigned int us)
+	{
+		::delayMicroseconds(us);
+	}
+
+	unsigned int millis(void)
+	{
+		return ::millis();
+	}
+
+	unsigned int micros(void)
+	{
+		return ::micros();
+	}
+};
+
+/**
+ * Transport that discards SPI traffic and reports every transmission as
+ * sent, used to measure driver overhead without a radio attached
+ */
+class NullTransport : public WiringPiTransport
+{
+public:
+
+	bool setup(int ce, int spiChannel, int spiSpeed)
+	{
+		return true;
+	}
+
+	bool setSpeed(int spiChannel, int spiSpeed)
+	{
+		return true;
+	}
+
+	void transfer(int spiChannel, unsigned char *buf, int len)
+	{
+		buf[0] = 1 << TX_DS;
+	}
+
+	void transferBatch(int spiChannel, unsigned char (*frames)[2], int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			frames[i][0] = 1 << TX_DS;
+		}
+	}
+
+	void writeCE(int ce, int value) { }
+
+	void pulseCE(int ce, unsigned int us) { }
+
+	void delayMicroseconds(unsigned int us) { }
+};
+
+#endif
\ No newline at end of file
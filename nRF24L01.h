@@ -114,8 +114,10 @@
 #define 	RH_CH 					0
 
 /* RF_SETUP Register Mnemonics */
+#define 	RF_DR_LOW 				5
 #define 	PLL_LOCK 				4
 #define 	RF_DR 					3
+#define 	RF_DR_HIGH 				3
 #define 	RF_PWR_HIGH				2
 #define 	RF_PWR_LOW				1
 #define 	LNA_HCURR				0
@@ -158,9 +160,16 @@
 enum CRCLength {CRC_1_BYTE = 0, CRC_2_BYTE, CRC_DISABLED};
 
 /* 	Air Data Rate */
-enum DataRate {RF_DR_1MBPS = 0, RF_DR_2MBPS};
+enum DataRate {RF_DR_1MBPS = 0, RF_DR_2MBPS, RF_DR_250KBPS};
 
 /* RF Output Power */
 enum RFPower {RF_PA_MIN = 0, RF_PA_LOW, RF_PA_HIGH, RF_PA_MAX};
 
+/* Operating Mode */
+enum PowerState {POWER_DOWN = 0, POWER_STANDBY, POWER_TX, POWER_RX};
+
+/* Chip Health Faults, combined as a bit mask */
+enum HealthFault {HEALTH_OK = 0, HEALTH_NO_CHIP = 1, HEALTH_CONFIG = 2, HEALTH_MAX_RT = 4,
+	HEALTH_TX_STUCK = 8, HEALTH_RX_STUCK = 16, HEALTH_TIMEOUT = 32};
+
 #endif
\ No newline at end of file
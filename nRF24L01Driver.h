@@ -0,0 +1,287 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _NRF24L01_DRIVER_H_
+#define _NRF24L01_DRIVER_H_
+
+#include "nRF24L01.h"
+#include "nRF24L01Register.h"
+
+namespace nRF24L01
+{
+	/**
+	 * Register sequences shared by ORF24 and ORF24Static
+	 *
+	 * Chip is the driver class. It provides readRegister, writeRegister,
+	 * writePayload, powerDown and flushTX with the signatures of ORF24 and
+	 * declares Driver a friend. With ORF24Static every call is bound at
+	 * compile time, with ORF24 the transport is reached through a pointer.
+	 *
+	 * @tparam Chip 	driver class
+	 */
+	template <class Chip>
+	struct Driver
+	{
+		/**
+		 * Check whether nRF24L01 is connected and responding
+		 *
+		 * Two patterns are used so a floating or stuck MISO line can not pass.
+		 *
+		 * @param  chip 	driver
+		 * @return      	true if chip is present
+		 */
+		static bool isChipConnected(Chip &chip)
+		{
+			chip.writeRegister(SETUP_AW, 0b01);
+			bool pass = chip.readRegister(SETUP_AW) == 0b01;
+
+			chip.writeRegister(SETUP_AW, 0b11);
+			pass = pass && chip.readRegister(SETUP_AW) == 0b11;
+
+			return pass;
+		}
+
+		/**
+		 * Wait until nRF24L01 responds to register access
+		 *
+		 * @param  chip 		driver
+		 * @param  transport 	SPI and GPIO access
+		 * @param  timeout 		maximum wait time in milliseconds
+		 * @return         		true if chip is ready
+		 */
+		template <class Transport>
+		static bool waitForChip(Chip &chip, Transport &transport, unsigned long timeout)
+		{
+			unsigned int startedAt = transport.millis();
+
+			while (!chip.isChipConnected())
+			{
+				if (transport.millis() - startedAt >= timeout)
+				{
+					return false;
+				}
+
+				transport.delayMicroseconds(500);
+			}
+
+			return true;
+		}
+
+		/**
+		 * Enter TX mode
+		 *
+		 * The 150 us start up is only needed from power down.
+		 *
+		 * @param  chip 		driver
+		 * @param  transport 	SPI and GPIO access
+		 * @return           	CONFIG value written
+		 */
+		template <class Transport>
+		static unsigned char enterTX(Chip &chip, Transport &transport)
+		{
+			unsigned char config = chip.readRegister(CONFIG);
+			bool poweredUp = PowerUp::decode(config);
+
+			config = PrimaryRX::update(PowerUp::update(config, 1), 0);
+			chip.writeRegister(CONFIG, config);
+
+			if (!poweredUp)
+			{
+				transport.delayMicroseconds(150);
+			}
+
+			return config;
+		}
+
+		/**
+		 * Poll until a write raised TX_DS or MAX_RT
+		 *
+		 * @param  chip 		driver
+		 * @param  transport 	SPI and GPIO access
+		 * @param  timeout 		maximum wait time in milliseconds
+		 * @param  observeTX 	set to OBSERVE_TX at the end of the write
+		 * @return           	nRF24L01 status, neither flag set on timeout
+		 */
+		template <class Transport>
+		static unsigned char waitForWrite(Chip &chip, Transport &transport, unsigned long timeout, unsigned char *observeTX)
+		{
+			unsigned char status;
+			unsigned int sentAt = transport.millis();
+
+			do
+			{
+				status = chip.readRegister(OBSERVE_TX, observeTX, 1);
+			} while (!(status & (1 << TX_DS | 1 << MAX_RT)) && (transport.millis() - sentAt < timeout));
+
+			return status;
+		}
+
+		/**
+		 * Clear interrupt flags, power down and drop an undelivered payload
+		 *
+		 * @param  chip 	driver
+		 * @return      	nRF24L01 status before clearing
+		 */
+		static unsigned char finishWrite(Chip &chip)
+		{
+			unsigned char status = chip.writeRegister(STATUS, IRQFlags::mask);
+
+			chip.powerDown();
+			chip.flushTX();
+
+			return status;
+		}
+
+		/**
+		 * Set or clear PWR_UP
+		 *
+		 * @param chip 		driver
+		 * @param enable 	power up or power down
+		 */
+		static void setPowerUp(Chip &chip, bool enable)
+		{
+			chip.writeRegister(CONFIG, PowerUp::update(chip.readRegister(CONFIG), enable));
+		}
+
+		/**
+		 * Set delay and number of retry for retransmission
+		 *
+		 * @param  chip 	driver
+		 * @param  delay 	RetransmitDelay field value
+		 * @param  count 	retransmission count
+		 * @return       	SETUP_RETR value written
+		 */
+		static unsigned char setRetries(Chip &chip, int delay, int count)
+		{
+			unsigned char setup = RetransmitDelay::encode(delay) | RetransmitCount::encode(count);
+
+			chip.writeRegister(SETUP_RETR, setup);
+
+			return setup;
+		}
+
+		/**
+		 * Set RF channel
+		 *
+		 * @param chip 		driver
+		 * @param channel 	channel number
+		 */
+		static void setChannel(Chip &chip, int channel)
+		{
+			const int max = 127;
+
+			chip.writeRegister(RF_CH, max > channel ? channel : max);
+		}
+
+		/**
+		 * Set power level
+		 *
+		 * @param chip 		driver
+		 * @param level 	power level
+		 */
+		static void setPowerLevel(Chip &chip, RFPower level)
+		{
+			chip.writeRegister(RF_SETUP, PowerLevel::update(chip.readRegister(RF_SETUP), level));
+		}
+
+		/**
+		 * Set air data rate
+		 *
+		 * @param chip 		driver
+		 * @param rate 		data rate
+		 */
+		static void setDataRate(Chip &chip, DataRate rate)
+		{
+			unsigned char setup = chip.readRegister(RF_SETUP);
+
+			setup = AirDataRate::update(setup, airDataRate(rate));
+			setup = AirDataRateLow::update(setup, airDataRateLow(rate));
+
+			chip.writeRegister(RF_SETUP, setup);
+		}
+
+		/**
+		 * Set CRC length
+		 *
+		 * @param chip 		driver
+		 * @param length 	CRC length
+		 */
+		static void setCRCLength(Chip &chip, CRCLength length)
+		{
+			chip.writeRegister(CONFIG, CRCEncoding::update(chip.readRegister(CONFIG), crcEncoding(length)));
+		}
+
+		/**
+		 * Set auto acknowledgment on every pipe
+		 *
+		 * @param chip 		driver
+		 * @param enable 	enable or disable auto acknowledgment
+		 */
+		static void setAutoACK(Chip &chip, bool enable)
+		{
+			chip.writeRegister(EN_AA, enable ? AutoACKPipes::mask : 0);
+		}
+
+		/**
+		 * Write the transmit address, pipe 0 receives the ACK
+		 *
+		 * @param chip 			driver
+		 * @param address 		pipe address
+		 * @param addressSize 	address width in bytes
+		 */
+		static void writeTXAddress(Chip &chip, const unsigned char *address, int addressSize)
+		{
+			chip.writeRegister(RX_ADDR_P0, address, addressSize);
+			chip.writeRegister(TX_ADDR, address, addressSize);
+		}
+
+		/**
+		 * Write the address of a reading pipe
+		 *
+		 * Reading addresses are given in reverse byte order. Pipe 2 to 5
+		 * share the upper address bytes of pipe 1, so only the LSB byte is
+		 * written.
+		 *
+		 * @param  chip 		driver
+		 * @param  pipe 		pipe number
+		 * @param  address 		pipe address
+		 * @param  addressSize 	address width in bytes
+		 * @param  reversed 	set to the address as written to pipe 0 or 1
+		 */
+		static void writeRXAddress(Chip &chip, int pipe, const unsigned char *address, int addressSize, unsigned char *reversed)
+		{
+			for (int i = 0; i < addressSize; i++)
+			{
+				reversed[i] = address[addressSize - 1 - i];
+			}
+
+			if (pipe < 2)
+				chip.writeRegister(pipeAddressRegister(pipe), reversed, addressSize);
+			else
+				chip.writeRegister(pipeAddressRegister(pipe), reversed[0]);
+		}
+	};
+}
+
+#endif
\ No newline at end of file
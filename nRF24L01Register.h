@@ -0,0 +1,402 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _NRF24L01_REGISTER_H_
+#define _NRF24L01_REGISTER_H_
+
+#include <cstring>
+#include "nRF24L01.h"
+
+/**
+ * Compile time register description
+ *
+ * Registers and fields are types, so masks and shifts are constants and a
+ * configuration built only from constants folds into a precomputed list of
+ * register writes.
+ */
+namespace nRF24L01
+{
+	/**
+	 * Register
+	 *
+	 * @tparam Address 	register address
+	 */
+	template <unsigned char Address>
+	struct Register
+	{
+		static constexpr unsigned char address = Address;
+	};
+
+	/**
+	 * Bit field inside a register
+	 *
+	 * @tparam Reg 		register type
+	 * @tparam Offset 	position of the lowest bit
+	 * @tparam Width 	field width in bits
+	 */
+	template <class Reg, unsigned char Offset, unsigned char Width>
+	struct Field
+	{
+		static_assert(Offset + Width <= 8, "Field does not fit in register");
+
+		typedef Reg reg;
+
+		static constexpr unsigned char offset = Offset;
+		static constexpr unsigned char max = (1 << Width) - 1;
+		static constexpr unsigned char mask = max << Offset;
+
+		/**
+		 * Encode field value into its register position
+		 *
+		 * @param  value 	field value
+		 * @return       	register bits
+		 */
+		static constexpr unsigned char encode(unsigned char value)
+		{
+			return (value << Offset) & mask;
+		}
+
+		/**
+		 * Decode field value from register value
+		 *
+		 * @param  reg 		register value
+		 * @return     		field value
+		 */
+		static constexpr unsigned char decode(unsigned char reg)
+		{
+			return (reg & mask) >> Offset;
+		}
+
+		/**
+		 * Replace field value in register value
+		 *
+		 * @param  reg 		register value
+		 * @param  value 	new field value
+		 * @return       	updated register value
+		 */
+		static constexpr unsigned char update(unsigned char reg, unsigned char value)
+		{
+			return (reg & ~mask) | encode(value);
+		}
+	};
+
+	/**
+	 * Constant field value
+	 *
+	 * @tparam F 		field type
+	 * @tparam Value 	field value
+	 */
+	template <class F, unsigned char Value>
+	struct Set
+	{
+		static_assert(Value <= F::max, "Value does not fit in field");
+
+		typedef typename F::reg reg;
+
+		static constexpr unsigned char value = F::encode(Value);
+	};
+
+	/**
+	 * OR together field values of one register
+	 */
+	template <class Reg, class... Sets>
+	struct Combine;
+
+	template <class Reg>
+	struct Combine<Reg>
+	{
+		static constexpr unsigned char value = 0;
+	};
+
+	template <class Reg, class S, class... Sets>
+	struct Combine<Reg, S, Sets...>
+	{
+		static_assert(S::reg::address == Reg::address, "Field belongs to another register");
+
+		static constexpr unsigned char value = S::value | Combine<Reg, Sets...>::value;
+	};
+
+	/**
+	 * Constant register write
+	 *
+	 * Fields not listed are written as zero.
+	 *
+	 * @tparam Reg 		register type
+	 * @tparam Sets 	field values
+	 */
+	template <class Reg, class... Sets>
+	struct Write
+	{
+		static constexpr unsigned char address = Reg::address;
+		static constexpr unsigned char value = Combine<Reg, Sets...>::value;
+	};
+
+	/**
+	 * Constant list of register writes
+	 *
+	 * @tparam Writes 	register writes in order
+	 */
+	template <class... Writes>
+	struct WriteList
+	{
+		static constexpr int count = sizeof...(Writes);
+		static constexpr unsigned char regs[sizeof...(Writes)][2] = { { Writes::address, Writes::value }... };
+	};
+
+	template <class... Writes>
+	constexpr unsigned char WriteList<Writes...>::regs[sizeof...(Writes)][2];
+
+	/* Registers */
+	typedef Register<CONFIG> Config;
+	typedef Register<EN_AA> EnableAA;
+	typedef Register<EN_RXADDR> EnableRXAddress;
+	typedef Register<SETUP_AW> SetupAW;
+	typedef Register<SETUP_RETR> SetupRetr;
+	typedef Register<RF_CH> RFChannel;
+	typedef Register<RF_SETUP> RFSetup;
+	typedef Register<STATUS> Status;
+	typedef Register<OBSERVE_TX> ObserveTX;
+	typedef Register<FIFO_STATUS> FIFOStatus;
+	typedef Register<DYNPD> DynamicPayload;
+	typedef Register<FEATURE> Feature;
+
+	/* CONFIG fields */
+	typedef Field<Config, MASK_MAX_RT, 3> IRQMask;
+	typedef Field<Config, CRCO, 2> CRCEncoding;
+	typedef Field<Config, PWR_UP, 1> PowerUp;
+	typedef Field<Config, PRIM_RX, 1> PrimaryRX;
+
+	/* EN_AA and EN_RXADDR fields */
+	typedef Field<EnableAA, ENAA_P0, 6> AutoACKPipes;
+	typedef Field<EnableRXAddress, ERX_P0, 6> RXPipes;
+
+	/* SETUP_AW fields */
+	typedef Field<SetupAW, AW, 2> AddressWidth;
+
+	/* SETUP_RETR fields */
+	typedef Field<SetupRetr, ARD, 4> RetransmitDelay;
+	typedef Field<SetupRetr, ARC, 4> RetransmitCount;
+
+	/* RF_CH fields */
+	typedef Field<RFChannel, RH_CH, 7> Channel;
+
+	/* RF_SETUP fields */
+	typedef Field<RFSetup, RF_DR_HIGH, 1> AirDataRate;
+	typedef Field<RFSetup, RF_DR_LOW, 1> AirDataRateLow;
+	typedef Field<RFSetup, RF_PWR_LOW, 2> PowerLevel;
+	typedef Field<RFSetup, LNA_HCURR, 1> LNAGain;
+
+	/* STATUS fields */
+	typedef Field<Status, MAX_RT, 3> IRQFlags;
+	typedef Field<Status, RX_P_NO, 3> RXPipeNumber;
+
+	/* OBSERVE_TX fields */
+	typedef Field<ObserveTX, PLOS_CNT, 4> LostPackets;
+	typedef Field<ObserveTX, ARC_CNT, 4> RetransmitCounter;
+
+	/* DYNPD fields */
+	typedef Field<DynamicPayload, DPL_P0, 6> DynamicPayloadPipes;
+
+	/**
+	 * CRCEncoding field value for a CRC length
+	 *
+	 * @param  length 	CRC length
+	 * @return        	field value
+	 */
+	constexpr unsigned char crcEncoding(CRCLength length)
+	{
+		return length == CRC_2_BYTE ? 0b11 : length == CRC_1_BYTE ? 0b10 : 0b00;
+	}
+
+	/**
+	 * AirDataRate field value for a data rate
+	 *
+	 * @param  rate 	data rate
+	 * @return      	field value
+	 */
+	constexpr unsigned char airDataRate(DataRate rate)
+	{
+		return rate == RF_DR_2MBPS ? 1 : 0;
+	}
+
+	/**
+	 * AirDataRateLow field value for a data rate
+	 *
+	 * @param  rate 	data rate
+	 * @return      	field value
+	 */
+	constexpr unsigned char airDataRateLow(DataRate rate)
+	{
+		return rate == RF_DR_250KBPS ? 1 : 0;
+	}
+
+	/**
+	 * Shortest valid RetransmitDelay field value
+	 *
+	 * ARD must cover the ACK packet air time, which depends on data rate and
+	 * ACK payload length (nRF24L01+ product specification, section 7.4.2).
+	 * The delay is (ARD + 1) * 250 us.
+	 *
+	 * @param  rate 			data rate
+	 * @param  ackPayloadSize 	largest ACK payload in bytes
+	 * @return                	field value
+	 */
+	constexpr unsigned char minimumRetryDelay(DataRate rate, int ackPayloadSize)
+	{
+		return rate == RF_DR_250KBPS ?
+				(ackPayloadSize == 0 ? 1 : ackPayloadSize <= 8 ? 2 : ackPayloadSize <= 16 ? 3 : ackPayloadSize <= 24 ? 4 : 5) :
+			rate == RF_DR_1MBPS ?
+				(ackPayloadSize <= 5 ? 0 : 1) :
+				(ackPayloadSize <= 15 ? 0 : 1);
+	}
+
+	/**
+	 * Air data rate in kbps
+	 *
+	 * @param  rate 	data rate
+	 * @return      	kbps
+	 */
+	constexpr unsigned int dataRateKbps(DataRate rate)
+	{
+		return rate == RF_DR_250KBPS ? 250 : rate == RF_DR_2MBPS ? 2000 : 1000;
+	}
+
+	/**
+	 * Enhanced ShockBurst packet air time
+	 *
+	 * Preamble, address, 9 bit packet control field, payload and CRC.
+	 *
+	 * @param  rate 			data rate
+	 * @param  payloadSize 		payload size in bytes
+	 * @param  crc 				CRC length
+	 * @param  addressSize 		address width in bytes
+	 * @return             		air time in microseconds
+	 */
+	constexpr unsigned int packetAirTime(DataRate rate, int payloadSize, CRCLength crc, int addressSize = 5)
+	{
+		return ((1 + addressSize + payloadSize) * 8 + 9 +
+			(crc == CRC_2_BYTE ? 16 : crc == CRC_1_BYTE ? 8 : 0)) * 1000 / dataRateKbps(rate);
+	}
+
+	/**
+	 * Longest time a write can take before MAX_RT
+	 *
+	 * Settling, the longest packet at the slowest rate and the retransmission
+	 * delay, for every attempt.
+	 *
+	 * @param  setupRetr 	SETUP_RETR register value
+	 * @return           	timeout in milliseconds
+	 */
+	constexpr unsigned long writeTimeout(unsigned char setupRetr)
+	{
+		return (RetransmitCount::decode(setupRetr) + 1) *
+			(130 + packetAirTime(RF_DR_250KBPS, 32, CRC_2_BYTE) + (RetransmitDelay::decode(setupRetr) + 1) * 250) / 1000 + 5;
+	}
+
+	/* Configuration written at initialization */
+	typedef WriteList<
+		Write<Config, Set<CRCEncoding, crcEncoding(CRC_1_BYTE)> >,
+		Write<SetupRetr, Set<RetransmitDelay, minimumRetryDelay(RF_DR_1MBPS, 0)>, Set<RetransmitCount, 0b1111> >,
+		Write<RFSetup, Set<PowerLevel, RF_PA_MIN>, Set<AirDataRate, airDataRate(RF_DR_1MBPS)>, Set<LNAGain, 1> >,
+		Write<DynamicPayload>,
+		Write<Status, Set<IRQFlags, IRQFlags::max> >,
+		Write<RFChannel, Set<Channel, 0> >
+	> DefaultConfig;
+
+	/**
+	 * Build SPI frame to read a register
+	 *
+	 * @param  frame 	frame buffer of at least len + 1 bytes
+	 * @param  reg 		register address
+	 * @param  len 		data length to read
+	 * @return       	frame length
+	 */
+	inline int readRegisterFrame(unsigned char *frame, unsigned char reg, int len)
+	{
+		frame[0] = R_REGISTER | (RW_MASK & reg);
+		std::memset(frame + 1, NOP, len);
+
+		return len + 1;
+	}
+
+	/**
+	 * Build SPI frame to write a register
+	 *
+	 * @param  frame 	frame buffer of at least len + 1 bytes
+	 * @param  reg 		register address
+	 * @param  buf 		data to write
+	 * @param  len 		data length
+	 * @return       	frame length
+	 */
+	inline int writeRegisterFrame(unsigned char *frame, unsigned char reg, const unsigned char *buf, int len)
+	{
+		frame[0] = W_REGISTER | (RW_MASK & reg);
+		std::memcpy(frame + 1, buf, len);
+
+		return len + 1;
+	}
+
+	/**
+	 * Build SPI frame for a command followed by data, e.g. W_TX_PAYLOAD
+	 *
+	 * With a constant length the copy is unrolled by the compiler.
+	 *
+	 * @param  frame 	frame buffer of at least len + 1 bytes
+	 * @param  command 	SPI command
+	 * @param  data 	data to send
+	 * @param  len 		data length
+	 * @return       	frame length
+	 */
+	inline int commandFrame(unsigned char *frame, unsigned char command, const unsigned char *data, int len)
+	{
+		frame[0] = command;
+		std::memcpy(frame + 1, data, len);
+
+		return len + 1;
+	}
+
+	/**
+	 * RX_ADDR_Px register of a pipe
+	 *
+	 * @param  pipe 	pipe number
+	 * @return      	register address
+	 */
+	constexpr unsigned char pipeAddressRegister(int pipe)
+	{
+		return RX_ADDR_P0 + pipe;
+	}
+
+	/**
+	 * RX_PW_Px register of a pipe
+	 *
+	 * @param  pipe 	pipe number
+	 * @return      	register address
+	 */
+	constexpr unsigned char pipePayloadRegister(int pipe)
+	{
+		return RX_PW_P0 + pipe;
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Driver overhead of ORF24 and ORF24Static, and of ORF24Crypto
+ *
+ * No radio is needed, NullTransport acknowledges every write. Encrypted
+ * packets carry CRYPTO_OVERHEAD bytes less data than plaintext ones. Build
+ * and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o benchmark benchmark.cpp ../ORF24Crypto.cpp ../ORF24.cpp -lwiringPi
+ *     ./benchmark
+ */
+
+#include <cstdio>
+#include "ORF24.h"
+#include "ORF24Static.h"
+#include "ORF24Crypto.h"
+#include "ORF24Benchmark.h"
+
+int main(int argc, char const *argv[])
+{
+	const int count = 1000000;
+
+	unsigned char data[32] = {};
+	unsigned char key[CRYPTO_KEY_SIZE] = {};
+
+	NullTransport null;
+	ORF24 dynamic(25, 0, 8000000, &null);
+	ORF24Static<25, 0, 32, NullTransport> fixed;
+	ORF24Crypto crypto(dynamic, key, 1, 2);
+
+	/* Warm up caches and the branch predictor */
+	benchmarkSend([&] { dynamic.write(data, 32); }, count / 10);
+	benchmarkSend([&] { fixed.write(data); }, count / 10);
+	benchmarkSend([&] { crypto.write(data, 32 - CRYPTO_OVERHEAD); }, count / 10);
+
+	double dynamicRate = benchmarkSend([&] { dynamic.write(data, 32); }, count);
+	double fixedRate = benchmarkSend([&] { fixed.write(data); }, count);
+	double cryptoRate = benchmarkSend([&] { crypto.write(data, 32 - CRYPTO_OVERHEAD); }, count);
+
+	printf("ORF24       %10.0f packets/s\n", dynamicRate);
+	printf("ORF24Static %10.0f packets/s\n", fixedRate);
+	printf("Speedup     %10.2f\n", dynamicRate > 0 ? fixedRate / dynamicRate : 0);
+	printf("ORF24Crypto %10.0f packets/s\n", cryptoRate);
+	printf("Of plain    %10.2f\n", dynamicRate > 0 ? cryptoRate / dynamicRate : 0);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,487 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Bridge end to end and socket checks
+ *
+ * Five simulated sensors send 200 packets each to a gateway, which
+ * forwards them over a Unix datagram socket to a backend in this process.
+ * The backend sends one malformed frame and 10 TX commands per sensor,
+ * and every command must be answered with a TX_RESULT. A datagram from
+ * another socket and one to the UDP port from another port must be
+ * dropped without a result.
+ *
+ * Finally the sustained forwarding rate is measured. NullTransport always
+ * has three packets in the RX FIFO, and a backend thread drains the UDP
+ * socket on loopback. Every forwarded frame must reach the backend. Build
+ * and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -pthread -I.. -o bridge bridge.cpp ../ORF24Simulator.cpp ../ORF24Bridge.cpp \
+ *         ../ORF24.cpp -lwiringPi
+ *     ./bridge
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include "ORF24Simulator.h"
+#include "ORF24Bridge.h"
+#include "ORF24Benchmark.h"
+
+#define		SENSORS			5
+#define		PACKETS			200
+#define		COMMANDS		10
+#define		GATEWAY_PATH	"/tmp/orf24-test-gw"
+#define		BACKEND_PATH	"/tmp/orf24-test-be"
+#define		STRANGER_PATH	"/tmp/orf24-test-st"
+#define		BRIDGE_PORT		47100
+#define		BACKEND_PORT	47101
+#define		STRANGER_PORT	47102
+#define		BENCH_PORT		47103
+#define		BENCH_BACKEND	47104
+#define		ITERATIONS		300000
+
+/**
+ * Open a Unix datagram socket bound to a path
+ *
+ * @param  path 	path to bind, NULL to leave unbound
+ * @return      	socket
+ */
+static int openUnix(const char *path)
+{
+	int s = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+	if (path)
+	{
+		struct sockaddr_un local = {};
+
+		local.sun_family = AF_UNIX;
+		std::strcpy(local.sun_path, path);
+		unlink(path);
+		bind(s, (struct sockaddr *) &local, sizeof(local));
+	}
+
+	return s;
+}
+
+/**
+ * Send a frame to a Unix socket
+ *
+ * @param  s    	socket
+ * @param  path 	destination path
+ * @param  frame 	frame
+ * @param  len  	datagram length
+ * @return      	true if sent
+ */
+static bool sendUnix(int s, const char *path, const BridgeFrame &frame, int len)
+{
+	struct sockaddr_un remote = {};
+
+	remote.sun_family = AF_UNIX;
+	std::strcpy(remote.sun_path, path);
+
+	return sendto(s, &frame, len, MSG_DONTWAIT, (struct sockaddr *) &remote, sizeof(remote)) == len;
+}
+
+/**
+ * Open a UDP socket bound to a loopback port
+ *
+ * @param  port 	port
+ * @return      	socket
+ */
+static int openUDP(int port)
+{
+	int s = socket(AF_INET, SOCK_DGRAM, 0);
+	struct sockaddr_in local = {};
+
+	local.sin_family = AF_INET;
+	local.sin_port = htons(port);
+	local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	bind(s, (struct sockaddr *) &local, sizeof(local));
+
+	return s;
+}
+
+/**
+ * TX command for a sensor
+ *
+ * @param  sensor 	sensor number
+ * @param  number 	command number
+ * @return        	frame
+ */
+static BridgeFrame command(int sensor, int number)
+{
+	BridgeFrame frame = {};
+	char address[6];
+
+	std::sprintf(address, "sen%02d", sensor);
+
+	/* Writing address of a reading pipe is byte reversed */
+	for (int i = 0; i < 5; i++)
+	{
+		frame.address[i] = address[4 - i];
+	}
+
+	frame.type = BRIDGE_TX;
+	frame.len = 32;
+	frame.sequence = sensor * 100 + number;
+	frame.data[0] = 0xDD;
+
+	return frame;
+}
+
+/* Gateway forwarding everything to the backend */
+class Gateway : public SimulatedNode
+{
+public:
+	ORF24Bridge *bridge = NULL;
+	bool opened = false;
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.openReadingPipe(1, "gate1");
+
+		bridge = new ORF24Bridge(radio);
+		bridge->setMaxDelay(2000);
+		opened = bridge->openUnix(GATEWAY_PATH, BACKEND_PATH);
+	}
+
+	long step(ORF24 &radio)
+	{
+		bridge->service(0);
+
+		return 50;
+	}
+};
+
+/* Sensor reporting every 50 ms and listening for commands in between */
+class Sensor : public SimulatedNode
+{
+public:
+	int id;
+	int count = 0;
+	bool writing = false;
+	int commands = 0;
+
+	Sensor(int _id) : id(_id) { }
+
+	void setup(ORF24 &radio)
+	{
+		char address[6];
+
+		radio.fastBegin();
+		radio.getTransport()->delayMicroseconds(id * 9000);
+
+		std::sprintf(address, "sen%02d", id);
+		radio.openWritingPipe("1etag");
+		radio.openReadingPipe(1, address);
+		radio.closeReadingPipe(0);
+	}
+
+	long step(ORF24 &radio)
+	{
+		unsigned char payload[32];
+
+		if (writing)
+		{
+			bool delivered;
+
+			if (!radio.pollWrite(&delivered))
+			{
+				return 50;
+			}
+
+			/* Otherwise uplinks of other sensors land here */
+			writing = false;
+			radio.closeReadingPipe(0);
+			radio.startListening();
+
+			return 47000 + id * 1931;
+		}
+
+		if (radio.available())
+		{
+			radio.read(payload, 32);
+			commands++;
+		}
+
+		if (count == PACKETS)
+		{
+			return 1000;
+		}
+
+		std::memset(payload, 0, sizeof(payload));
+		payload[0] = id;
+		payload[1] = count++;
+
+		/* Pipe 0 receives the ACK, it only stays open during the write */
+		radio.stopListening();
+		radio.openReadingPipe(0, "gate1");
+		radio.startWrite(payload, 32);
+		writing = true;
+
+		return 50;
+	}
+};
+
+/**
+ * Run the sensors against the gateway through a Unix socket
+ *
+ * @return  true if every packet was forwarded or lost on air and every
+ *          command from the backend was answered
+ */
+static bool endToEnd(void)
+{
+	int backend = openUnix(BACKEND_PATH);
+	int stranger = openUnix(STRANGER_PATH);
+	int unbound = openUnix(NULL);
+	ORF24Simulator simulator(7);
+	Gateway gateway;
+	std::vector<Sensor *> sensors;
+	std::vector<BridgeFrame> commands;
+	int seen[SENSORS][PACKETS] = {};
+	int rx = 0, results = 0, delivered = 0, rejected = 0, duplicates = 0;
+	int received = 0;
+
+	simulator.addNode(&gateway, 0, 0);
+
+	for (int i = 0; i < SENSORS; i++)
+	{
+		sensors.push_back(new Sensor(i));
+		simulator.addNode(sensors.back(), 1 + i, 1);
+
+		for (int k = 0; k < COMMANDS; k++)
+		{
+			commands.push_back(command(i, k));
+		}
+	}
+
+	simulator.run(1000);
+
+	/* Neither may make the radio transmit */
+	BridgeFrame intruder = command(0, 99);
+
+	sendUnix(stranger, GATEWAY_PATH, intruder, sizeof(intruder));
+	sendUnix(unbound, GATEWAY_PATH, intruder, sizeof(intruder));
+
+	BridgeFrame malformed = {};
+
+	malformed.type = 9;
+	sendUnix(backend, GATEWAY_PATH, malformed, BRIDGE_HEADER_SIZE);
+
+	size_t next = 0;
+
+	/* 12 s, a sensor sends for about 10 s */
+	for (int t = 0; t < 1200; t++)
+	{
+		simulator.run((t + 1) * 10000ULL);
+
+		while (next < commands.size() && sendUnix(backend, GATEWAY_PATH, commands[next], sizeof(BridgeFrame)))
+		{
+			next++;
+		}
+
+		BridgeFrame frame;
+
+		while (recv(backend, &frame, sizeof(frame), MSG_DONTWAIT) > 0)
+		{
+			if (frame.type == BRIDGE_RX && frame.data[0] < SENSORS && frame.data[1] < PACKETS)
+			{
+				if (seen[frame.data[0]][frame.data[1]]++)
+				{
+					duplicates++;
+				}
+
+				rx++;
+			}
+			else if (frame.type == BRIDGE_TX_RESULT)
+			{
+				results++;
+				delivered += frame.status == BRIDGE_DELIVERED;
+				rejected += frame.status == BRIDGE_REJECTED;
+			}
+		}
+	}
+
+	for (Sensor *sensor : sensors)
+	{
+		received += sensor->commands;
+	}
+
+	ORF24Bridge *bridge = gateway.bridge;
+
+	printf("unix: rx %d duplicates %d dropped %lu results %d delivered %d rejected %d foreign %lu sensors got %d\n",
+		rx, duplicates, bridge->getUplinkDropped(), results, delivered, rejected, bridge->getForeign(), received);
+
+	bool pass = gateway.opened && rx > SENSORS * PACKETS * 9 / 10 && bridge->getUplinkDropped() == 0;
+
+	pass = pass && results == SENSORS * COMMANDS + 1 && rejected == 1 && received >= delivered;
+	pass = pass && bridge->getForeign() == 2;
+
+	bridge->close();
+	close(backend);
+	close(stranger);
+	close(unbound);
+	unlink(BACKEND_PATH);
+	unlink(STRANGER_PATH);
+
+	return pass;
+}
+
+/**
+ * Send commands to the UDP socket from the backend port and another port
+ *
+ * @return  true if only the backend command was accepted
+ */
+static bool udpPeer(void)
+{
+	NullTransport null;
+	ORF24 radio(25, 0, 8000000, &null);
+	ORF24Bridge bridge(radio);
+	int backend = openUDP(BACKEND_PORT);
+	int stranger = openUDP(STRANGER_PORT);
+	struct sockaddr_in remote = {};
+
+	radio.begin();
+
+	if (!bridge.openUDP(BRIDGE_PORT, "127.0.0.1", BACKEND_PORT))
+	{
+		printf("udp: open failed\n");
+		return false;
+	}
+
+	remote.sin_family = AF_INET;
+	remote.sin_port = htons(BRIDGE_PORT);
+	remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	BridgeFrame frame = command(0, 0);
+
+	sendto(stranger, &frame, sizeof(frame), 0, (struct sockaddr *) &remote, sizeof(remote));
+	sendto(backend, &frame, sizeof(frame), 0, (struct sockaddr *) &remote, sizeof(remote));
+
+	/* Loopback delivers before sendto returns */
+	bridge.service(0);
+
+	printf("udp: commands %lu foreign %lu\n", bridge.getCommands(), bridge.getForeign());
+
+	bool pass = bridge.getCommands() == 1 && bridge.getForeign() == 1;
+
+	bridge.close();
+	close(backend);
+	close(stranger);
+
+	return pass;
+}
+
+/**
+ * Forward from NullTransport to a backend thread over loopback UDP
+ *
+ * @return  true if nothing was dropped on the way
+ */
+static bool throughput(void)
+{
+	NullTransport null;
+	ORF24 radio(25, 0, 8000000, &null);
+	ORF24Bridge bridge(radio);
+	int backend = openUDP(BENCH_BACKEND);
+	int size = 8 << 20;
+	struct timeval timeout = {0, 10000};
+
+	setsockopt(backend, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	setsockopt(backend, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	radio.begin();
+
+	if (!bridge.openUDP(BENCH_PORT, "127.0.0.1", BENCH_BACKEND))
+	{
+		printf("bench: open failed\n");
+		return false;
+	}
+
+	std::atomic<bool> running(true);
+	std::atomic<unsigned long> drained(0);
+
+	std::thread drain([&] {
+		static BridgeFrame frames[BRIDGE_BATCH];
+		struct iovec iov[BRIDGE_BATCH];
+		struct mmsghdr msgs[BRIDGE_BATCH];
+
+		while (running)
+		{
+			std::memset(msgs, 0, sizeof(msgs));
+
+			for (int i = 0; i < BRIDGE_BATCH; i++)
+			{
+				iov[i].iov_base = &frames[i];
+				iov[i].iov_len = sizeof(BridgeFrame);
+				msgs[i].msg_hdr.msg_iov = &iov[i];
+				msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int count = recvmmsg(backend, msgs, BRIDGE_BATCH, MSG_WAITFORONE, NULL);
+
+			if (count > 0)
+			{
+				drained += count;
+			}
+		}
+	});
+
+	double rate = benchmarkSend([&] { bridge.service(0); }, ITERATIONS);
+
+	/* Let the backend catch up with the last batches */
+	usleep(100000);
+	running = false;
+	drain.join();
+
+	unsigned long forwarded = bridge.getForwarded();
+
+	printf("bench: %.0f packets/s, forwarded %lu backend %lu dropped %lu, %.1f packets per sendmmsg\n",
+		rate * 3, forwarded, drained.load(), bridge.getUplinkDropped(),
+		bridge.getSendCalls() ? (double) forwarded / bridge.getSendCalls() : 0);
+
+	bridge.close();
+	close(backend);
+
+	return forwarded > 0 && drained == forwarded && bridge.getUplinkDropped() == 0;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = endToEnd();
+
+	pass = udpPeer() && pass;
+	pass = throughput() && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Bulk transfer completion time and missing receivers
+ *
+ * Distributes a 64 KB image to 1, 10, 50 and 150 receivers with a bit
+ * error rate of 2e-5 and reports the completion time, rounds and repair
+ * traffic of each. The sizes run in parallel, one simulator per thread.
+ * Every receiver must end with a verified image.
+ *
+ * Then the sender expects four receivers but only three exist. It must stop
+ * after the round limit and name the missing one. The receivers must not
+ * keep pipe 0 open after a reply, or NACKs of their neighbours to the
+ * sender would be received there. Build and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -pthread -I.. -o bulk bulk.cpp ../ORF24Simulator.cpp ../ORF24Bulk.cpp ../ORF24.cpp -lwiringPi
+ *     ./bulk
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ORF24Simulator.h"
+#include "ORF24Bulk.h"
+#include "nRF24L01Register.h"
+
+#define		IMAGE_SIZE		65536
+#define		ABORT_SIZE		4000
+#define		RECEIVERS		3
+#define		MAX_ROUNDS		5
+
+static unsigned char image[IMAGE_SIZE];
+
+/* Sender of the image */
+class Gateway : public SimulatedNode
+{
+public:
+	ORF24BulkSender *sender = NULL;
+	unsigned long size;
+	int nodes;
+	int maxRounds;
+	bool finished = false;
+
+	Gateway(unsigned long _size, int _nodes, int _maxRounds) : size(_size), nodes(_nodes), maxRounds(_maxRounds) { }
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+
+		sender = new ORF24BulkSender(radio, "bcast", "reply");
+		sender->setLimits(maxRounds, 0);
+		sender->begin(image, size, 1, nodes);
+	}
+
+	long step(ORF24 &radio)
+	{
+		if (!sender->service())
+		{
+			finished = true;
+			return -1;
+		}
+
+		return 20;
+	}
+};
+
+/* Receiver with its own image buffer */
+class Receiver : public SimulatedNode
+{
+public:
+	ORF24BulkReceiver *receiver = NULL;
+	std::vector<unsigned char> buffer;
+	int node;
+
+	Receiver(int _node, unsigned long size) : buffer(size), node(_node) { }
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+
+		receiver = new ORF24BulkReceiver(radio, node, "bcast", "reply", buffer.data(), buffer.size());
+		receiver->begin();
+	}
+
+	long step(ORF24 &radio)
+	{
+		receiver->service();
+
+		return 100;
+	}
+
+	/**
+	 * Check the received image
+	 *
+	 * @return  true if complete and equal to the image
+	 */
+	bool verify(void)
+	{
+		return receiver->isComplete() && std::memcmp(buffer.data(), image, buffer.size()) == 0;
+	}
+};
+
+/* Network of one gateway and its receivers */
+struct Network
+{
+	ORF24Simulator simulator;
+	Gateway gateway;
+	std::vector<Receiver *> receivers;
+
+	/**
+	 * Place receivers on a grid 30 cm apart next to the gateway
+	 *
+	 * @param seed      	simulator seed
+	 * @param size      	image size
+	 * @param nodes     	receivers the gateway expects
+	 * @param present   	receivers that exist
+	 * @param maxRounds 	round limit of the gateway
+	 */
+	Network(int seed, unsigned long size, int nodes, int present, int maxRounds)
+		: simulator(seed),
+		  gateway(size, nodes, maxRounds)
+	{
+		simulator.addNode(&gateway, 0, 0);
+
+		for (int i = 0; i < present; i++)
+		{
+			receivers.push_back(new Receiver(i, size));
+			simulator.addNode(receivers.back(), 1 + (i % 10) * 0.3, (i / 10) * 0.3);
+		}
+	}
+
+	~Network()
+	{
+		for (Receiver *receiver : receivers)
+		{
+			delete receiver;
+		}
+	}
+
+	/**
+	 * Count receivers holding the whole image
+	 *
+	 * @return  verified receivers
+	 */
+	int verified(void)
+	{
+		int count = 0;
+
+		for (Receiver *receiver : receivers)
+		{
+			count += receiver->verify();
+		}
+
+		return count;
+	}
+};
+
+/**
+ * Read EN_RXADDR through the transport
+ *
+ * @param  radio 	radio
+ * @return       	register value
+ */
+static unsigned char readEnabledPipes(ORF24 &radio)
+{
+	unsigned char frame[2];
+
+	nRF24L01::readRegisterFrame(frame, EN_RXADDR, 1);
+	radio.getTransport()->transfer(0, frame, 2);
+
+	return frame[1];
+}
+
+/**
+ * Completion time against number of receivers
+ *
+ * @return  true if every transfer finished and verified
+ */
+static bool sweep(void)
+{
+	const int sizes[] = { 1, 10, 50, 150 };
+	const int count = sizeof(sizes) / sizeof(sizes[0]);
+	std::vector<Network *> networks;
+	std::vector<ORF24Simulator *> simulators;
+	bool pass = true;
+
+	for (int i = 0; i < count; i++)
+	{
+		networks.push_back(new Network(sizes[i], IMAGE_SIZE, sizes[i], sizes[i], 32));
+		networks.back()->simulator.setBitErrorRate(2e-5);
+		simulators.push_back(&networks.back()->simulator);
+	}
+
+	ORF24Simulator::runParallel(simulators, 60000000ULL, 0);
+
+	printf("receivers  time ms  rounds  blocks sent  NACKs  verified\n");
+
+	for (Network *network : networks)
+	{
+		ORF24BulkSender *sender = network->gateway.sender;
+		int nodes = network->receivers.size();
+		int verified = network->verified();
+
+		printf("%9d  %7u  %6d  %11lu  %5lu  %8d\n", nodes, sender->getCompletionTime(), sender->getRounds(),
+			sender->getBlocksSent(), sender->getNacks(), verified);
+
+		pass = network->gateway.finished && !sender->isAborted() && verified == nodes && pass;
+
+		delete network;
+	}
+
+	return pass;
+}
+
+/**
+ * Sender expecting one receiver more than there are
+ *
+ * @return  true if the sender gave up on the missing one only
+ */
+static bool missingReceiver(void)
+{
+	Network network(7, ABORT_SIZE, RECEIVERS + 1, RECEIVERS, MAX_ROUNDS);
+	bool pass = true;
+
+	network.simulator.run(20000000ULL);
+
+	ORF24BulkSender *sender = network.gateway.sender;
+	int incomplete[RECEIVERS + 1];
+	int count = sender->getIncomplete(incomplete, RECEIVERS + 1);
+
+	printf("finished %d aborted %d rounds %d completed %d incomplete %d\n", network.gateway.finished,
+		sender->isAborted(), sender->getRounds(), sender->getCompleted(), count);
+
+	pass = network.gateway.finished && sender->isAborted() && sender->getRounds() == MAX_ROUNDS && pass;
+	pass = count == 1 && incomplete[0] == RECEIVERS && pass;
+
+	for (int i = 0; i < RECEIVERS; i++)
+	{
+		unsigned char pipes = readEnabledPipes(network.simulator.getRadio(i + 1));
+		bool verified = network.receivers[i]->verify();
+
+		printf("receiver %d verified %d EN_RXADDR %02X\n", i, verified, pipes);
+
+		pass = verified && !(pipes & 0x01) && pass;
+	}
+
+	return pass;
+}
+
+int main(int argc, char const *argv[])
+{
+	for (int i = 0; i < IMAGE_SIZE; i++)
+	{
+		image[i] = i * 31 + 7;
+	}
+
+	bool pass = sweep();
+
+	pass = missingReceiver() && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,276 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Length-prefixed framing of ORF24Coalescer
+ *
+ * Captures the payloads the coalescer writes and reads them back with
+ * ORF24CoalescedReader. Messages must come out in order and unchanged,
+ * a payload must be sent when it is full, and a lone message must wait
+ * exactly until the deadline. A payload size below 2 is raised to 2, so
+ * 1 byte messages still go out. Build and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o coalescer coalescer.cpp ../ORF24Coalescer.cpp ../ORF24.cpp -lwiringPi
+ *     ./coalescer
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ORF24.h"
+#include "ORF24Coalescer.h"
+#include "nRF24L01.h"
+
+typedef std::vector<unsigned char> Packet;
+
+/* Transport keeping every payload written, on a clock the test advances */
+class CaptureTransport : public NullTransport
+{
+public:
+	std::vector<Packet> packets;
+	unsigned int now = 0;
+
+	void transfer(int spiChannel, unsigned char *buf, int len)
+	{
+		if (buf[0] == W_TX_PAYLOAD)
+		{
+			packets.push_back(Packet(buf + 1, buf + len));
+		}
+
+		NullTransport::transfer(spiChannel, buf, len);
+	}
+
+	void delayMicroseconds(unsigned int us)
+	{
+		now += us;
+	}
+
+	unsigned int millis(void)
+	{
+		return now / 1000;
+	}
+
+	unsigned int micros(void)
+	{
+		return now;
+	}
+
+	unsigned long long nanos(void)
+	{
+		return now * 1000ULL;
+	}
+};
+
+/**
+ * Build test message
+ *
+ * @param  n    	message number
+ * @param  data 	set to message
+ * @return      	message length
+ */
+static int message(int n, unsigned char *data)
+{
+	int len = 1 + (n * 7) % 31;
+
+	for (int i = 0; i < len; i++)
+	{
+		data[i] = n * 13 + i;
+	}
+
+	return len;
+}
+
+/**
+ * Read every message in captured payloads
+ *
+ * @param  packets 	payloads
+ * @param  first   	number of the first message expected
+ * @return         	number of matching messages, -1 on a mismatch
+ */
+static int unpack(const std::vector<Packet> &packets, int first)
+{
+	int n = first;
+
+	for (size_t p = 0; p < packets.size(); p++)
+	{
+		ORF24CoalescedReader reader(packets[p].data(), packets[p].size());
+		const unsigned char *data;
+		int len;
+
+		while (reader.next(&data, &len))
+		{
+			unsigned char expected[32];
+
+			if (message(n, expected) != len || std::memcmp(expected, data, len) != 0)
+			{
+				return -1;
+			}
+
+			n++;
+		}
+	}
+
+	return n - first;
+}
+
+/**
+ * Pack 200 messages of 1 to 31 bytes and read them back
+ *
+ * @return  true if all messages arrived in order and payloads were full
+ */
+static bool packing(void)
+{
+	CaptureTransport capture;
+	ORF24 radio(25, 0, 8000000, &capture);
+	ORF24Coalescer coalescer(radio);
+	unsigned char data[32];
+	bool ok = true;
+
+	radio.begin();
+	coalescer.setDeadline(1000000);
+
+	for (int n = 0; n < 200; n++)
+	{
+		int len = message(n, data);
+
+		ok = coalescer.send(data, len) && ok;
+	}
+
+	coalescer.flush();
+
+	/* Too long and empty messages are refused */
+	ok = ok && !coalescer.send(data, 32) && !coalescer.send(data, 0);
+
+	int read = unpack(capture.packets, 0);
+	int wasted = 0;
+	int n = 0;
+
+	/* Every payload but the last was sent because the next message did not fit */
+	for (size_t p = 0; p < capture.packets.size(); p++)
+	{
+		const Packet &packet = capture.packets[p];
+		int used = 0;
+
+		while (used < 32 && packet[used])
+		{
+			used += 1 + packet[used];
+			n++;
+		}
+
+		if (p + 1 < capture.packets.size())
+		{
+			ok = ok && packet.size() == 32 && used + 1 + message(n, data) > 32;
+			wasted += 32 - used;
+		}
+	}
+
+	printf("packing: packets %d read %d messages per packet %.2f unused %d bytes\n",
+		(int) capture.packets.size(), read, coalescer.getMessagesPerPacket(), wasted);
+
+	return ok && read == 200 && coalescer.getMessagesPerPacket() > 1;
+}
+
+/**
+ * Send on the deadline
+ *
+ * @return  true if a lone message went out exactly at the deadline and a
+ *          late second message was sent along with the first
+ */
+static bool deadline(void)
+{
+	CaptureTransport capture;
+	ORF24 radio(25, 0, 8000000, &capture);
+	ORF24Coalescer coalescer(radio);
+	unsigned char data[32];
+	int len;
+
+	radio.begin();
+	coalescer.setDeadline(5000);
+
+	capture.now = 10000;
+	len = message(0, data);
+	coalescer.send(data, len);
+
+	capture.now = 14999;
+	coalescer.poll();
+	bool early = capture.packets.size() == 0;
+
+	capture.now = 15000;
+	coalescer.poll();
+	bool onTime = capture.packets.size() == 1 && coalescer.getQueued() == 0;
+
+	/* Second message arrives after the first passed its deadline */
+	capture.now = 20000;
+	len = message(1, data);
+	coalescer.send(data, len);
+
+	capture.now = 26000;
+	len = message(2, data);
+	coalescer.send(data, len);
+
+	bool late = capture.packets.size() == 2 && coalescer.getQueued() == 0;
+	int read = unpack(capture.packets, 0);
+
+	printf("deadline: sent early %s on time %s late %s packets %d read %d\n", early ? "no" : "yes",
+		onTime ? "yes" : "no", late ? "together" : "apart", (int) capture.packets.size(), read);
+
+	return early && onTime && late && read == 3;
+}
+
+/**
+ * Use a payload size below the smallest frame
+ *
+ * @return  true if 1 byte messages are sent one per payload
+ */
+static bool smallPayload(void)
+{
+	CaptureTransport capture;
+	ORF24 radio(25, 0, 8000000, &capture);
+	ORF24Coalescer coalescer(radio, 1);
+	unsigned char data[2] = { 0x5A, 0xA5 };
+
+	radio.begin();
+
+	bool sent = coalescer.send(data, 1) && coalescer.send(data + 1, 1);
+	bool refused = !coalescer.send(data, 2);
+	bool framed = capture.packets.size() == 2 && capture.packets[0].size() == 2
+		&& capture.packets[0][0] == 1 && capture.packets[0][1] == 0x5A && capture.packets[1][1] == 0xA5;
+
+	printf("payload size 1: sent %s refused 2 bytes %s packets %d\n", sent ? "yes" : "no",
+		refused ? "yes" : "no", (int) capture.packets.size());
+
+	return sent && refused && framed;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = packing();
+
+	pass = deadline() && pass;
+	pass = smallPayload() && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * ChaCha20-Poly1305 against RFC 8439 and sealed packet round trip
+ *
+ * Runs the AEAD test vector of RFC 8439 section 2.8.2 through the
+ * internal chachaPoly, then seals packets with ORF24Crypto and checks that
+ * they open, and that a flipped bit or a replay is rejected. Build both
+ * ChaCha20 variants and run them from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o crypto crypto.cpp ../ORF24.cpp -lwiringPi
+ *     g++ -O2 -std=c++11 -I.. -DCRYPTO_SCALAR -o crypto_scalar crypto.cpp ../ORF24.cpp -lwiringPi
+ *     ./crypto && ./crypto_scalar
+ */
+
+#include <cstdio>
+
+/* Static functions are only reachable from the same translation unit */
+#include "ORF24Crypto.cpp"
+
+/* RFC 8439 section 2.8.2 */
+static const char plaintext[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+	"for the future, sunscreen would be it.";
+
+static const unsigned char nonce[12] = {
+	0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47
+};
+
+static const unsigned char aad[12] = {
+	0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7
+};
+
+static const unsigned char ciphertext[114] = {
+	0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc,
+	0x53, 0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+	0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e,
+	0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+	0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6,
+	0x7e, 0xcd, 0x3b, 0x36, 0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+	0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58, 0xfa, 0xb3, 0x24, 0xe4,
+	0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+	0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65,
+	0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16
+};
+
+static const unsigned char expectedTag[16] = {
+	0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91
+};
+
+/**
+ * Encrypt and decrypt the test vector
+ *
+ * @param  key 	RFC key, 32 bytes
+ * @return     	true if ciphertext and both tags match
+ */
+static bool testVector(const unsigned char *key)
+{
+	uint32_t words[8];
+	unsigned char data[sizeof(ciphertext)];
+	unsigned char tag[16];
+	bool pass = true;
+
+	for (int i = 0; i < 8; i++)
+	{
+		words[i] = load32(key + 4 * i);
+	}
+
+	std::memcpy(data, plaintext, sizeof(data));
+	chachaPoly(words, nonce, aad, sizeof(aad), data, sizeof(data), true, tag);
+
+	pass = std::memcmp(data, ciphertext, sizeof(data)) == 0 && pass;
+	pass = std::memcmp(tag, expectedTag, sizeof(tag)) == 0 && pass;
+
+	chachaPoly(words, nonce, aad, sizeof(aad), data, sizeof(data), false, tag);
+
+	pass = std::memcmp(data, plaintext, sizeof(data)) == 0 && pass;
+	pass = std::memcmp(tag, expectedTag, sizeof(tag)) == 0 && pass;
+
+	printf("RFC 8439 2.8.2 %s\n", pass ? "ok" : "mismatch");
+
+	return pass;
+}
+
+/**
+ * Seal and open packets between two nodes
+ *
+ * @param  key 	key, 32 bytes
+ * @return     	true if valid packets open and bad ones are rejected
+ */
+static bool roundTrip(const unsigned char *key)
+{
+	NullTransport null;
+	ORF24 radio(25, 0, 8000000, &null);
+	ORF24Crypto sender(radio, key, 1, 2);
+	ORF24Crypto receiver(radio, key, 2, 1);
+	unsigned char packet[32] = {};
+	unsigned char copy[32];
+	bool pass = true;
+
+	std::memcpy(packet + CRYPTO_HEADER_SIZE, "hello", 5);
+	sender.seal(packet, 5);
+	std::memcpy(copy, packet, sizeof(packet));
+
+	int len = receiver.open(packet, sizeof(packet));
+
+	pass = len == 5 && std::memcmp(packet + CRYPTO_HEADER_SIZE, "hello", 5) == 0 && pass;
+	pass = receiver.open(copy, sizeof(copy)) < 0 && receiver.getReplayed() == 1 && pass;
+
+	std::memcpy(packet + CRYPTO_HEADER_SIZE, "world", 5);
+	sender.seal(packet, 5);
+	packet[CRYPTO_HEADER_SIZE] ^= 1;
+
+	pass = receiver.open(packet, sizeof(packet)) < 0 && receiver.getForged() == 1 && pass;
+
+	printf("opened %lu replayed %lu forged %lu\n", receiver.getOpened(), receiver.getReplayed(), receiver.getForged());
+
+	return pass;
+}
+
+int main(int argc, char const *argv[])
+{
+	unsigned char key[32];
+
+	for (int i = 0; i < 32; i++)
+	{
+		key[i] = 0x80 + i;
+	}
+
+#ifdef CRYPTO_VECTOR
+	printf("ChaCha20 vector\n");
+#else
+	printf("ChaCha20 scalar\n");
+#endif
+
+	bool pass = testVector(key);
+
+	pass = roundTrip(key) && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
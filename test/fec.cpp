@@ -0,0 +1,292 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Reed-Solomon erasure recovery of ORF24FEC
+ *
+ * Captures the payloads an 8+4 group puts on air and decodes every subset
+ * with 0 to 5 shards erased. Up to 4 erasures all messages must come back,
+ * with 5 the group must be counted as failed and only the data shards that
+ * arrived may be returned. Then changes the rate while a group is open,
+ * which must only apply from the next group. Build and run from this
+ * directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o fec fec.cpp ../ORF24FEC.cpp ../ORF24.cpp -lwiringPi
+ *     ./fec
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ORF24.h"
+#include "ORF24FEC.h"
+#include "nRF24L01.h"
+
+#define		DATA_SHARDS		8
+#define		PARITY_SHARDS	4
+#define		SHARDS			(DATA_SHARDS + PARITY_SHARDS)
+
+typedef std::vector<unsigned char> Packet;
+
+/* Transport keeping every payload written */
+class CaptureTransport : public NullTransport
+{
+public:
+	std::vector<Packet> packets;
+
+	void transfer(int spiChannel, unsigned char *buf, int len)
+	{
+		if (buf[0] == W_TX_PAYLOAD)
+		{
+			packets.push_back(Packet(buf + 1, buf + len));
+		}
+
+		NullTransport::transfer(spiChannel, buf, len);
+	}
+};
+
+/**
+ * Build test message
+ *
+ * @param  n    	message number
+ * @param  data 	set to message
+ * @return      	message length
+ */
+static int message(int n, unsigned char *data)
+{
+	int len = 1 + (n * 5) % 28;
+
+	for (int i = 0; i < len; i++)
+	{
+		data[i] = n * 31 + i * 7;
+	}
+
+	return len;
+}
+
+/**
+ * Check that a decoded message is message n
+ *
+ * @param  n    	message number
+ * @param  data 	decoded message
+ * @param  len  	decoded length
+ * @return      	true if equal
+ */
+static bool matches(int n, const unsigned char *data, int len)
+{
+	unsigned char expected[32];
+
+	return message(n, expected) == len && std::memcmp(expected, data, len) == 0;
+}
+
+/**
+ * Decode every erasure pattern of one 8+4 group
+ *
+ * @return  true if up to 4 erasures were recovered and 5 failed cleanly
+ */
+static bool erasures(void)
+{
+	CaptureTransport capture;
+	ORF24 radio(25, 0, 8000000, &capture);
+	ORF24FECEncoder encoder(radio);
+
+	radio.begin();
+	encoder.setRate(DATA_SHARDS, PARITY_SHARDS);
+
+	for (int n = 0; n < DATA_SHARDS; n++)
+	{
+		unsigned char data[32];
+		int len = message(n, data);
+
+		encoder.send(data, len);
+	}
+
+	if (capture.packets.size() != SHARDS)
+	{
+		printf("encoder sent %d packets\n", (int) capture.packets.size());
+		return false;
+	}
+
+	int patterns[PARITY_SHARDS + 2] = { 0 };
+	int failures[PARITY_SHARDS + 2] = { 0 };
+
+	for (unsigned int erased = 0; erased < 1u << SHARDS; erased++)
+	{
+		int e = __builtin_popcount(erased);
+
+		if (e > PARITY_SHARDS + 1)
+		{
+			continue;
+		}
+
+		ORF24FECDecoder decoder;
+
+		for (int i = 0; i < SHARDS; i++)
+		{
+			if (!(erased & (1u << i)))
+			{
+				decoder.receive(capture.packets[i].data(), capture.packets[i].size());
+			}
+		}
+
+		decoder.flush();
+
+		int erasedData = __builtin_popcount(erased & ((1u << DATA_SHARDS) - 1));
+		int expected = 0;
+		bool ok = true;
+		const unsigned char *data;
+		int len;
+
+		/* Messages come out in order, lost ones are skipped */
+		while (decoder.next(&data, &len))
+		{
+			while (expected < DATA_SHARDS && e > PARITY_SHARDS && (erased & (1u << expected)))
+			{
+				expected++;
+			}
+
+			ok = ok && matches(expected++, data, len);
+		}
+
+		if (e <= PARITY_SHARDS)
+		{
+			ok = ok && expected == DATA_SHARDS && decoder.getLost() == 0 && decoder.getFailedGroups() == 0;
+		}
+		else
+		{
+			ok = ok && expected <= DATA_SHARDS && decoder.getLost() == (unsigned long) erasedData
+				&& decoder.getFailedGroups() == 1 && decoder.getRecovered() == 0;
+		}
+
+		patterns[e]++;
+
+		if (!ok)
+		{
+			failures[e]++;
+		}
+	}
+
+	bool pass = true;
+
+	for (int e = 0; e <= PARITY_SHARDS + 1; e++)
+	{
+		printf("%d erased: %4d patterns, %d wrong\n", e, patterns[e], failures[e]);
+		pass = pass && failures[e] == 0;
+	}
+
+	return pass;
+}
+
+/**
+ * Change the rate in the middle of a group
+ *
+ * @return  true if the open group kept 8+4 and the next ones used 4+2
+ */
+static bool rateSwitch(void)
+{
+	CaptureTransport capture;
+	ORF24 radio(25, 0, 8000000, &capture);
+	ORF24FECEncoder encoder(radio);
+	const int messages = DATA_SHARDS + 8;
+
+	radio.begin();
+	encoder.setRate(DATA_SHARDS, PARITY_SHARDS);
+
+	for (int n = 0; n < messages; n++)
+	{
+		unsigned char data[32];
+		int len = message(n, data);
+
+		if (n == 3)
+		{
+			encoder.setRate(4, 2);
+		}
+
+		encoder.send(data, len);
+	}
+
+	/* Group 0 is 8+4, groups 1 and 2 are 4+2 */
+	const int groupData[] = { DATA_SHARDS, 4, 4 };
+	const int groupParity[] = { PARITY_SHARDS, 2, 2 };
+	size_t p = 0;
+	bool layout = capture.packets.size() == SHARDS + 12;
+
+	for (int g = 0; g < 3 && layout; g++)
+	{
+		for (int i = 0; i < groupData[g] + groupParity[g]; i++, p++)
+		{
+			const Packet &packet = capture.packets[p];
+			int index = i < groupData[g] ? i : FEC_PARITY_INDEX + i - groupData[g];
+
+			layout = layout && packet[0] == g && packet[1] == index && packet[2] == groupData[g];
+		}
+	}
+
+	/* Lose as many shards per group as it has parity */
+	ORF24FECDecoder decoder;
+	const unsigned int erased[] = { 0x0126, 0x0009, 0x0030 };
+	int received = 0;
+	int next = 0;
+
+	p = 0;
+
+	for (int g = 0; g < 3 && layout; g++)
+	{
+		for (int i = 0; i < groupData[g] + groupParity[g]; i++, p++)
+		{
+			if (erased[g] & (1u << i))
+			{
+				continue;
+			}
+
+			if (decoder.receive(capture.packets[p].data(), capture.packets[p].size()))
+			{
+				const unsigned char *data;
+				int len;
+
+				while (decoder.next(&data, &len))
+				{
+					received += matches(next++, data, len);
+				}
+			}
+		}
+	}
+
+	printf("rate switch: packets %d layout %s received %d/%d recovered %lu lost %lu\n",
+		(int) capture.packets.size(), layout ? "ok" : "wrong", received, messages,
+		decoder.getRecovered(), decoder.getLost());
+
+	return layout && received == messages && decoder.getLost() == 0;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = erasures();
+
+	pass = rateSwitch() && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Memory mapped GPIO on a word array
+ *
+ * Stands in a plain array for the S805 GPIO block and drives one GPIOX and
+ * one GPIOY pin, directly and as CE of GPIOTransport. Only the FSEL and
+ * OUTP bit of the pin may change, CE must end low, and every CE pulse
+ * must be at least as long as requested. Build and run from this
+ * directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o gpio gpio.cpp ../ORF24GPIO.cpp -lwiringPi
+ *     ./gpio
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "ORF24GPIO.h"
+
+#define		PULSE_US		15
+
+static volatile unsigned int memory[S805_GPIO_BLOCK_SIZE / 4];
+
+/**
+ * Fill the registers with all FSEL bits set to input and OUTP cleared
+ */
+static void resetMemory(void)
+{
+	for (int i = 0; i < S805_GPIO_BLOCK_SIZE / 4; i++)
+	{
+		memory[i] = 0;
+	}
+
+	memory[S805_GPIOX_FSEL] = 0xFFFFFFFF;
+	memory[S805_GPIOY_FSEL] = 0xFFFFFFFF;
+}
+
+/**
+ * Check FSEL and OUTP of a pin
+ *
+ * @param  name  	description
+ * @param  fsel  	FSEL register offset
+ * @param  outp  	OUTP register offset
+ * @param  bit   	pin bit
+ * @param  high  	expected output level
+ * @return       	true if only the pin bits changed as expected
+ */
+static bool check(const char *name, int fsel, int outp, int bit, bool high)
+{
+	unsigned int expectedFsel = ~(1u << bit);
+	unsigned int expectedOutp = high ? 1u << bit : 0;
+
+	printf("%-28s FSEL %08X OUTP %08X\n", name, memory[fsel], memory[outp]);
+
+	return memory[fsel] == expectedFsel && memory[outp] == expectedOutp;
+}
+
+/**
+ * Drive a pin through ORF24GPIO
+ *
+ * @param  gpioPin 	S805 GPIO number
+ * @param  fsel    	FSEL register offset
+ * @param  outp    	OUTP register offset
+ * @param  bit     	pin bit
+ * @return         	true if the registers follow
+ */
+static bool direct(int gpioPin, int fsel, int outp, int bit)
+{
+	ORF24GPIO gpio;
+	ORF24GPIO::Pin pin;
+	char name[32];
+	bool pass;
+
+	resetMemory();
+	gpio.useMemory(memory);
+
+	pass = gpio.output(gpioPin, &pin);
+
+	ORF24GPIO::write(pin, HIGH);
+	std::sprintf(name, "GPIO %d high", gpioPin);
+	pass = check(name, fsel, outp, bit, true) && pass;
+
+	ORF24GPIO::write(pin, LOW);
+	std::sprintf(name, "GPIO %d low", gpioPin);
+	pass = check(name, fsel, outp, bit, false) && pass;
+
+	return pass;
+}
+
+/**
+ * Pulse CE through GPIOTransport
+ *
+ * @param  start 	first S805 GPIO number of the bank
+ * @param  end   	last S805 GPIO number of the bank
+ * @param  fsel  	FSEL register offset
+ * @param  outp  	OUTP register offset
+ * @return       	true if a wiringPi pin on the bank pulses correctly
+ */
+static bool transport(int start, int end, int fsel, int outp)
+{
+	int ce = -1;
+
+	/* First wiringPi pin wired to the bank */
+	for (int pin = 0; pin < 64 && ce < 0; pin++)
+	{
+		int gpioPin = wpiPinToGpio(pin);
+
+		if (gpioPin >= start && gpioPin <= end)
+		{
+			ce = pin;
+		}
+	}
+
+	if (ce < 0)
+	{
+		printf("no wiringPi pin on GPIO %d to %d\n", start, end);
+		return false;
+	}
+
+	GPIOTransport gpio;
+	char name[32];
+	int bit = wpiPinToGpio(ce) - start;
+
+	resetMemory();
+	gpio.useMemory(memory);
+	gpio.setup(ce, 0, 8000000);
+
+	bool pass = gpio.isMapped();
+
+	/* Longest of a single pulse is its width */
+	gpio.pulseCE(ce, PULSE_US);
+
+	unsigned int first = gpio.getLongestPulse();
+
+	printf("first pulse %u ns, requested %d ns\n", first, PULSE_US * 1000);
+
+	pass = first >= PULSE_US * 1000 && pass;
+
+	for (int i = 0; i < 100; i++)
+	{
+		gpio.pulseCE(ce, PULSE_US);
+	}
+
+	std::sprintf(name, "CE pin %d after pulses", ce);
+	pass = check(name, fsel, outp, bit, false) && pass;
+
+	printf("longest pulse %u ns, requested %d ns\n", gpio.getLongestPulse(), PULSE_US * 1000);
+
+	return gpio.getLongestPulse() >= first && pass;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = true;
+
+	pass = direct(S805_GPIOX_START + 4, S805_GPIOX_FSEL, S805_GPIOX_OUTP, 4) && pass;
+	pass = direct(S805_GPIOY_START + 3, S805_GPIOY_FSEL, S805_GPIOY_OUTP, 3) && pass;
+
+	pass = transport(S805_GPIOX_START, S805_GPIOX_END, S805_GPIOX_FSEL, S805_GPIOX_OUTP) && pass;
+	pass = transport(S805_GPIOY_START, S805_GPIOY_END, S805_GPIOY_FSEL, S805_GPIOY_OUTP) && pass;
+
+	/* Neither bank */
+	ORF24GPIO gpio;
+	ORF24GPIO::Pin pin;
+
+	gpio.useMemory(memory);
+	pass = !gpio.output(10, &pin) && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Health checks in flight and after a brown-out
+ *
+ * Starts a write nobody acknowledges and runs checkHealth until MAX_RT is
+ * raised. A payload in the TX FIFO and MAX_RT are normal until pollWrite
+ * finishes the write, so no fault may be reported before that, and none
+ * after it either.
+ *
+ * Then resets registers of a configured radio behind the driver's back
+ * before the first ORF24Health check. The check must not take the reset
+ * values as the configuration to restore. Build and run from this
+ * directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o health health.cpp ../ORF24Simulator.cpp ../ORF24Health.cpp ../ORF24.cpp -lwiringPi
+ *     ./health
+ */
+
+#include <cstdio>
+#include "ORF24Simulator.h"
+#include "ORF24Health.h"
+#include "nRF24L01Register.h"
+
+/* Node that only initializes its radio */
+class Idle : public SimulatedNode
+{
+public:
+
+	long step(ORF24 &radio)
+	{
+		return -1;
+	}
+};
+
+/**
+ * Read a register through the transport
+ *
+ * @param  radio 	radio
+ * @param  reg   	register
+ * @return       	register value
+ */
+static unsigned char peek(ORF24 &radio, unsigned char reg)
+{
+	unsigned char frame[2];
+
+	nRF24L01::readRegisterFrame(frame, reg, 1);
+	radio.getTransport()->transfer(0, frame, 2);
+
+	return frame[1];
+}
+
+/**
+ * Write a register through the transport, unseen by the driver
+ *
+ * @param radio 	radio
+ * @param reg   	register
+ * @param value 	register value
+ */
+static void poke(ORF24 &radio, unsigned char reg, unsigned char value)
+{
+	unsigned char frame[2] = {(unsigned char) (W_REGISTER | reg), value};
+
+	radio.getTransport()->transfer(0, frame, 2);
+}
+
+/**
+ * Run checkHealth during an unacknowledged write
+ *
+ * @param  radio 	radio
+ * @return       	true if no fault was reported
+ */
+static bool inFlight(ORF24 &radio)
+{
+	unsigned char payload[32] = {1};
+	int during = HEALTH_OK;
+	int checks = 0;
+	bool delivered;
+
+	radio.openWritingPipe("nobdy");
+	radio.startWrite(payload, 32);
+
+	/* The last check sees MAX_RT latched */
+	bool done;
+
+	do
+	{
+		done = radio.isWriteDone();
+		during |= radio.checkHealth();
+		checks++;
+	}
+	while (!done);
+
+	while (!radio.pollWrite(&delivered))
+		;
+
+	int after = radio.checkHealth();
+
+	printf("checks %d faults during write %02X after write %02X delivered %d\n", checks, during, after, delivered);
+
+	return during == HEALTH_OK && after == HEALTH_OK && !delivered;
+}
+
+/**
+ * Lose the configuration before the first watchdog check
+ *
+ * @param  radio 	radio
+ * @return       	true if the configured values came back
+ */
+static bool brownOut(ORF24 &radio)
+{
+	ORF24Health health(radio);
+
+	radio.setChannel(90);
+	radio.setPowerLevel(RF_PA_MAX);
+
+	/* Power on reset values */
+	poke(radio, RF_CH, 0x02);
+	poke(radio, RF_SETUP, 0x0F);
+
+	int first = health.check();
+	unsigned char channel = peek(radio, RF_CH);
+	int second = health.check();
+
+	printf("first check %02X channel %d second check %02X recoveries %lu\n", first, channel, second,
+		health.getRecoveries());
+
+	return (first & HEALTH_CONFIG) && channel == 90 && second == HEALTH_OK && health.getRecoveries() == 1;
+}
+
+int main(int argc, char const *argv[])
+{
+	ORF24Simulator simulator;
+	Idle idle[2];
+
+	simulator.addNode(&idle[0], 0, 0);
+	simulator.addNode(&idle[1], 100, 0);
+	simulator.run(1000);
+
+	bool pass = inFlight(simulator.getRadio(0));
+
+	pass = brownOut(simulator.getRadio(1)) && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
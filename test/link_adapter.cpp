@@ -0,0 +1,190 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Link adaptation on a simulated lossy channel
+ *
+ * A gateway sends to one peer through ORF24LinkAdapter. Near the gateway
+ * every profile works and the link should reach the fastest one. Far
+ * away 2 Mbps is below sensitivity, so probes to it fail, both ends fall
+ * back and the link should settle on 1 Mbps with the peer in step. A chip
+ * without 250 kbps should skip that profile. Build and run from this
+ * directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o link_adapter link_adapter.cpp ../ORF24LinkAdapter.cpp \
+ *         ../ORF24Simulator.cpp ../ORF24.cpp -lwiringPi
+ *     ./link_adapter
+ */
+
+#include <cstdio>
+#include "ORF24Simulator.h"
+#include "ORF24LinkAdapter.h"
+
+/* Gateway sending a numbered payload every 10 ms */
+class Gateway : public SimulatedNode
+{
+public:
+	ORF24LinkAdapter adapter;
+	unsigned long sent = 0;
+	unsigned long delivered = 0;
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.openWritingPipe("1reep");
+
+		adapter.skipUnsupported(radio);
+		adapter.apply(radio, 0);
+	}
+
+	long step(ORF24 &radio)
+	{
+		unsigned char data[32] = { 0 };
+
+		data[0] = 1;
+		data[1] = sent;
+
+		sent++;
+
+		if (adapter.write(radio, 0, data, 32))
+		{
+			delivered++;
+		}
+
+		return 10000;
+	}
+};
+
+/* Peer following switch commands */
+class Peer : public SimulatedNode
+{
+public:
+	ORF24LinkAdapter adapter;
+	unsigned long received = 0;
+	unsigned long switches = 0;
+	unsigned long fallbacks = 0;
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.openReadingPipe(1, "peer1");
+
+		/* Gateway sends every 10 ms, 20 missed payloads mean the link is gone */
+		adapter.setSilenceTimeout(200);
+		adapter.skipUnsupported(radio);
+		adapter.apply(radio, adapter.getLocalProfile(), RF_PA_MAX);
+
+		radio.startListening();
+	}
+
+	long step(ORF24 &radio)
+	{
+		unsigned char data[32];
+
+		for (int i = 0; i < 3 && radio.available(); i++)
+		{
+			radio.read(data, 32);
+
+			if (adapter.receive(radio, data, 32))
+				switches++;
+			else
+				received++;
+		}
+
+		if (adapter.service(radio))
+		{
+			fallbacks++;
+		}
+
+		return 1000;
+	}
+};
+
+/**
+ * Run a gateway and a peer for 60 s
+ *
+ * @param  distance 	peer distance in meters
+ * @param  profile 		expected final profile
+ * @return          	true if the link ended on the expected profile
+ */
+static bool run(double distance, int profile)
+{
+	ORF24Simulator simulator;
+	Gateway gateway;
+	Peer peer;
+
+	simulator.setBitErrorRate(1e-4);
+	simulator.addNode(&gateway, 0, 0);
+	simulator.addNode(&peer, distance, 0);
+	simulator.run(60000000);
+
+	const LinkState &state = gateway.adapter.getState(0);
+	double ratio = (double) gateway.delivered / gateway.sent;
+
+	printf("%5.1f m: profile %d/%d power %d switches %lu peer %lu fallbacks %lu delivered %lu/%lu received %lu\n",
+		distance, state.profile, peer.adapter.getLocalProfile(), state.power, state.switches,
+		peer.switches, peer.fallbacks, gateway.delivered, gateway.sent, peer.received);
+
+	return state.profile == profile && peer.adapter.getLocalProfile() == profile && ratio > 0.9;
+}
+
+/**
+ * Skip 250 kbps on a chip without it
+ *
+ * An ORF24 that never ran begin() has not detected a nRF24L01+.
+ *
+ * @return  true if the link moved to the 1 Mbps profile
+ */
+static bool skip(void)
+{
+	NullTransport null;
+	ORF24 radio(25, 0, 8000000, &null);
+	ORF24LinkAdapter adapter;
+
+	unsigned char command[3] = { LINK_SWITCH_COMMAND, 0, RF_PA_MAX };
+	int profile, power;
+
+	bool applied = adapter.apply(radio, 0);
+	bool rejected = !adapter.acceptSwitch(command, 3, &profile, &power);
+
+	printf("nRF24L01: applied %d profile %d switch to 250 kbps rejected %d\n",
+		applied, adapter.getState(0).profile, rejected);
+
+	return applied && adapter.getState(0).profile == 1 && rejected;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = true;
+
+	pass = skip() && pass;
+	pass = run(5, 3) && pass;
+	pass = run(28, 1) && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * EN_RXADDR after opening and closing reading pipes
+ *
+ * Reads the register back from a simulated chip. Opening a pipe while the
+ * pipe cache is unknown, after begin or recover, must only add that pipe.
+ * A writer only gets the ACK with pipe 0 enabled on its writing address.
+ * Build and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o pipes pipes.cpp ../ORF24Simulator.cpp ../ORF24.cpp -lwiringPi
+ *     ./pipes
+ */
+
+#include <cstdio>
+#include "ORF24Simulator.h"
+#include "nRF24L01Register.h"
+
+/* Node that only initializes its radio */
+class Idle : public SimulatedNode
+{
+public:
+
+	long step(ORF24 &radio)
+	{
+		return -1;
+	}
+};
+
+/* Node writing to a listener after changing its pipe 0 */
+class Writer : public SimulatedNode
+{
+public:
+	int mode;
+	bool delivered = false;
+
+	Writer(int _mode) : mode(_mode) { }
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.setPayloadSize(4);
+		radio.openWritingPipe("1nets");
+
+		if (mode == 1)
+		{
+			radio.closeReadingPipe(0);
+		}
+		else if (mode == 2)
+		{
+			radio.openReadingPipe(0, "other");
+		}
+	}
+
+	long step(ORF24 &radio)
+	{
+		delivered = radio.write((unsigned char *) "ping", 4);
+
+		return -1;
+	}
+};
+
+/* Node listening on pipe 1 */
+class Listener : public SimulatedNode
+{
+public:
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.setPayloadSize(4);
+		radio.openReadingPipe(1, "sten1");
+		radio.startListening();
+	}
+
+	long step(ORF24 &radio)
+	{
+		return -1;
+	}
+};
+
+/**
+ * Write once with pipe 0 of the writer set up by mode
+ *
+ * @param  mode 		0 writing address, 1 closed, 2 other address
+ * @param  expected 	whether the write should be acknowledged
+ * @return          	true if the result was as expected
+ */
+static bool acknowledge(int mode, bool expected)
+{
+	static const char *names[] = { "pipe 0 on TX_ADDR", "pipe 0 closed", "pipe 0 on other address" };
+	ORF24Simulator simulator;
+	Writer writer(mode);
+	Listener listener;
+
+	simulator.addNode(&listener, 0, 0);
+	simulator.addNode(&writer, 1, 0);
+	simulator.run(100000);
+
+	const SimulatorStatistics &statistics = simulator.getStatistics();
+
+	printf("%-24s delivered %d acked %d misaddressed ACKs %lu\n", names[mode],
+		(int) statistics.delivered, writer.delivered, statistics.misaddressedAcks);
+
+	return writer.delivered == expected && statistics.delivered == 1 && (statistics.misaddressedAcks > 0) != expected;
+}
+
+/**
+ * Read EN_RXADDR through the transport
+ *
+ * @param  radio 	radio
+ * @return       	register value
+ */
+static unsigned char readEnabledPipes(ORF24 &radio)
+{
+	unsigned char frame[2];
+
+	nRF24L01::readRegisterFrame(frame, EN_RXADDR, 1);
+	radio.getTransport()->transfer(0, frame, 2);
+
+	return frame[1];
+}
+
+/**
+ * Compare EN_RXADDR with the expected value
+ *
+ * @param  radio 		radio
+ * @param  step 		description
+ * @param  expected 	expected value
+ * @return          	true if equal
+ */
+static bool check(ORF24 &radio, const char *step, unsigned char expected)
+{
+	unsigned char pipes = readEnabledPipes(radio);
+
+	printf("%-24s EN_RXADDR %02X expected %02X\n", step, pipes, expected);
+
+	return pipes == expected;
+}
+
+int main(int argc, char const *argv[])
+{
+	ORF24Simulator simulator;
+	Idle idle;
+
+	simulator.addNode(&idle, 0, 0);
+	simulator.run(1000);
+
+	ORF24 &radio = simulator.getRadio(0);
+	bool pass = true;
+
+	/* Pipe 0 and 1 are enabled after reset */
+	pass = check(radio, "begin", 0x03) && pass;
+
+	radio.openReadingPipe(2, "node2");
+	pass = check(radio, "open pipe 2", 0x07) && pass;
+
+	radio.closeReadingPipe(1);
+	pass = check(radio, "close pipe 1", 0x05) && pass;
+
+	/* Pipe cache is unknown again */
+	radio.fastBegin();
+	radio.openReadingPipe(3, "node3");
+	pass = check(radio, "open pipe 3 after begin", 0x0D) && pass;
+
+	radio.fastBegin();
+	radio.closeReadingPipe(0);
+	pass = check(radio, "close pipe 0 after begin", 0x0C) && pass;
+
+	pass = acknowledge(0, true) && pass;
+	pass = acknowledge(1, false) && pass;
+	pass = acknowledge(2, false) && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
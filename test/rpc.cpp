@@ -0,0 +1,329 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * ORF24RPC transactions between two simulated nodes
+ *
+ * A client calls a server that answers with every request byte plus one.
+ * The simulator runs one node step at a time, so a blocking call() would
+ * never see the answer. The client therefore talks to its chip through a
+ * transport that brings the server up to the client clock and lets it
+ * poll whenever call() reads the time while waiting for the response. Checks that responses echo the transaction ID,
+ * that a reply arriving after its call timed out is dropped by the next
+ * call, and that payloads of other pipes received during a call are held
+ * for available() and read(). Build and run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o rpc rpc.cpp ../ORF24RPC.cpp ../ORF24Simulator.cpp ../ORF24.cpp -lwiringPi
+ *     ./rpc
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "ORF24Simulator.h"
+#include "ORF24RPC.h"
+
+#define		TIMEOUT			10000
+
+/* Server answering requests, holding back the reply to 'S' until the next request */
+class Server : public SimulatedNode
+{
+public:
+	ORF24 *radio = NULL;
+	unsigned char late[32];			/* Request answered late */
+	bool holding = false;
+	int answered = 0;				/* Responses acknowledged by the client */
+	int notified = 0;				/* Payloads to client pipe 1 acknowledged */
+
+	void setup(ORF24 &_radio)
+	{
+		radio = &_radio;
+		radio->fastBegin();
+		radio->setAutoACK(true);
+		radio->openReadingPipe(1, "serv1");
+		radio->startListening();
+	}
+
+	/**
+	 * Answer a request
+	 *
+	 * @param request 	request payload, ID included
+	 */
+	void answer(const unsigned char *request)
+	{
+		ORF24RPC rpc(*radio);
+		unsigned char response[31];
+
+		for (int i = 0; i < 31; i++)
+		{
+			response[i] = request[1 + i] + 1;
+		}
+
+		/* Written form of the reading address "serv1" */
+		answered += rpc.respond("1vres", request, response, 31);
+	}
+
+	/**
+	 * Send two payloads to client pipe 1 before answering
+	 */
+	void notify(void)
+	{
+		unsigned char note[32] = { 'N' };
+
+		radio->stopListening();
+		radio->openWritingPipe("1llac");
+
+		for (int i = 0; i < 2; i++)
+		{
+			note[1] = i;
+			notified += radio->write(note, 32);
+		}
+	}
+
+	/**
+	 * Handle received requests
+	 */
+	void poll(void)
+	{
+		unsigned char request[32];
+
+		while (radio->available())
+		{
+			radio->read(request, 32);
+
+			/* The client moved on, the held reply is late now */
+			if (holding)
+			{
+				answer(late);
+				holding = false;
+			}
+
+			if (request[1] == 'S')
+			{
+				std::memcpy(late, request, 32);
+				holding = true;
+				continue;
+			}
+
+			if (request[1] == 'H')
+			{
+				notify();
+			}
+
+			answer(request);
+		}
+	}
+
+	long step(ORF24 &_radio)
+	{
+		poll();
+
+		return 100;
+	}
+};
+
+/* Client transport running the server while the client waits */
+class YieldingTransport : public ORF24Transport
+{
+public:
+	ORF24Transport *chip = NULL;	/* Client chip */
+	Server *server = NULL;
+	bool serving = false;
+
+	/**
+	 * Bring the server clock up to the client and let it poll
+	 */
+	void yield(void)
+	{
+		ORF24Transport *other = server->radio->getTransport();
+
+		if (serving || chip->nanos() < other->nanos())
+		{
+			return;
+		}
+
+		serving = true;
+		other->delayMicroseconds((chip->nanos() - other->nanos()) / 1000);
+		server->poll();
+		serving = false;
+	}
+
+	bool setup(int ce, int spiChannel, int spiSpeed)
+	{
+		return chip->setup(ce, spiChannel, spiSpeed);
+	}
+
+	void transfer(int spiChannel, unsigned char *buf, int len)
+	{
+		chip->transfer(spiChannel, buf, len);
+	}
+
+	void writeCE(int ce, int value)
+	{
+		chip->writeCE(ce, value);
+	}
+
+	void delayMicroseconds(unsigned int us)
+	{
+		chip->delayMicroseconds(us);
+	}
+
+	unsigned int millis(void)
+	{
+		return chip->millis();
+	}
+
+	/* Only call() reads it, while it waits listening for the response */
+	unsigned int micros(void)
+	{
+		yield();
+		return chip->micros();
+	}
+
+	unsigned long long nanos(void)
+	{
+		return chip->nanos();
+	}
+};
+
+/* Client running the calls in one step */
+class Client : public SimulatedNode
+{
+public:
+	YieldingTransport transport;
+	ORF24 *radio = NULL;
+	ORF24RPC *rpc = NULL;
+	int echoed = 0;
+	bool lateTimedOut = false;
+	bool lateDropped = false;
+	bool held = false;
+
+	Client(Server *server)
+	{
+		transport.server = server;
+	}
+
+	~Client()
+	{
+		delete rpc;
+		delete radio;
+	}
+
+	void setup(ORF24 &chipRadio)
+	{
+		transport.chip = chipRadio.getTransport();
+
+		/* Server crystal and RX settle first */
+		transport.chip->delayMicroseconds(5000);
+
+		radio = new ORF24(1, 0, 8000000, &transport);
+		radio->fastBegin();
+		radio->setAutoACK(true);
+		radio->openWritingPipe("1vres");
+		radio->openReadingPipe(1, "call1");
+
+		rpc = new ORF24RPC(*radio);
+	}
+
+	/**
+	 * Call with a request of one letter and one number
+	 *
+	 * @param  letter 	request type
+	 * @param  n      	request number
+	 * @return        	true if answered with both bytes plus one
+	 */
+	bool call(unsigned char letter, unsigned char n)
+	{
+		unsigned char request[2] = { letter, n };
+		unsigned char response[31];
+
+		if (!rpc->call(request, 2, response, TIMEOUT))
+		{
+			return false;
+		}
+
+		return response[0] == letter + 1 && response[1] == n + 1;
+	}
+
+	long step(ORF24 &chipRadio)
+	{
+		for (int i = 0; i < 5; i++)
+		{
+			echoed += call('E', i);
+		}
+
+		/* Reply comes when the next request arrives */
+		lateTimedOut = !call('S', 0);
+		lateDropped = call('F', 0);
+
+		held = call('H', 0);
+
+		for (int i = 0; i < 2; i++)
+		{
+			unsigned char payload[32];
+			int pipe = -1;
+
+			held = held && rpc->available(&pipe) && pipe == 1;
+
+			if (held)
+			{
+				rpc->read(payload);
+				held = payload[0] == 'N' && payload[1] == i;
+			}
+		}
+
+		int pipe;
+
+		held = held && !rpc->available(&pipe);
+
+		return -1;
+	}
+};
+
+int main(int argc, char const *argv[])
+{
+	ORF24Simulator simulator;
+	Server server;
+	Client client(&server);
+
+	simulator.addNode(&server, 0, 0);
+	simulator.addNode(&client, 2, 0);
+	simulator.run(1000000);
+
+	printf("echoed %d/5 calls %lu timeouts %lu failures %lu mean RTT %.0f us\n", client.echoed,
+		client.rpc->getCalls(), client.rpc->getTimeouts(), client.rpc->getFailures(), client.rpc->getMeanRTT());
+	printf("late reply: timed out %s, next call answered %s, server answered %d\n",
+		client.lateTimedOut ? "yes" : "no", client.lateDropped ? "correctly" : "wrongly", server.answered);
+	printf("other pipe: notified %d held %s dropped %lu\n", server.notified, client.held ? "yes" : "no",
+		client.rpc->getDropped());
+
+	/* 5 echoes, the late reply, F and H */
+	bool pass = client.echoed == 5 && client.lateTimedOut && client.lateDropped && server.answered == 8;
+
+	pass = pass && client.rpc->getCalls() == 7 && client.rpc->getTimeouts() == 1;
+	pass = pass && server.notified == 2 && client.held && client.rpc->getDropped() == 0;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Transmit scheduler on a simulated network
+ *
+ * A gateway queues bulk frames for two receivers with weights 3 and 1, so
+ * while both have frames they must arrive as A A A B. An alarm queued in
+ * the middle must be the next frame sent after the one in flight. Then
+ * control frames to an address nobody listens on hold the radio for the
+ * whole retransmission time, while telemetry frames with a 2 ms deadline
+ * wait behind them. Those must be dropped instead of sent late. Build and
+ * run from this directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o scheduler scheduler.cpp ../ORF24Scheduler.cpp ../ORF24Simulator.cpp \
+ *         ../ORF24.cpp -lwiringPi
+ *     ./scheduler
+ */
+
+#include <cstdio>
+#include <vector>
+#include "ORF24Simulator.h"
+#include "ORF24Scheduler.h"
+
+#define		BULK_FRAMES		12
+#define		ALARM_AFTER		6
+#define		TELEMETRY		4
+
+/* Frames in order of arrival, class << 8 | receiver */
+static std::vector<int> arrivals;
+
+/* Gateway scheduling all traffic */
+class Gateway : public SimulatedNode
+{
+public:
+	ORF24Scheduler *scheduler = NULL;
+	int a, b, nobody;
+	int alarmQueuedAt = -1;
+	bool telemetryQueued = false;
+
+	void setup(ORF24 &radio)
+	{
+		unsigned char data[32] = {};
+
+		radio.fastBegin();
+
+		scheduler = new ORF24Scheduler(radio);
+
+		/* Writing addresses are the reversed reading addresses */
+		a = scheduler->addDestination("Avcer", 3);
+		b = scheduler->addDestination("Bvcer", 1);
+		nobody = scheduler->addDestination("ydobo", 1);
+
+		scheduler->setClass(TC_TELEMETRY, 32, 2000);
+
+		data[0] = TC_BULK;
+
+		for (int i = 0; i < BULK_FRAMES; i++)
+		{
+			scheduler->enqueue(a, TC_BULK, data, 32);
+			scheduler->enqueue(b, TC_BULK, data, 32);
+		}
+	}
+
+	long step(ORF24 &radio)
+	{
+		unsigned char data[32] = {};
+
+		if (alarmQueuedAt < 0 && (int) arrivals.size() == ALARM_AFTER)
+		{
+			data[0] = TC_ALARM;
+			scheduler->enqueue(b, TC_ALARM, data, 32);
+			alarmQueuedAt = arrivals.size();
+		}
+
+		bool busy = scheduler->service();
+
+		if (!busy && !telemetryQueued)
+		{
+			data[0] = TC_CONTROL;
+			scheduler->enqueue(nobody, TC_CONTROL, data, 32);
+			scheduler->enqueue(nobody, TC_CONTROL, data, 32);
+
+			data[0] = TC_TELEMETRY;
+
+			for (int i = 0; i < TELEMETRY; i++)
+			{
+				scheduler->enqueue(a, TC_TELEMETRY, data, 32);
+			}
+
+			telemetryQueued = true;
+		}
+
+		return 100;
+	}
+};
+
+/* Receiver logging every frame */
+class Receiver : public SimulatedNode
+{
+public:
+	const char *address;
+	int id;
+
+	Receiver(const char *_address, int _id) : address(_address), id(_id) { }
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.openReadingPipe(1, address);
+		radio.startListening();
+	}
+
+	long step(ORF24 &radio)
+	{
+		unsigned char data[32];
+
+		while (radio.available())
+		{
+			radio.read(data, 32);
+			arrivals.push_back(data[0] << 8 | id);
+		}
+
+		return 100;
+	}
+};
+
+int main(int argc, char const *argv[])
+{
+	ORF24Simulator simulator;
+	Gateway gateway;
+	Receiver a("recvA", 0), b("recvB", 1);
+	bool pass = true;
+
+	simulator.addNode(&gateway, 0, 0);
+	simulator.addNode(&a, 1, 0);
+	simulator.addNode(&b, 0, 1);
+	simulator.run(1000000);
+
+	/* Weighted round robin until the alarm */
+	for (int i = 0; i < ALARM_AFTER && i < (int) arrivals.size(); i++)
+	{
+		int expected = TC_BULK << 8 | (i % 4 == 3 ? 1 : 0);
+
+		pass = arrivals[i] == expected && pass;
+	}
+
+	/* One frame was in flight when the alarm was queued */
+	int alarmAt = -1;
+
+	for (int i = 0; i < (int) arrivals.size(); i++)
+	{
+		if (arrivals[i] >> 8 == TC_ALARM)
+		{
+			alarmAt = i;
+		}
+	}
+
+	ORF24Scheduler &scheduler = *gateway.scheduler;
+	const ClassMetrics &bulk = scheduler.getMetrics(TC_BULK);
+	const ClassMetrics &alarm = scheduler.getMetrics(TC_ALARM);
+	const ClassMetrics &control = scheduler.getMetrics(TC_CONTROL);
+	const ClassMetrics &telemetry = scheduler.getMetrics(TC_TELEMETRY);
+
+	printf("order");
+
+	for (int i = 0; i < ALARM_AFTER + 4 && i < (int) arrivals.size(); i++)
+	{
+		printf(" %d/%c", arrivals[i] >> 8, 'A' + (arrivals[i] & 0xFF));
+	}
+
+	printf("\nalarm queued after %d frames, arrived as frame %d\n", gateway.alarmQueuedAt, alarmAt);
+	printf("bulk sent %lu alarm sent %lu mean latency %.0f us\n", bulk.sent, alarm.sent,
+		scheduler.getMeanLatency(TC_ALARM));
+	printf("control failed %lu telemetry sent %lu expired %lu\n", control.failed, telemetry.sent, telemetry.expired);
+
+	pass = alarmAt >= 0 && alarmAt <= gateway.alarmQueuedAt + 1 && pass;
+	pass = bulk.sent == 2 * BULK_FRAMES && alarm.sent == 1 && pass;
+	pass = control.failed == 2 && telemetry.expired == TELEMETRY && telemetry.sent == 0 && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file
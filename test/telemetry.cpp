@@ -0,0 +1,270 @@
+/**
+ * Odroid nRF24L01 Library
+ *
+ * Copyright (c) 2015 Ilham Imaduddin <ilham.imaduddin@mail.ugm.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * Telemetry encode and decode round trip
+ *
+ * Encodes a series that produces keyframes, varint deltas and packed
+ * deltas, decodes every frame and compares the values. Then drops a delta
+ * frame and checks that the decoder counts the loss, drops deltas until
+ * the next keyframe and decodes correctly from there. Finally sends frames
+ * over a simulated link with a 12 byte payload. Build and run from this
+ * directory:
+ *
+ *     g++ -O2 -std=c++11 -I.. -o telemetry telemetry.cpp ../ORF24Telemetry.cpp \
+ *         ../ORF24Simulator.cpp ../ORF24.cpp -lwiringPi
+ *     ./telemetry
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "ORF24Simulator.h"
+#include "ORF24Telemetry.h"
+
+#define		CHANNELS		4
+#define		INTERVAL		8
+#define		PAYLOAD_SIZE	12
+
+/**
+ * Sample values, channel 0 holds the sample number
+ *
+ * Every fifth sample one channel jumps, so varint deltas are shorter
+ * than packed ones, otherwise all deltas are small and packed wins.
+ *
+ * @param n      	sample number
+ * @param values 	set to one value per channel
+ */
+static void sample(int n, int32_t *values)
+{
+	values[0] = n;
+
+	for (int c = 1; c < CHANNELS; c++)
+	{
+		values[c] = 100 * c - (n * c) % 7;
+	}
+
+	if (n % 5 == 4)
+	{
+		values[2] += 3000;
+	}
+}
+
+/**
+ * Check decoded values against the sample they claim to be
+ *
+ * @param  values 	decoded values
+ * @return        	true if values match sample values[0]
+ */
+static bool matches(const int32_t *values)
+{
+	int32_t expected[CHANNELS];
+
+	sample(values[0], expected);
+
+	return std::memcmp(values, expected, sizeof(expected)) == 0;
+}
+
+/**
+ * Encode and decode without a radio
+ *
+ * @return  true if every frame type decoded and the decoder resynchronized
+ */
+static bool roundTrip(void)
+{
+	ORF24TelemetryEncoder encoder(CHANNELS, INTERVAL, PAYLOAD_SIZE);
+	ORF24TelemetryDecoder decoder(CHANNELS, PAYLOAD_SIZE);
+	unsigned long types[3] = { 0 };
+	int mismatches = 0;
+	int rejected = 0;
+	int dropped = -1;
+	bool resync = false;
+
+	for (int n = 0; n < 64; n++)
+	{
+		int32_t values[CHANNELS];
+		int32_t decoded[CHANNELS];
+		unsigned char frame[PAYLOAD_SIZE];
+
+		sample(n, values);
+		std::memset(frame, 0, sizeof(frame));
+
+		int len = encoder.encode(values, frame);
+		int type = frame[0] >> 6;
+
+		if (len < 0)
+		{
+			mismatches++;
+			continue;
+		}
+
+		types[type]++;
+
+		/* Lose the first delta after the third keyframe */
+		if (dropped < 0 && encoder.getKeyframes() == 3 && type != TELEMETRY_KEYFRAME)
+		{
+			dropped = n;
+			continue;
+		}
+
+		/* Padding must not change the result */
+		if (!decoder.decode(frame, n % 2 ? len : PAYLOAD_SIZE, decoded))
+		{
+			rejected++;
+
+			/* Only deltas between the loss and the next keyframe */
+			if (dropped < 0 || resync || type == TELEMETRY_KEYFRAME)
+			{
+				mismatches++;
+			}
+
+			continue;
+		}
+
+		if (dropped >= 0 && !resync)
+		{
+			resync = type == TELEMETRY_KEYFRAME;
+		}
+
+		if (!matches(decoded) || decoded[0] != n)
+		{
+			mismatches++;
+		}
+	}
+
+	printf("Round trip: keyframe %lu varint %lu packed %lu, %d mismatches\n",
+		types[TELEMETRY_KEYFRAME], types[TELEMETRY_VARINT], types[TELEMETRY_PACKED], mismatches);
+	printf("Gap: dropped frame %d, lost %lu, rejected %d, decoder dropped %lu, resync %s\n",
+		dropped, decoder.getLost(), rejected, decoder.getDropped(), resync ? "yes" : "no");
+	printf("Compression ratio %.2f\n", encoder.getCompressionRatio());
+
+	return types[TELEMETRY_KEYFRAME] > 0 && types[TELEMETRY_VARINT] > 0 && types[TELEMETRY_PACKED] > 0
+		&& mismatches == 0 && resync && decoder.getLost() == 1
+		&& decoder.getDropped() == (unsigned long) rejected && rejected > 0;
+}
+
+/* Node sending a sample every 10 ms */
+class Sender : public SimulatedNode
+{
+public:
+	ORF24TelemetryEncoder encoder;
+	int sent = 0;
+
+	Sender() : encoder(CHANNELS, INTERVAL, PAYLOAD_SIZE) {}
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.setPayloadSize(PAYLOAD_SIZE);
+		radio.openWritingPipe("1mlet");
+	}
+
+	long step(ORF24 &radio)
+	{
+		int32_t values[CHANNELS];
+
+		sample(sent, values);
+
+		if (encoder.send(radio, values))
+		{
+			sent++;
+		}
+
+		return sent < 100 ? 10000 : -1;
+	}
+};
+
+/* Node decoding samples */
+class Receiver : public SimulatedNode
+{
+public:
+	ORF24TelemetryDecoder decoder;
+	int received = 0;
+	int mismatches = 0;
+
+	Receiver() : decoder(CHANNELS, PAYLOAD_SIZE) {}
+
+	void setup(ORF24 &radio)
+	{
+		radio.fastBegin();
+		radio.setAutoACK(true);
+		radio.setPayloadSize(PAYLOAD_SIZE);
+		radio.openReadingPipe(1, "telm1");
+		radio.startListening();
+	}
+
+	long step(ORF24 &radio)
+	{
+		int32_t values[CHANNELS];
+
+		while (radio.available())
+		{
+			if (!decoder.receive(radio, values))
+			{
+				mismatches++;
+			}
+			else if (!matches(values) || values[0] != received)
+			{
+				mismatches++;
+			}
+			else
+			{
+				received++;
+			}
+		}
+
+		return 1000;
+	}
+};
+
+/**
+ * Send samples over a simulated link
+ *
+ * @return  true if every sample arrived and decoded
+ */
+static bool link(void)
+{
+	ORF24Simulator simulator;
+	Sender sender;
+	Receiver receiver;
+
+	simulator.addNode(&sender, 0, 0);
+	simulator.addNode(&receiver, 5, 0);
+	simulator.run(2000000);
+
+	printf("Link: sent %d received %d mismatches %d\n", sender.sent, receiver.received, receiver.mismatches);
+
+	return sender.sent == 100 && receiver.received == 100 && receiver.mismatches == 0;
+}
+
+int main(int argc, char const *argv[])
+{
+	bool pass = roundTrip();
+
+	pass = link() && pass;
+
+	printf(pass ? "PASS\n" : "FAIL\n");
+
+	return pass ? 0 : 1;
+}
\ No newline at end of file